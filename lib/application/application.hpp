@@ -43,6 +43,10 @@
 #include "../shader/shader.hpp"
 #include "../pipeline/pipeline.hpp"
 #include "../commandBuffer/commandBuffer.hpp"
+#include "../commandBuffer/frameRecorder.hpp"
+#include "../object/object.hpp"
+#include "../util/threadPool.hpp"
+#include "../skinning/animationLod.hpp"
 
 const int WIDTH = 1280;
 const int HEIGHT = 720;
@@ -107,16 +111,21 @@ protected:
 
     vk::UniqueRenderPass renderPass;
 
+    // Used instead of renderPass when hasEarlyPass() returns true, the main pass loads what the early pass drew.
+    vk::UniqueRenderPass earlyRenderPass;
+    vk::UniqueRenderPass mainRenderPass;
+
     vk::UniqueImage depthImage;
     vk::UniqueDeviceMemory depthImageMemory;
     vk::UniqueImageView depthImageView;
 
-    std::vector<vk::UniqueCommandBuffer, std::allocator<vk::UniqueCommandBuffer>> commandBuffers;
+    std::unique_ptr<pvk::FrameRecorder> frameRecorder;
 
     std::vector<vk::UniqueSemaphore> imageAvailableSemaphores;
     std::vector<vk::UniqueSemaphore> renderFinishedSemaphores;
     std::vector<vk::UniqueFence> inFlightFences;
     size_t currentFrame = 0;
+    uint32_t currentImageIndex = 0;
 
     float deltaTime = 0.0f;
 
@@ -125,6 +134,12 @@ protected:
     bool sPressed = false;
     bool dPressed = false;
 
+    // Objects which are animated and transformed by the engine every frame, before update() is called.
+    std::vector<std::shared_ptr<pvk::Object>> objects;
+
+    // Disabled until initialize() sets a projection.
+    pvk::skinning::AnimationLodScheduler animationLodScheduler;
+
     bool initializeMouse = true;
     bool isMouseActive = false;
     double lastMouseX{};
@@ -140,6 +155,46 @@ protected:
 
     virtual void render(pvk::CommandBuffer *commandBuffer) = 0;
 
+    /**
+     * Number of jobs the draws of a frame are split into. Every job is recorded into its own secondary command
+     * buffer and jobs run in parallel on the thread pool, so they must not depend on each other.
+     */
+    virtual uint32_t getNumberOfRenderJobs() {
+        return 1;
+    }
+
+    /**
+     * Records a single job of the frame, by default the whole frame is one job recorded by render().
+     */
+    virtual void renderJob(pvk::CommandBuffer *commandBuffer, uint32_t jobIndex) {
+        render(commandBuffer);
+    }
+
+    /**
+     * Records work which has to happen before the render pass, such as compute passes whose output is drawn.
+     */
+    virtual void compute(pvk::CommandBuffer *commandBuffer) {}
+
+    /**
+     * Whether the frame starts with an early render pass, see renderEarly().
+     */
+    virtual bool hasEarlyPass() {
+        return false;
+    }
+
+    /**
+     * Records the draws of the early render pass, which clears and is followed by computeAfterEarlyPass(). The
+     * main render pass then keeps its color and depth. Two phase occlusion culling draws what was visible last
+     * frame here.
+     */
+    virtual void renderEarly(pvk::CommandBuffer *commandBuffer) {}
+
+    /**
+     * Records work between the early and the main render pass. The depth image is in
+     * eDepthStencilReadOnlyOptimal and can be sampled, for example to build a culling::DepthPyramid.
+     */
+    virtual void computeAfterEarlyPass(pvk::CommandBuffer *commandBuffer) {}
+
     virtual void tearDown() = 0;
 
     void initWindow() {
@@ -234,7 +289,7 @@ protected:
         createFramebuffers();
         createCommandPool();
         initialize();
-        createCommandBuffers();
+        createFrameRecorder();
         createSyncObjects();
     }
 
@@ -300,7 +355,6 @@ protected:
         createImageViews();
         createRenderPass();
         createFramebuffers();
-        createCommandBuffers();
     }
 
     static void createInstance() {
@@ -376,9 +430,15 @@ protected:
         pvk::QueueFamilyIndices indices = pvk::device::physical::findQueueFamilies(pvk::Context::getPhysicalDevice(),
                                                                                    surface.get());
 
+        const auto enabledDeviceExtensions = pvk::device::logical::getEnabledExtensions(
+                pvk::Context::getPhysicalDevice(), deviceExtensions);
+
+        pvk::Context::setEnabledFeatures(pvk::device::logical::getEnabledFeatures(pvk::Context::getPhysicalDevice()));
+        pvk::Context::setEnabledExtensions(enabledDeviceExtensions);
         pvk::Context::setLogicalDevice(
-                pvk::device::logical::create(pvk::Context::getPhysicalDevice(), indices, deviceExtensions,
-                                             validationLayers, enableValidationLayers));
+                pvk::device::logical::create(pvk::Context::getPhysicalDevice(), indices, enabledDeviceExtensions,
+                                             validationLayers, enableValidationLayers,
+                                             pvk::Context::getEnabledFeatures()));
 
         presentQueue = pvk::Context::getLogicalDevice().getQueue(indices.presentFamily.value(), 0);
 
@@ -470,29 +530,56 @@ protected:
     }
 
     void createRenderPass() {
+        renderPass = createRenderPass(vk::AttachmentLoadOp::eClear,
+                                      vk::ImageLayout::eUndefined,
+                                      vk::ImageLayout::ePresentSrcKHR,
+                                      vk::ImageLayout::eUndefined,
+                                      vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+        if (!hasEarlyPass()) {
+            return;
+        }
+
+        // The depth of the early pass is sampled by compute shaders before the main pass tests against it.
+        earlyRenderPass = createRenderPass(vk::AttachmentLoadOp::eClear,
+                                           vk::ImageLayout::eUndefined,
+                                           vk::ImageLayout::eColorAttachmentOptimal,
+                                           vk::ImageLayout::eUndefined,
+                                           vk::ImageLayout::eDepthStencilReadOnlyOptimal);
+        mainRenderPass = createRenderPass(vk::AttachmentLoadOp::eLoad,
+                                          vk::ImageLayout::eColorAttachmentOptimal,
+                                          vk::ImageLayout::ePresentSrcKHR,
+                                          vk::ImageLayout::eDepthStencilReadOnlyOptimal,
+                                          vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    }
+
+    /**
+     * All render passes share the attachments, so they are compatible with the same framebuffers.
+     */
+    vk::UniqueRenderPass createRenderPass(vk::AttachmentLoadOp loadOp,
+                                          vk::ImageLayout colorInitialLayout,
+                                          vk::ImageLayout colorFinalLayout,
+                                          vk::ImageLayout depthInitialLayout,
+                                          vk::ImageLayout depthFinalLayout) const {
         vk::AttachmentDescription colorAttachment = {};
         colorAttachment.format = swapChainImageFormat;
         colorAttachment.samples = vk::SampleCountFlagBits::e1;
-        colorAttachment.loadOp = vk::AttachmentLoadOp::eClear;
+        colorAttachment.loadOp = loadOp;
         colorAttachment.storeOp = vk::AttachmentStoreOp::eStore;
         colorAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
         colorAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-        colorAttachment.initialLayout = vk::ImageLayout::eUndefined;
-        colorAttachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
+        colorAttachment.initialLayout = colorInitialLayout;
+        colorAttachment.finalLayout = colorFinalLayout;
 
         vk::AttachmentDescription depthAttachment = {};
-        depthAttachment.format = pvk::util::findSupportedFormat(pvk::Context::getPhysicalDevice(),
-                                                                {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint,
-                                                                 vk::Format::eD24UnormS8Uint},
-                                                                vk::ImageTiling::eOptimal,
-                                                                vk::FormatFeatureFlagBits::eDepthStencilAttachment);;
+        depthAttachment.format = findDepthFormat();
         depthAttachment.samples = vk::SampleCountFlagBits::e1;
-        depthAttachment.loadOp = vk::AttachmentLoadOp::eDontCare;
+        depthAttachment.loadOp = loadOp;
         depthAttachment.storeOp = vk::AttachmentStoreOp::eStore;
         depthAttachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
         depthAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-        depthAttachment.initialLayout = vk::ImageLayout::eUndefined;
-        depthAttachment.finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+        depthAttachment.initialLayout = depthInitialLayout;
+        depthAttachment.finalLayout = depthFinalLayout;
 
         vk::AttachmentReference colorAttachmentRef = {0, vk::ImageLayout::eColorAttachmentOptimal};
         vk::AttachmentReference depthAttachmentRef = {1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
@@ -503,16 +590,42 @@ protected:
         subpass.pColorAttachments = &colorAttachmentRef;
         subpass.pDepthStencilAttachment = &depthAttachmentRef;
 
-        vk::SubpassDependency dependency = {};
-        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-        dependency.dstSubpass = 0;
-        dependency.srcStageMask =
+        std::vector<vk::SubpassDependency> dependencies(1);
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].dstSubpass = 0;
+        dependencies[0].srcStageMask =
                 vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
-        dependency.dstStageMask =
+        dependencies[0].dstStageMask =
                 vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests;
-        dependency.dstAccessMask =
+        dependencies[0].dstAccessMask =
                 vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
 
+        if (depthFinalLayout == vk::ImageLayout::eDepthStencilReadOnlyOptimal) {
+            // Compute shaders sample the depth and the next pass draws on top of the color.
+            dependencies.emplace_back(
+                    0,
+                    VK_SUBPASS_EXTERNAL,
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput
+                    | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    vk::PipelineStageFlagBits::eComputeShader
+                    | vk::PipelineStageFlagBits::eColorAttachmentOutput
+                    | vk::PipelineStageFlagBits::eEarlyFragmentTests
+                    | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                    vk::AccessFlagBits::eShaderRead
+                    | vk::AccessFlagBits::eColorAttachmentWrite
+                    | vk::AccessFlagBits::eDepthStencilAttachmentRead
+                    | vk::AccessFlagBits::eDepthStencilAttachmentWrite
+            );
+        }
+
+        if (depthInitialLayout == vk::ImageLayout::eDepthStencilReadOnlyOptimal) {
+            // The depth leaves the layout the compute shaders sampled it in, both attachments are loaded.
+            dependencies[0].srcStageMask |= vk::PipelineStageFlagBits::eComputeShader;
+            dependencies[0].dstAccessMask |=
+                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentRead;
+        }
+
         std::vector<vk::AttachmentDescription> attachments = {colorAttachment, depthAttachment};
 
         vk::RenderPassCreateInfo renderPassInfo = {};
@@ -520,26 +633,35 @@ protected:
         renderPassInfo.pAttachments = attachments.data();
         renderPassInfo.subpassCount = 1;
         renderPassInfo.pSubpasses = &subpass;
-        renderPassInfo.dependencyCount = 1;
-        renderPassInfo.pDependencies = &dependency;
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
 
         try {
-            renderPass = pvk::Context::getLogicalDevice().createRenderPassUnique(renderPassInfo);
+            return pvk::Context::getLogicalDevice().createRenderPassUnique(renderPassInfo);
         } catch (vk::SystemError &error) {
             throw std::runtime_error("Failed to create render pass");
         }
     }
 
+    /**
+     * The depth attachment is sampled when building a culling::DepthPyramid.
+     */
+    static vk::Format findDepthFormat() {
+        return pvk::util::findSupportedFormat(pvk::Context::getPhysicalDevice(),
+                                              {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint,
+                                               vk::Format::eD24UnormS8Uint},
+                                              vk::ImageTiling::eOptimal,
+                                              vk::FormatFeatureFlagBits::eDepthStencilAttachment
+                                              | vk::FormatFeatureFlagBits::eSampledImage);
+    }
+
     void createDepthResources() {
-        auto format = pvk::util::findSupportedFormat(pvk::Context::getPhysicalDevice(),
-                                                     {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint,
-                                                      vk::Format::eD24UnormS8Uint},
-                                                     vk::ImageTiling::eOptimal,
-                                                     vk::FormatFeatureFlagBits::eDepthStencilAttachment);
+        auto format = findDepthFormat();
 
         pvk::image::create(swapChainExtent.width, swapChainExtent.height, 1,
                            1, vk::SampleCountFlagBits::e1,
-                           format, vk::ImageTiling::eOptimal, vk::ImageUsageFlagBits::eDepthStencilAttachment,
+                           format, vk::ImageTiling::eOptimal,
+                           vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
                            vk::MemoryPropertyFlagBits::eDeviceLocal,
                            {},
                            depthImage, depthImageMemory);
@@ -612,61 +734,84 @@ protected:
         this->camera->update(static_cast<float>(this->xOffset), static_cast<float>(this->yOffset), this->deltaTime);
         this->isMouseActive = false;
 
+        updateObjects();
         update();
     }
 
-    void createCommandBuffers() {
-        commandBuffers.resize(swapChainFramebuffers.size());
-
-        vk::CommandBufferAllocateInfo allocInfo = {};
-        allocInfo.commandPool = pvk::Context::getCommandPool();
-        allocInfo.level = vk::CommandBufferLevel::ePrimary;
-        allocInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());
+    void registerObject(std::shared_ptr<pvk::Object> object) {
+        this->objects.emplace_back(std::move(object));
+    }
 
-        try {
-            commandBuffers = pvk::Context::getLogicalDevice().allocateCommandBuffersUnique(allocInfo);
-        } catch (vk::SystemError &error) {
-            throw std::runtime_error("failed to allocate command buffers!");
-        }
+    void updateObjects() {
+        this->animationLodScheduler.schedule(this->objects, this->camera->position);
 
-        for (size_t i = 0; i < commandBuffers.size(); i++) {
-            vk::CommandBufferBeginInfo beginInfo = {};
-            beginInfo.flags = vk::CommandBufferUsageFlagBits::eSimultaneousUse;
+        auto &threadPool = pvk::util::ThreadPool::getInstance();
+        // A few batches per thread keeps the threads busy when some objects are much more expensive than others.
+        const auto batchSize = std::max<size_t>(1, this->objects.size() / (threadPool.getNumberOfThreads() * 4));
 
-            try {
-                commandBuffers[i].get().begin(beginInfo);
-            }
-            catch (vk::SystemError &error) {
-                throw std::runtime_error("failed to begin recording command buffer!");
+        threadPool.parallelFor(this->objects.size(), batchSize, [this](size_t begin, size_t end, uint32_t) {
+            for (auto i = begin; i < end; i++) {
+                this->objects[i]->update(this->deltaTime);
             }
+        });
+    }
+
+    void createFrameRecorder() {
+        pvk::QueueFamilyIndices queueFamilyIndices = pvk::device::physical::findQueueFamilies(
+                pvk::Context::getPhysicalDevice(), surface.get());
 
-            vk::RenderPassBeginInfo renderPassInfo = {};
-            renderPassInfo.renderPass = renderPass.get();
-            renderPassInfo.framebuffer = swapChainFramebuffers[i].get();
-            renderPassInfo.renderArea.offset = vk::Offset2D(0, 0);
-            renderPassInfo.renderArea.extent = swapChainExtent;
+        this->frameRecorder = std::make_unique<pvk::FrameRecorder>(
+                queueFamilyIndices.graphicsFamily.value(), MAX_FRAMES_IN_FLIGHT, pvk::util::ThreadPool::getInstance()
+        );
+    }
 
-            std::array<vk::ClearValue, 2> clearValues;
-            clearValues[0].color = vk::ClearColorValue(std::array<float, 4>{1.0F, 1.0F, 1.0F, 1.0F});
-            clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0F, 0};
+    /**
+     * Records the frame from scratch, so the draws of a frame can change every frame.
+     */
+    vk::CommandBuffer &recordCommandBuffer(uint32_t imageIndex) {
+        auto &commandBuffer = this->frameRecorder->beginFrame(currentFrame);
 
-            renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-            renderPassInfo.pClearValues = clearValues.data();
+        pvk::CommandBuffer computeCommandBuffer(&commandBuffer, imageIndex);
+        compute(&computeCommandBuffer);
 
-            commandBuffers[i].get().beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+        vk::RenderPassBeginInfo renderPassInfo = {};
+        renderPassInfo.renderPass = hasEarlyPass() ? earlyRenderPass.get() : renderPass.get();
+        renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex].get();
+        renderPassInfo.renderArea.offset = vk::Offset2D(0, 0);
+        renderPassInfo.renderArea.extent = swapChainExtent;
 
-            auto commandBufferPublic = std::make_unique<pvk::CommandBuffer>(&commandBuffers[i].get(), static_cast<uint32_t>(i));
+        std::array<vk::ClearValue, 2> clearValues;
+        clearValues[0].color = vk::ClearColorValue(std::array<float, 4>{1.0F, 1.0F, 1.0F, 1.0F});
+        clearValues[1].depthStencil = vk::ClearDepthStencilValue{1.0F, 0};
 
-            render(commandBufferPublic.get());
+        renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+        renderPassInfo.pClearValues = clearValues.data();
 
-            commandBuffers[i].get().endRenderPass();
+        if (hasEarlyPass()) {
+            commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+            renderEarly(&computeCommandBuffer);
+            commandBuffer.endRenderPass();
 
-            try {
-                commandBuffers[i].get().end();
-            } catch (vk::SystemError &error) {
-                throw std::runtime_error("failed to record command buffer!");
-            }
+            computeAfterEarlyPass(&computeCommandBuffer);
+
+            renderPassInfo.renderPass = mainRenderPass.get();
         }
+
+        commandBuffer.beginRenderPass(renderPassInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+        this->frameRecorder->recordJobs(
+                renderPassInfo.renderPass,
+                swapChainFramebuffers[imageIndex].get(),
+                getNumberOfRenderJobs(),
+                [this, imageIndex](vk::CommandBuffer &jobCommandBuffer, uint32_t jobIndex) {
+                    pvk::CommandBuffer commandBufferPublic(&jobCommandBuffer, imageIndex);
+                    renderJob(&commandBufferPublic, jobIndex);
+                }
+        );
+
+        commandBuffer.endRenderPass();
+
+        return this->frameRecorder->endFrame();
     }
 
     void createSyncObjects() {
@@ -705,6 +850,7 @@ protected:
                     imageAvailableSemaphores[currentFrame].get(),
                     nullptr);
             imageIndex = result.value;
+            currentImageIndex = imageIndex;
         } catch (vk::OutOfDateKHRError &error) {
             recreateSwapChain();
             return;
@@ -720,7 +866,7 @@ protected:
         std::array<vk::PipelineStageFlags, 1> waitStages{vk::PipelineStageFlagBits::eColorAttachmentOutput};
         submitInfo.setWaitSemaphores(waitSemaphores);
         submitInfo.setWaitDstStageMask(waitStages);
-        submitInfo.setCommandBuffers(commandBuffers[imageIndex].get());
+        submitInfo.setCommandBuffers(recordCommandBuffer(imageIndex));
 
         std::array<vk::Semaphore, 1> signalSemaphores{renderFinishedSemaphores[currentFrame].get()};
         submitInfo.setSignalSemaphores(signalSemaphores);
@@ -59,9 +59,13 @@ namespace pvk::buffer {
 /**
  Copies the contents from the source buffer to the target buffer.
  */
-    void copy(vk::Queue &graphicsQueue, vk::UniqueBuffer &srcBuffer, vk::UniqueBuffer &dstBuffer, vk::DeviceSize size) {
+    void copy(vk::Queue &graphicsQueue,
+              vk::UniqueBuffer &srcBuffer,
+              vk::UniqueBuffer &dstBuffer,
+              vk::DeviceSize size,
+              vk::DeviceSize dstOffset) {
         vk::CommandBufferAllocateInfo allocInfo = {Context::getCommandPool(), vk::CommandBufferLevel::ePrimary, 1};
-        vk::BufferCopy copyRegion = {0, 0, size};
+        vk::BufferCopy copyRegion = {0, dstOffset, size};
 
         auto commandBuffer = std::move(Context::getLogicalDevice().allocateCommandBuffersUnique(allocInfo)[0]);
         commandBuffer.get().begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
@@ -104,6 +108,54 @@ namespace pvk::buffer {
         Context::getLogicalDevice().unmapMemory(bufferMemory.get());
     }
 
+    void *createMapped(vk::DeviceSize size,
+                       vk::BufferUsageFlags usage,
+                       vk::UniqueBuffer &buffer,
+                       vk::UniqueDeviceMemory &bufferMemory) {
+        create(size,
+               usage,
+               vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+               buffer,
+               bufferMemory);
+
+        return Context::getLogicalDevice().mapMemory(bufferMemory.get(), 0, size);
+    }
+
+    void createDeviceLocal(const void *data,
+                           vk::DeviceSize size,
+                           vk::BufferUsageFlags usage,
+                           vk::UniqueBuffer &buffer,
+                           vk::UniqueDeviceMemory &bufferMemory) {
+        vk::UniqueBuffer stagingBuffer;
+        vk::UniqueDeviceMemory stagingBufferMemory;
+        auto *mappedData = createMapped(size, vk::BufferUsageFlagBits::eTransferSrc, stagingBuffer, stagingBufferMemory);
+        memcpy(mappedData, data, static_cast<size_t>(size));
+        Context::getLogicalDevice().unmapMemory(stagingBufferMemory.get());
+
+        create(size,
+               usage | vk::BufferUsageFlagBits::eTransferDst,
+               vk::MemoryPropertyFlagBits::eDeviceLocal,
+               buffer,
+               bufferMemory);
+
+        auto graphicsQueue = Context::getGraphicsQueue();
+        copy(graphicsQueue, stagingBuffer, buffer, size);
+    }
+
+    void upload(vk::Queue &graphicsQueue,
+                const void *data,
+                vk::DeviceSize size,
+                vk::UniqueBuffer &buffer,
+                vk::DeviceSize offset) {
+        vk::UniqueBuffer stagingBuffer;
+        vk::UniqueDeviceMemory stagingBufferMemory;
+        auto *mappedData = createMapped(size, vk::BufferUsageFlagBits::eTransferSrc, stagingBuffer, stagingBufferMemory);
+        memcpy(mappedData, data, static_cast<size_t>(size));
+        Context::getLogicalDevice().unmapMemory(stagingBufferMemory.get());
+
+        copy(graphicsQueue, stagingBuffer, buffer, size, offset);
+    }
+
 //    template<typename T, vk::BufferUsageFlagBits F>
 //    auto create(vk::Queue &graphicsQueue,
 //                vk::UniqueBuffer &buffer,
@@ -148,8 +200,10 @@ namespace pvk::buffer {
             void *data = Context::getLogicalDevice().mapMemory(stagingBufferMemory.get(), 0, bufferSize);
             memcpy(data, vertices.data(), (size_t) bufferSize);
 
+            // Compute passes such as skinning read the bind pose vertices as a storage buffer.
             pvk::buffer::create(bufferSize,
-                                vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+                                vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer |
+                                vk::BufferUsageFlagBits::eStorageBuffer,
                                 vk::MemoryPropertyFlagBits::eDeviceLocal,
                                 buffer,
                                 bufferMemory);
@@ -157,7 +211,8 @@ namespace pvk::buffer {
             pvk::buffer::copy(graphicsQueue, stagingBuffer, buffer, bufferSize);
         }
 
-        std::pair<vk::UniqueBuffer, vk::UniqueDeviceMemory> create(const std::vector<Vertex> &vertices) {
+        std::pair<vk::UniqueBuffer, vk::UniqueDeviceMemory> create(const std::vector<Vertex> &vertices,
+                                                                   vk::BufferUsageFlags additionalUsage) {
             auto bufferSize = sizeof(vertices.front()) * vertices.size();
 
             vk::UniqueBuffer stagingBuffer;
@@ -178,7 +233,7 @@ namespace pvk::buffer {
 
             pvk::buffer::create(
                     bufferSize,
-                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer | additionalUsage,
                     vk::MemoryPropertyFlagBits::eDeviceLocal,
                     buffer,
                     bufferMemory
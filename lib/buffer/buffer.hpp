@@ -40,7 +40,8 @@ namespace pvk {
         void copy(vk::Queue &graphicsQueue,
                   vk::UniqueBuffer &srcBuffer,
                   vk::UniqueBuffer &dstBuffer,
-                  vk::DeviceSize size);
+                  vk::DeviceSize size,
+                  vk::DeviceSize dstOffset = 0);
         
         void copyToImage(const vk::CommandBuffer &commandBuffer, const vk::Queue &graphicsQueue,
                          const vk::UniqueBuffer &buffer,
@@ -50,6 +51,33 @@ namespace pvk {
                     size_t bufferSize,
                     void* data);
 
+        /**
+         * Creates a host visible and coherent buffer which stays mapped until its memory is unmapped or freed.
+         * @return Pointer to the mapped memory.
+         */
+        void *createMapped(vk::DeviceSize size,
+                           vk::BufferUsageFlags usage,
+                           vk::UniqueBuffer &buffer,
+                           vk::UniqueDeviceMemory &bufferMemory);
+
+        /**
+         * Creates a device local buffer and uploads data to it through a staging buffer.
+         */
+        void createDeviceLocal(const void *data,
+                               vk::DeviceSize size,
+                               vk::BufferUsageFlags usage,
+                               vk::UniqueBuffer &buffer,
+                               vk::UniqueDeviceMemory &bufferMemory);
+
+        /**
+         * Uploads data into a region of an existing device local buffer through a staging buffer.
+         */
+        void upload(vk::Queue &graphicsQueue,
+                    const void *data,
+                    vk::DeviceSize size,
+                    vk::UniqueBuffer &buffer,
+                    vk::DeviceSize offset);
+
 //        template<typename T, vk::BufferUsageFlagBits F>
 //        auto create(vk::Queue &graphicsQueue,
 //                    vk::UniqueBuffer &buffer,
@@ -58,7 +86,8 @@ namespace pvk {
 //        ) -> void;
 
         namespace vertex {
-            std::pair<vk::UniqueBuffer, vk::UniqueDeviceMemory> create(const std::vector<Vertex> &vertices);
+            std::pair<vk::UniqueBuffer, vk::UniqueDeviceMemory> create(const std::vector<Vertex> &vertices,
+                                                                       vk::BufferUsageFlags additionalUsage = {});
 
             void create(vk::Queue &graphicsQueue,
                         vk::UniqueBuffer &buffer,
@@ -0,0 +1,135 @@
+//
+//  geometryArena.cpp
+//  PVK
+//
+
+#include "geometryArena.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "buffer.hpp"
+
+namespace pvk {
+    GeometryArena::Allocation::~Allocation() {
+        this->release();
+    }
+
+    GeometryArena::Allocation::Allocation(Allocation &&other) noexcept
+            : arena(std::exchange(other.arena, nullptr)),
+              firstVertex(other.firstVertex),
+              numberOfVertices(other.numberOfVertices),
+              firstIndex(other.firstIndex),
+              numberOfIndices(other.numberOfIndices) {
+    }
+
+    GeometryArena::Allocation &GeometryArena::Allocation::operator=(Allocation &&other) noexcept {
+        if (this != &other) {
+            this->release();
+            this->arena = std::exchange(other.arena, nullptr);
+            this->firstVertex = other.firstVertex;
+            this->numberOfVertices = other.numberOfVertices;
+            this->firstIndex = other.firstIndex;
+            this->numberOfIndices = other.numberOfIndices;
+        }
+
+        return *this;
+    }
+
+    void GeometryArena::Allocation::release() {
+        if (this->arena != nullptr) {
+            std::exchange(this->arena, nullptr)->free(*this);
+        }
+    }
+
+    GeometryArena::GeometryArena(uint32_t maximumNumberOfVertices, uint32_t maximumNumberOfIndices)
+            : vertexRanges(maximumNumberOfVertices), indexRanges(maximumNumberOfIndices) {
+        // Storage usage lets compute passes such as skinning read the vertices in place.
+        buffer::create(
+                sizeof(Vertex) * std::max<uint32_t>(maximumNumberOfVertices, 1),
+                vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                vk::BufferUsageFlagBits::eTransferDst,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                this->vertexBuffer,
+                this->vertexBufferMemory
+        );
+        buffer::create(
+                sizeof(uint32_t) * std::max<uint32_t>(maximumNumberOfIndices, 1),
+                vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+                vk::BufferUsageFlagBits::eTransferDst,
+                vk::MemoryPropertyFlagBits::eDeviceLocal,
+                this->indexBuffer,
+                this->indexBufferMemory
+        );
+    }
+
+    GeometryArena::Allocation GeometryArena::allocate(vk::Queue &graphicsQueue,
+                                                      std::span<const Vertex> vertices,
+                                                      std::span<const uint32_t> indices) {
+        const auto numberOfVertices = static_cast<uint32_t>(vertices.size());
+        const auto numberOfIndices = static_cast<uint32_t>(indices.size());
+        const auto firstVertex = numberOfVertices > 0
+                                 ? this->vertexRanges.allocate(numberOfVertices)
+                                 : std::optional<uint32_t>(0);
+
+        if (!firstVertex.has_value()) {
+            throw std::runtime_error("Geometry arena has no room for the vertices of the mesh.");
+        }
+
+        const auto firstIndex = numberOfIndices > 0
+                                ? this->indexRanges.allocate(numberOfIndices)
+                                : std::optional<uint32_t>(0);
+
+        if (!firstIndex.has_value()) {
+            this->vertexRanges.free(*firstVertex, numberOfVertices);
+            throw std::runtime_error("Geometry arena has no room for the indices of the mesh.");
+        }
+
+        if (numberOfVertices > 0) {
+            buffer::upload(graphicsQueue,
+                           vertices.data(),
+                           sizeof(Vertex) * numberOfVertices,
+                           this->vertexBuffer,
+                           sizeof(Vertex) * static_cast<vk::DeviceSize>(*firstVertex));
+        }
+
+        if (numberOfIndices > 0) {
+            buffer::upload(graphicsQueue,
+                           indices.data(),
+                           sizeof(uint32_t) * numberOfIndices,
+                           this->indexBuffer,
+                           sizeof(uint32_t) * static_cast<vk::DeviceSize>(*firstIndex));
+        }
+
+        Allocation allocation;
+        allocation.arena = this;
+        allocation.firstVertex = *firstVertex;
+        allocation.numberOfVertices = numberOfVertices;
+        allocation.firstIndex = *firstIndex;
+        allocation.numberOfIndices = numberOfIndices;
+
+        return allocation;
+    }
+
+    void GeometryArena::free(const Allocation &allocation) {
+        this->vertexRanges.free(allocation.firstVertex, allocation.numberOfVertices);
+        this->indexRanges.free(allocation.firstIndex, allocation.numberOfIndices);
+    }
+
+    const vk::Buffer &GeometryArena::getVertexBuffer() const {
+        return this->vertexBuffer.get();
+    }
+
+    const vk::Buffer &GeometryArena::getIndexBuffer() const {
+        return this->indexBuffer.get();
+    }
+
+    const util::FreeList &GeometryArena::getVertexRanges() const {
+        return this->vertexRanges;
+    }
+
+    const util::FreeList &GeometryArena::getIndexRanges() const {
+        return this->indexRanges;
+    }
+}  // namespace pvk
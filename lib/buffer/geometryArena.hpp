@@ -0,0 +1,115 @@
+//
+//  geometryArena.hpp
+//  PVK
+//
+
+#ifndef PVK_GEOMETRYARENA_HPP
+#define PVK_GEOMETRYARENA_HPP
+
+#include <span>
+#include <vulkan/vulkan.hpp>
+
+#include "../mesh/vertex.hpp"
+#include "../util/freeList.hpp"
+#include "../util/util.hpp"
+
+namespace pvk {
+    /**
+     * Shared device local vertex and index buffers which meshes are sub-allocated from. Meshes placed in the same
+     * arena are drawn with a single vertex and index buffer bind, using the first index and vertex offset of their
+     * allocation, which also allows multi-draw indirect across meshes. Freed ranges are merged and reused.
+     *
+     * Indices of a mesh stay relative to its own vertices, the vertex offset of a draw moves them into the arena.
+     * The arena has to outlive all of its allocations and is not thread safe.
+     */
+    class GeometryArena : util::NoCopy {
+    public:
+        /**
+         * Vertex and index range of a mesh, which is returned to the arena when the allocation is destroyed.
+         */
+        class Allocation {
+        public:
+            Allocation() = default;
+
+            ~Allocation();
+
+            Allocation(const Allocation &other) = delete;
+
+            Allocation &operator=(const Allocation &other) = delete;
+
+            Allocation(Allocation &&other) noexcept;
+
+            Allocation &operator=(Allocation &&other) noexcept;
+
+            [[nodiscard]] bool isValid() const {
+                return this->arena != nullptr;
+            }
+
+            [[nodiscard]] const GeometryArena &getArena() const {
+                return *this->arena;
+            }
+
+            [[nodiscard]] uint32_t getFirstVertex() const {
+                return this->firstVertex;
+            }
+
+            [[nodiscard]] uint32_t getNumberOfVertices() const {
+                return this->numberOfVertices;
+            }
+
+            [[nodiscard]] uint32_t getFirstIndex() const {
+                return this->firstIndex;
+            }
+
+            [[nodiscard]] uint32_t getNumberOfIndices() const {
+                return this->numberOfIndices;
+            }
+
+        private:
+            friend class GeometryArena;
+
+            void release();
+
+            GeometryArena *arena = nullptr;
+            uint32_t firstVertex = 0;
+            uint32_t numberOfVertices = 0;
+            uint32_t firstIndex = 0;
+            uint32_t numberOfIndices = 0;
+        };
+
+        GeometryArena(uint32_t maximumNumberOfVertices, uint32_t maximumNumberOfIndices);
+
+        GeometryArena(GeometryArena &&other) = delete;
+
+        GeometryArena &operator=(GeometryArena &&other) = delete;
+
+        /**
+         * Places a mesh in the arena and uploads it.
+         * @throws std::runtime_error When the arena has no free range large enough for the vertices or indices.
+         */
+        Allocation allocate(vk::Queue &graphicsQueue,
+                            std::span<const Vertex> vertices,
+                            std::span<const uint32_t> indices);
+
+        [[nodiscard]] const vk::Buffer &getVertexBuffer() const;
+
+        [[nodiscard]] const vk::Buffer &getIndexBuffer() const;
+
+        [[nodiscard]] const util::FreeList &getVertexRanges() const;
+
+        [[nodiscard]] const util::FreeList &getIndexRanges() const;
+
+    private:
+        void free(const Allocation &allocation);
+
+        util::FreeList vertexRanges;
+        util::FreeList indexRanges;
+
+        vk::UniqueBuffer vertexBuffer;
+        vk::UniqueDeviceMemory vertexBufferMemory;
+        vk::UniqueBuffer indexBuffer;
+        vk::UniqueDeviceMemory indexBufferMemory;
+    };
+}  // namespace pvk
+
+#endif //PVK_GEOMETRYARENA_HPP
@@ -11,9 +11,16 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "../culling/gpuCuller.hpp"
+#include "../culling/meshletCuller.hpp"
+#include "../culling/primitiveCuller.hpp"
+#include "renderQueue.hpp"
 #include "../gltf/GLTFNode.hpp"
 #include "../pipeline/pipeline.hpp"
 #include "../object/gameObject.hpp"
+#include "../object/instanceBatches.hpp"
+#include "../skinning/crowd.hpp"
+#include "../skinning/skinningPass.hpp"
 
 namespace pvk
 {
@@ -25,16 +32,99 @@ class CommandBuffer
 
     void drawObject(const Pipeline &pipeline, const pvk::object::GameObject &object)
     {
+        const auto &mesh = object.getMesh();
+
         this->commandBuffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVulkanPipeline().get());
-        this->commandBuffer->bindVertexBuffers(0, object.getMesh().getVertexBuffer(), {0});
-        this->commandBuffer->bindIndexBuffer(object.getMesh().getIndexBuffer(), 0, vk::IndexType::eUint32);
-        this->commandBuffer->drawIndexed(object.getMesh().getIndices().size(), 1, 0, 0, 0);
+        pipeline.bindVertices(*this->commandBuffer, mesh.getVertexBuffer(), mesh.getVertexLayout());
+        this->commandBuffer->bindIndexBuffer(mesh.getIndexBuffer(), 0, vk::IndexType::eUint32);
+        this->commandBuffer->drawIndexed(mesh.getIndices().size(), 1, mesh.getFirstIndex(), mesh.getVertexOffset(), 0);
     }
 
     void drawNode(const Pipeline &pipeline, const gltf::Object &object, const gltf::Node &node)
+    {
+        this->drawNode(pipeline, object, node, object.getVertexBuffer());
+    }
+
+    /**
+     * Records the skinning pass of this swap chain image, must be called outside of a render pass.
+     */
+    void dispatchSkinning(const skinning::SkinningPass &skinningPass)
+    {
+        skinningPass.record(*this->commandBuffer, this->swapchainIndex);
+    }
+
+    /**
+     * Draws a node from the vertices written by the skinning pass. The node is drawn as a static mesh, so its
+     * uniform buffer should report no joints.
+     */
+    void drawSkinnedNode(const Pipeline &pipeline,
+                         const gltf::Object &object,
+                         const gltf::Node &node,
+                         const skinning::SkinningPass &skinningPass)
+    {
+        this->drawNode(pipeline, object, node, skinningPass.getVertexBuffer(this->swapchainIndex));
+    }
+
+    /**
+     * Records the packets of a render queue in their sorted order, skipping redundant binds.
+     */
+    void drawRenderQueue(RenderQueue &renderQueue)
+    {
+        renderQueue.record(*this->commandBuffer, this->swapchainIndex);
+    }
+
+    /**
+     * Records the GPU culling pass of this swap chain image, must be called outside of a render pass.
+     */
+    void dispatchCulling(const culling::GpuCuller &culler, const culling::Frustum &frustum)
+    {
+        culler.recordCulling(*this->commandBuffer, frustum, this->swapchainIndex);
+    }
+
+    /**
+     * Draws the instances which survived GPU culling, one indirect draw per primitive.
+     */
+    void drawGpuCulled(const Pipeline &pipeline, const culling::GpuCuller &culler)
+    {
+        culler.recordDraws(*this->commandBuffer, pipeline, this->swapchainIndex);
+    }
+
+    /**
+     * Builds the depth pyramid from the depth of the early render pass, see Application::computeAfterEarlyPass().
+     */
+    void buildDepthPyramid(const culling::DepthPyramid &depthPyramid)
+    {
+        depthPyramid.record(*this->commandBuffer);
+    }
+
+    /**
+     * Records the late occlusion culling phase of this swap chain image, after the depth pyramid has been built.
+     */
+    void dispatchLateCulling(const culling::GpuCuller &culler, const glm::mat4 &viewProjection)
+    {
+        culler.recordLateCulling(*this->commandBuffer, viewProjection, this->swapchainIndex);
+    }
+
+    /**
+     * Draws the instances which were occluded last frame but survived the late culling phase.
+     */
+    void drawGpuCulledLate(const Pipeline &pipeline, const culling::GpuCuller &culler)
+    {
+        culler.recordLateDraws(*this->commandBuffer, pipeline, this->swapchainIndex);
+    }
+
+    /**
+     * Draws all instances of a crowd with the pipeline it was created with.
+     */
+    void drawCrowd(const skinning::Crowd &crowd)
+    {
+        crowd.record(*this->commandBuffer, this->swapchainIndex);
+    }
+
+    void drawNode(const Pipeline &pipeline, const gltf::Object &object, const gltf::Node &node, vk::Buffer vertexBuffer)
     {
         this->commandBuffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVulkanPipeline().get());
-        this->commandBuffer->bindVertexBuffers(0, object.vertexBuffer.get(), {0});
+        pipeline.bindVertices(*this->commandBuffer, vertexBuffer, object.getVertexLayout());
         if (object.indices.empty())
         {
             this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
@@ -51,7 +141,7 @@ class CommandBuffer
         }
         else
         {
-            this->commandBuffer->bindIndexBuffer(object.indexBuffer.get(), 0, vk::IndexType::eUint32);
+            this->commandBuffer->bindIndexBuffer(object.getIndexBuffer(), 0, vk::IndexType::eUint32);
             this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
                                                     pipeline.getPipelineLayout().get(),
                                                     0,
@@ -73,7 +163,224 @@ class CommandBuffer
                                                             0,
                                                             nullptr);
                 }
-                this->commandBuffer->drawIndexed(primitive->getIndexCount(), 1, primitive->getStartIndex(), 0, 0);
+                this->commandBuffer->drawIndexed(primitive->getIndexCount(),
+                                                 1,
+                                                 primitive->getFirstIndex(),
+                                                 primitive->getVertexOffset(),
+                                                 0);
+            }
+        }
+    }
+
+    /**
+     * Draws a list of primitives, usually the visible draws of a culling::PrimitiveCuller. Buffers and node
+     * descriptor sets are only bound when they differ from the previous draw.
+     */
+    void drawPrimitives(const Pipeline &pipeline, std::span<const culling::PrimitiveCuller::Draw> draws)
+    {
+        this->commandBuffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVulkanPipeline().get());
+
+        vk::Buffer boundVertexBuffer;
+        vk::Buffer boundIndexBuffer;
+        const gltf::Node *boundNode = nullptr;
+
+        for (const auto &draw : draws)
+        {
+            const bool isIndexed = !draw.object->indices.empty();
+
+            // Objects in the same geometry arena share their buffers.
+            if (draw.object->getVertexBuffer() != boundVertexBuffer)
+            {
+                boundVertexBuffer = draw.object->getVertexBuffer();
+                pipeline.bindVertices(*this->commandBuffer, boundVertexBuffer, draw.object->getVertexLayout());
+            }
+
+            if (isIndexed && draw.object->getIndexBuffer() != boundIndexBuffer)
+            {
+                boundIndexBuffer = draw.object->getIndexBuffer();
+                this->commandBuffer->bindIndexBuffer(boundIndexBuffer, 0, vk::IndexType::eUint32);
+            }
+
+            if (draw.node != boundNode)
+            {
+                this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                        pipeline.getPipelineLayout().get(),
+                                                        0,
+                                                        isIndexed ? draw.node->getDescriptorSets().size() : 1,
+                                                        draw.node->getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                        0,
+                                                        nullptr);
+                boundNode = draw.node;
+            }
+
+            if (!isIndexed)
+            {
+                this->commandBuffer->draw(draw.primitive->getVertexCount(), 1, draw.primitive->getStartVertex(), 0);
+                continue;
+            }
+
+            if (!draw.primitive->getDescriptorSets().empty())
+            {
+                this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                        pipeline.getPipelineLayout().get(),
+                                                        1,
+                                                        draw.primitive->getDescriptorSets().size(),
+                                                        draw.primitive->getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                        0,
+                                                        nullptr);
+            }
+
+            this->commandBuffer->drawIndexed(draw.primitive->getIndexCount(),
+                                             1,
+                                             draw.primitive->getFirstIndex(),
+                                             draw.primitive->getVertexOffset(),
+                                             0);
+        }
+    }
+
+    /**
+     * Draws every primitive of a node numberOfInstances times, the transforms are read per instance from binding 1.
+     * The pipeline has to be created from a definition with "instanced" set.
+     */
+    void drawNodeInstanced(const Pipeline &pipeline,
+                           const gltf::Object &object,
+                           const gltf::Node &node,
+                           vk::Buffer instanceBuffer,
+                           uint32_t firstInstance,
+                           uint32_t numberOfInstances)
+    {
+        this->commandBuffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVulkanPipeline().get());
+        pipeline.bindVertices(*this->commandBuffer, object.getVertexBuffer(), object.getVertexLayout());
+        this->commandBuffer->bindVertexBuffers(Instance::BINDING, instanceBuffer, {0});
+
+        if (object.indices.empty())
+        {
+            this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                    pipeline.getPipelineLayout().get(),
+                                                    0,
+                                                    1,
+                                                    node.getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                    0,
+                                                    nullptr);
+
+            for (const auto &primitive : node.primitives)
+            {
+                this->commandBuffer->draw(primitive->getVertexCount(),
+                                          numberOfInstances,
+                                          primitive->getStartVertex(),
+                                          firstInstance);
+            }
+
+            return;
+        }
+
+        this->commandBuffer->bindIndexBuffer(object.getIndexBuffer(), 0, vk::IndexType::eUint32);
+        this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                pipeline.getPipelineLayout().get(),
+                                                0,
+                                                node.getDescriptorSets().size(),
+                                                node.getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                0,
+                                                nullptr);
+
+        for (const auto &primitive : node.primitives)
+        {
+            if (!primitive->getDescriptorSets().empty())
+            {
+                this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                        pipeline.getPipelineLayout().get(),
+                                                        1,
+                                                        primitive->getDescriptorSets().size(),
+                                                        primitive->getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                        0,
+                                                        nullptr);
+            }
+
+            this->commandBuffer->drawIndexed(primitive->getIndexCount(),
+                                             numberOfInstances,
+                                             primitive->getFirstIndex(),
+                                             primitive->getVertexOffset(),
+                                             firstInstance);
+        }
+    }
+
+    /**
+     * Draws all batches of an object, one instanced draw per primitive of every batch.
+     */
+    void drawInstanceBatches(const Pipeline &pipeline,
+                             const gltf::Object &object,
+                             const object::InstanceBatches &instanceBatches)
+    {
+        const auto instanceBuffer = instanceBatches.getInstanceBuffer(this->swapchainIndex);
+
+        for (const auto &batch : instanceBatches.getBatches())
+        {
+            this->drawNodeInstanced(pipeline,
+                                    object,
+                                    *batch.node,
+                                    instanceBuffer,
+                                    batch.firstInstance,
+                                    batch.numberOfInstances);
+        }
+    }
+
+    /**
+     * Draws the meshlets of a node which survived culling, reading the draw commands from the indirect buffer
+     * the culler fills for this swap chain image.
+     */
+    void drawNodeMeshlets(const Pipeline &pipeline,
+                          const gltf::Object &object,
+                          const gltf::Node &node,
+                          const culling::MeshletCuller &culler)
+    {
+        const auto batches = culler.getBatchesByNode(node.nodeIndex);
+
+        if (object.indices.empty() || batches.empty())
+        {
+            this->drawNode(pipeline, object, node);
+            return;
+        }
+
+        this->commandBuffer->bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.getVulkanPipeline().get());
+        pipeline.bindVertices(*this->commandBuffer, object.getVertexBuffer(), object.getVertexLayout());
+        this->commandBuffer->bindIndexBuffer(object.getIndexBuffer(), 0, vk::IndexType::eUint32);
+        this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                pipeline.getPipelineLayout().get(),
+                                                0,
+                                                node.getDescriptorSets().size(),
+                                                node.getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                0,
+                                                nullptr);
+
+        const auto indirectBuffer = culler.getIndirectBuffer(this->swapchainIndex);
+        const bool isMultiDrawSupported = Context::getEnabledFeatures().multiDrawIndirect == VK_TRUE;
+        constexpr auto stride = static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand));
+
+        for (const auto &batch : batches)
+        {
+            if (!batch.primitive->getDescriptorSets().empty())
+            {
+                this->commandBuffer->bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                        pipeline.getPipelineLayout().get(),
+                                                        1,
+                                                        batch.primitive->getDescriptorSets().size(),
+                                                        batch.primitive->getDescriptorSetsBySwapChainIndex(this->swapchainIndex).data(),
+                                                        0,
+                                                        nullptr);
+            }
+
+            const vk::DeviceSize offset = static_cast<vk::DeviceSize>(batch.firstCommand) * stride;
+
+            if (isMultiDrawSupported)
+            {
+                this->commandBuffer->drawIndexedIndirect(indirectBuffer, offset, batch.numberOfCommands, stride);
+            }
+            else
+            {
+                for (uint32_t i = 0; i < batch.numberOfCommands; i++)
+                {
+                    this->commandBuffer->drawIndexedIndirect(indirectBuffer, offset + i * stride, 1, stride);
+                }
             }
         }
     }
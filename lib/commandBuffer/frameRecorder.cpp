@@ -0,0 +1,151 @@
+//
+//  frameRecorder.cpp
+//  PVK
+//
+
+#include "frameRecorder.hpp"
+
+#include "../context/context.hpp"
+
+namespace pvk {
+    FrameRecorder::FrameRecorder(
+            uint32_t queueFamilyIndex,
+            uint32_t numberOfFramesInFlight,
+            util::ThreadPool &newThreadPool
+    ) : threadPool(newThreadPool) {
+        const auto &logicalDevice = Context::getLogicalDevice();
+
+        vk::CommandPoolCreateInfo poolInfo = {};
+        poolInfo.flags = vk::CommandPoolCreateFlagBits::eTransient;
+        poolInfo.queueFamilyIndex = queueFamilyIndex;
+
+        this->frames.resize(numberOfFramesInFlight);
+
+        for (auto &frame : this->frames) {
+            frame.threads.resize(this->threadPool.getNumberOfThreads());
+
+            for (auto &thread : frame.threads) {
+                try {
+                    thread.commandPool = logicalDevice.createCommandPoolUnique(poolInfo);
+                } catch (vk::SystemError &error) {
+                    throw std::runtime_error("Failed to create command pool");
+                }
+            }
+
+            vk::CommandBufferAllocateInfo allocInfo = {};
+            allocInfo.commandPool = frame.threads[0].commandPool.get();
+            allocInfo.level = vk::CommandBufferLevel::ePrimary;
+            allocInfo.commandBufferCount = 1;
+
+            try {
+                frame.primaryCommandBuffer = logicalDevice.allocateCommandBuffers(allocInfo)[0];
+            } catch (vk::SystemError &error) {
+                throw std::runtime_error("failed to allocate command buffers!");
+            }
+        }
+    }
+
+    vk::CommandBuffer &FrameRecorder::beginFrame(size_t frameIndex) {
+        const auto &logicalDevice = Context::getLogicalDevice();
+
+        this->currentFrame = frameIndex;
+        auto &frame = this->frames[frameIndex];
+
+        for (auto &thread : frame.threads) {
+            logicalDevice.resetCommandPool(thread.commandPool.get(), {});
+            thread.numberOfUsedCommandBuffers = 0;
+        }
+
+        vk::CommandBufferBeginInfo beginInfo = {};
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+
+        try {
+            frame.primaryCommandBuffer.begin(beginInfo);
+        } catch (vk::SystemError &error) {
+            throw std::runtime_error("failed to begin recording command buffer!");
+        }
+
+        return frame.primaryCommandBuffer;
+    }
+
+    void FrameRecorder::recordJobs(
+            vk::RenderPass renderPass,
+            vk::Framebuffer framebuffer,
+            uint32_t numberOfJobs,
+            const Job &job
+    ) {
+        if (numberOfJobs == 0) {
+            return;
+        }
+
+        this->jobCommandBuffers.resize(numberOfJobs);
+
+        vk::CommandBufferInheritanceInfo inheritanceInfo = {};
+        inheritanceInfo.renderPass = renderPass;
+        inheritanceInfo.subpass = 0;
+        inheritanceInfo.framebuffer = framebuffer;
+
+        vk::CommandBufferBeginInfo beginInfo = {};
+        beginInfo.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                          vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+        beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+        // Jobs can differ a lot in cost, so they are handed out one at a time.
+        this->threadPool.parallelFor(numberOfJobs, 1, [&](size_t begin, size_t end, uint32_t threadIndex) {
+            for (auto i = begin; i < end; i++) {
+                auto commandBuffer = this->acquireSecondaryCommandBuffer(threadIndex);
+
+                try {
+                    commandBuffer.begin(beginInfo);
+                } catch (vk::SystemError &error) {
+                    throw std::runtime_error("failed to begin recording command buffer!");
+                }
+
+                job(commandBuffer, static_cast<uint32_t>(i));
+
+                try {
+                    commandBuffer.end();
+                } catch (vk::SystemError &error) {
+                    throw std::runtime_error("failed to record command buffer!");
+                }
+
+                this->jobCommandBuffers[i] = commandBuffer;
+            }
+        });
+
+        this->frames[this->currentFrame].primaryCommandBuffer.executeCommands(this->jobCommandBuffers);
+    }
+
+    vk::CommandBuffer &FrameRecorder::endFrame() {
+        auto &primaryCommandBuffer = this->frames[this->currentFrame].primaryCommandBuffer;
+
+        try {
+            primaryCommandBuffer.end();
+        } catch (vk::SystemError &error) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+
+        return primaryCommandBuffer;
+    }
+
+    vk::CommandBuffer FrameRecorder::acquireSecondaryCommandBuffer(uint32_t threadIndex) {
+        auto &thread = this->frames[this->currentFrame].threads[threadIndex];
+
+        if (thread.numberOfUsedCommandBuffers == thread.secondaryCommandBuffers.size()) {
+            vk::CommandBufferAllocateInfo allocInfo = {};
+            allocInfo.commandPool = thread.commandPool.get();
+            allocInfo.level = vk::CommandBufferLevel::eSecondary;
+            allocInfo.commandBufferCount = 1;
+
+            try {
+                thread.secondaryCommandBuffers.emplace_back(
+                        Context::getLogicalDevice().allocateCommandBuffers(allocInfo)[0]
+                );
+            } catch (vk::SystemError &error) {
+                throw std::runtime_error("failed to allocate command buffers!");
+            }
+        }
+
+        return thread.secondaryCommandBuffers[thread.numberOfUsedCommandBuffers++];
+    }
+}  // namespace pvk
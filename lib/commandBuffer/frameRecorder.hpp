@@ -0,0 +1,75 @@
+//
+//  frameRecorder.hpp
+//  PVK
+//
+
+#ifndef PVK_FRAMERECORDER_HPP
+#define PVK_FRAMERECORDER_HPP
+
+#include <functional>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "../util/threadPool.hpp"
+
+namespace pvk {
+    /**
+     * Owns the command buffers used to record a frame from scratch. Every frame in flight has one command pool
+     * per thread of the thread pool, so threads never share a pool. All pools of a frame are reset at once when
+     * the frame starts, after its fence was waited on, which recycles every command buffer of that frame.
+     */
+    class FrameRecorder {
+    public:
+        /**
+         * Records a single job into a secondary command buffer which continues the render pass of the frame.
+         */
+        using Job = std::function<void(vk::CommandBuffer &commandBuffer, uint32_t jobIndex)>;
+
+        FrameRecorder(uint32_t queueFamilyIndex, uint32_t numberOfFramesInFlight, util::ThreadPool &newThreadPool);
+
+        /**
+         * Resets all command pools of a frame and starts recording its primary command buffer.
+         * @return Primary command buffer of the frame, valid until the frame is started again.
+         */
+        vk::CommandBuffer &beginFrame(size_t frameIndex);
+
+        /**
+         * Records the jobs in parallel, each in its own secondary command buffer, and executes them from the
+         * primary command buffer in job order. The render pass has to be begun with secondary command buffer
+         * contents.
+         * @throws Rethrows the first exception thrown by a job, nothing is executed from the primary command buffer
+         *         in that case.
+         */
+        void recordJobs(vk::RenderPass renderPass, vk::Framebuffer framebuffer, uint32_t numberOfJobs, const Job &job);
+
+        /**
+         * Finishes recording the primary command buffer of the current frame.
+         */
+        vk::CommandBuffer &endFrame();
+
+    private:
+        // Command buffers are freed together with the pool they were allocated from.
+        struct ThreadCommands {
+            vk::UniqueCommandPool commandPool;
+            std::vector<vk::CommandBuffer> secondaryCommandBuffers;
+            size_t numberOfUsedCommandBuffers = 0;
+        };
+
+        struct FrameCommands {
+            std::vector<ThreadCommands> threads;
+            // Allocated from the pool of thread 0, which is the thread recording the frame.
+            vk::CommandBuffer primaryCommandBuffer;
+        };
+
+        util::ThreadPool &threadPool;
+        std::vector<FrameCommands> frames;
+        size_t currentFrame = 0;
+
+        // Secondary command buffers of the jobs recorded last, in the order they are executed.
+        std::vector<vk::CommandBuffer> jobCommandBuffers;
+
+        vk::CommandBuffer acquireSecondaryCommandBuffer(uint32_t threadIndex);
+    };
+}  // namespace pvk
+
+#endif //PVK_FRAMERECORDER_HPP
@@ -0,0 +1,261 @@
+//
+//  renderQueue.cpp
+//  PVK
+//
+
+#include "renderQueue.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+    constexpr uint64_t PIPELINE_BITS = 10;
+    constexpr uint64_t GEOMETRY_BITS = 10;
+    constexpr uint64_t MATERIAL_BITS = 19;
+    constexpr uint64_t DEPTH_BITS = 24;
+    constexpr uint64_t DEPTH_BUCKET_BITS = 8;
+    constexpr uint64_t DEPTH_IN_BUCKET_BITS = 16;
+
+    constexpr uint64_t getMask(uint64_t numberOfBits) {
+        return (uint64_t{1} << numberOfBits) - 1;
+    }
+
+    /**
+     * The bit pattern of a non-negative float grows with its value, so its upper bits are a sortable depth.
+     */
+    uint64_t quantizeDepth(float depth) {
+        const auto bits = std::bit_cast<uint32_t>(std::max(depth, 0.0F));
+
+        return (bits >> (32 - DEPTH_BITS)) & getMask(DEPTH_BITS);
+    }
+
+    /**
+     * The exponent of a non-negative float, so each bucket covers a power of two range of depths.
+     */
+    uint64_t getDepthBucket(float depth) {
+        const auto bits = std::bit_cast<uint32_t>(std::max(depth, 0.0F));
+
+        return (bits >> 23) & getMask(DEPTH_BUCKET_BITS);
+    }
+
+    /**
+     * The upper bits of the mantissa, which order depths within their bucket.
+     */
+    uint64_t getDepthInBucket(float depth) {
+        const auto bits = std::bit_cast<uint32_t>(std::max(depth, 0.0F));
+
+        return (bits >> (23 - DEPTH_IN_BUCKET_BITS)) & getMask(DEPTH_IN_BUCKET_BITS);
+    }
+
+    uint64_t packState(uint32_t pipelineId, uint32_t geometryId, uint32_t materialId) {
+        return (pipelineId & getMask(PIPELINE_BITS)) << (GEOMETRY_BITS + MATERIAL_BITS) |
+               (geometryId & getMask(GEOMETRY_BITS)) << MATERIAL_BITS |
+               (materialId & getMask(MATERIAL_BITS));
+    }
+
+    float getViewDepth(const glm::mat4 &view, const glm::vec3 &position) {
+        // The camera looks down the negative z axis of view space.
+        return -(view * glm::vec4(position, 1.0F)).z;
+    }
+
+    glm::vec3 getWorldCenter(const pvk::gltf::Object &object,
+                             const pvk::gltf::Node &node,
+                             const pvk::gltf::Primitive &primitive) {
+        if (node.skinIndex > -1 && !object.getSkinBounds(node).isEmpty()) {
+            return object.getSkinBounds(node).getCenter();
+        }
+
+        if (primitive.getBounds().isEmpty()) {
+            return glm::vec3(node.getGlobalMatrix()[3]);
+        }
+
+        return glm::vec3(node.getGlobalMatrix() * glm::vec4(primitive.getBounds().getCenter(), 1.0F));
+    }
+
+    /**
+     * Compares against the bound state and remembers the new value.
+     * @return Whether a bind has to be recorded.
+     */
+    template<typename T>
+    bool exchange(T &bound, T value, pvk::RenderQueue::Statistics &statistics) {
+        if (bound == value) {
+            statistics.numberOfSkippedBinds++;
+            return false;
+        }
+
+        bound = value;
+        statistics.numberOfBinds++;
+
+        return true;
+    }
+}  // namespace
+
+namespace pvk {
+    uint64_t RenderQueue::makeOpaqueKey(uint32_t pipelineId, uint32_t geometryId, uint32_t materialId, float depth) {
+        return (pipelineId & getMask(PIPELINE_BITS)) << (GEOMETRY_BITS + DEPTH_BUCKET_BITS + MATERIAL_BITS +
+                                                         DEPTH_IN_BUCKET_BITS) |
+               (geometryId & getMask(GEOMETRY_BITS)) << (DEPTH_BUCKET_BITS + MATERIAL_BITS + DEPTH_IN_BUCKET_BITS) |
+               getDepthBucket(depth) << (MATERIAL_BITS + DEPTH_IN_BUCKET_BITS) |
+               (materialId & getMask(MATERIAL_BITS)) << DEPTH_IN_BUCKET_BITS |
+               getDepthInBucket(depth);
+    }
+
+    uint64_t RenderQueue::makeTransparentKey(uint32_t pipelineId,
+                                             uint32_t geometryId,
+                                             uint32_t materialId,
+                                             float depth) {
+        const auto invertedDepth = getMask(DEPTH_BITS) - quantizeDepth(depth);
+
+        return uint64_t{1} << 63 |
+               invertedDepth << (PIPELINE_BITS + GEOMETRY_BITS + MATERIAL_BITS) |
+               packState(pipelineId, geometryId, materialId);
+    }
+
+    void RenderQueue::clear() {
+        this->packets.clear();
+        this->pipelineIds.clear();
+        this->geometryIds.clear();
+        this->materialIds.clear();
+    }
+
+    void RenderQueue::submit(const Pipeline &pipeline,
+                             const gltf::Object &object,
+                             const gltf::Node &node,
+                             const gltf::Primitive &primitive,
+                             float depth) {
+        const auto pipelineId = getId(this->pipelineIds, &pipeline);
+        const auto geometryId = getId(this->geometryIds, &object);
+        // Every primitive has its own material descriptor set, the depth bucket keeps them roughly front to back.
+        const auto materialId = getId(this->materialIds, &primitive);
+        const bool isTransparent = primitive.material && primitive.getMaterial().isTransparent;
+
+        this->packets.push_back({
+                isTransparent ? makeTransparentKey(pipelineId, geometryId, materialId, depth)
+                              : makeOpaqueKey(pipelineId, geometryId, materialId, depth),
+                &pipeline,
+                &object,
+                &node,
+                &primitive
+        });
+    }
+
+    void RenderQueue::submit(const Pipeline &pipeline,
+                             const gltf::Object &object,
+                             const gltf::Node &node,
+                             const glm::mat4 &view) {
+        for (const auto &primitive : node.primitives) {
+            const auto center = getWorldCenter(object, node, *primitive);
+            this->submit(pipeline, object, node, *primitive, getViewDepth(view, center));
+        }
+    }
+
+    void RenderQueue::submit(const Pipeline &pipeline,
+                             std::span<const culling::PrimitiveCuller::Draw> draws,
+                             const glm::mat4 &view) {
+        for (const auto &draw : draws) {
+            const auto center = getWorldCenter(*draw.object, *draw.node, *draw.primitive);
+            this->submit(pipeline, *draw.object, *draw.node, *draw.primitive, getViewDepth(view, center));
+        }
+    }
+
+    void RenderQueue::sort() {
+        std::sort(this->packets.begin(), this->packets.end(), [](const Packet &a, const Packet &b) {
+            return a.key < b.key;
+        });
+    }
+
+    void RenderQueue::record(vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex) {
+        this->statistics = {};
+
+        vk::Pipeline boundPipeline;
+        vk::PipelineLayout boundPipelineLayout;
+        vk::Buffer boundVertexBuffer;
+        vk::Buffer boundIndexBuffer;
+        vk::DescriptorSet boundNodeDescriptorSet;
+        vk::DescriptorSet boundPrimitiveDescriptorSet;
+        bool isPullingVertices = false;
+
+        for (const auto &packet : this->packets) {
+            const auto pipelineLayout = packet.pipeline->getPipelineLayout().get();
+            const bool isIndexed = !packet.object->indices.empty();
+
+            if (exchange(boundPipeline, packet.pipeline->getVulkanPipeline().get(), this->statistics)) {
+                commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, boundPipeline);
+            }
+
+            if (pipelineLayout != boundPipelineLayout) {
+                // Sets bound with another layout can not be relied upon.
+                boundPipelineLayout = pipelineLayout;
+                boundNodeDescriptorSet = nullptr;
+                boundPrimitiveDescriptorSet = nullptr;
+
+                // Pulled vertices are bound as a set, and vertex buffers are not bound at all while pulling.
+                if (isPullingVertices || packet.pipeline->isVertexPulling()) {
+                    boundVertexBuffer = nullptr;
+                }
+
+                isPullingVertices = packet.pipeline->isVertexPulling();
+            }
+
+            // Every vertex buffer holds a single vertex layout, so the layout only changes with the buffer.
+            if (exchange(boundVertexBuffer, packet.object->getVertexBuffer(), this->statistics)) {
+                packet.pipeline->bindVertices(commandBuffer, boundVertexBuffer, packet.object->getVertexLayout());
+            }
+
+            if (isIndexed && exchange(boundIndexBuffer, packet.object->getIndexBuffer(), this->statistics)) {
+                commandBuffer.bindIndexBuffer(boundIndexBuffer, 0, vk::IndexType::eUint32);
+            }
+
+            const auto nodeDescriptorSets = packet.node->getDescriptorSetsBySwapChainIndex(swapChainIndex);
+
+            if (!nodeDescriptorSets.empty() &&
+                exchange(boundNodeDescriptorSet, nodeDescriptorSets.front(), this->statistics)) {
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                 pipelineLayout,
+                                                 0,
+                                                 isIndexed ? static_cast<uint32_t>(nodeDescriptorSets.size()) : 1,
+                                                 nodeDescriptorSets.data(),
+                                                 0,
+                                                 nullptr);
+            }
+
+            this->statistics.numberOfDraws++;
+
+            if (!isIndexed) {
+                commandBuffer.draw(packet.primitive->getVertexCount(), 1, packet.primitive->getStartVertex(), 0);
+                continue;
+            }
+
+            const auto primitiveDescriptorSets = packet.primitive->getDescriptorSetsBySwapChainIndex(swapChainIndex);
+
+            if (!primitiveDescriptorSets.empty() &&
+                exchange(boundPrimitiveDescriptorSet, primitiveDescriptorSets.front(), this->statistics)) {
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                 pipelineLayout,
+                                                 1,
+                                                 static_cast<uint32_t>(primitiveDescriptorSets.size()),
+                                                 primitiveDescriptorSets.data(),
+                                                 0,
+                                                 nullptr);
+            }
+
+            commandBuffer.drawIndexed(packet.primitive->getIndexCount(),
+                                      1,
+                                      packet.primitive->getFirstIndex(),
+                                      packet.primitive->getVertexOffset(),
+                                      0);
+        }
+    }
+
+    std::span<const RenderQueue::Packet> RenderQueue::getPackets() const {
+        return this->packets;
+    }
+
+    const RenderQueue::Statistics &RenderQueue::getStatistics() const {
+        return this->statistics;
+    }
+
+    uint32_t RenderQueue::getId(std::unordered_map<const void *, uint32_t> &ids, const void *key) {
+        return ids.try_emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+    }
+}  // namespace pvk
@@ -0,0 +1,107 @@
+//
+//  renderQueue.hpp
+//  PVK
+//
+
+#ifndef PVK_RENDERQUEUE_HPP
+#define PVK_RENDERQUEUE_HPP
+
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "../culling/primitiveCuller.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../pipeline/pipeline.hpp"
+
+namespace pvk {
+    /**
+     * Collects the draws of a frame as packets, sorts them by a 64-bit key and records them while skipping binds
+     * of state which is already bound. Opaque keys sort by pipeline and geometry first, then by a coarse depth
+     * bucket, then by material and front to back last. Every primitive has its own material descriptor set, so
+     * without the bucket the material would decide the order of all draws sharing a pipeline and geometry, and
+     * early depth testing would rarely reject hidden fragments. Transparent keys sort after all opaque keys and
+     * back to front first, which blending requires.
+     *
+     * Key layout, most significant bit first:
+     *   opaque:      0 | pipeline (10) | geometry (10) | depth bucket (8) | material (19) | depth in bucket (16)
+     *   transparent: 1 | inverted depth (24) | pipeline (10) | geometry (10) | material (19)
+     *
+     * A depth bucket covers a power of two range of distances. Pipelines, geometry and materials get ids in
+     * submission order. Ids wider than their field wrap around, which only costs batching, never correctness.
+     */
+    class RenderQueue {
+    public:
+        struct Packet {
+            uint64_t key = 0;
+            const Pipeline *pipeline = nullptr;
+            const gltf::Object *object = nullptr;
+            const gltf::Node *node = nullptr;
+            const gltf::Primitive *primitive = nullptr;
+        };
+
+        struct Statistics {
+            uint32_t numberOfDraws = 0;
+            uint32_t numberOfBinds = 0;
+            uint32_t numberOfSkippedBinds = 0;
+        };
+
+        static uint64_t makeOpaqueKey(uint32_t pipelineId, uint32_t geometryId, uint32_t materialId, float depth);
+
+        static uint64_t makeTransparentKey(uint32_t pipelineId, uint32_t geometryId, uint32_t materialId, float depth);
+
+        /**
+         * Removes all packets, call once per frame before submitting.
+         */
+        void clear();
+
+        /**
+         * Queues a single primitive.
+         * @param depth Distance from the camera along the view direction.
+         */
+        void submit(const Pipeline &pipeline,
+                    const gltf::Object &object,
+                    const gltf::Node &node,
+                    const gltf::Primitive &primitive,
+                    float depth);
+
+        /**
+         * Queues all primitives of a node, their depth is taken from the center of their bounds.
+         */
+        void submit(const Pipeline &pipeline, const gltf::Object &object, const gltf::Node &node, const glm::mat4 &view);
+
+        /**
+         * Queues the visible draws of a culling::PrimitiveCuller.
+         */
+        void submit(const Pipeline &pipeline,
+                    std::span<const culling::PrimitiveCuller::Draw> draws,
+                    const glm::mat4 &view);
+
+        void sort();
+
+        /**
+         * Records the packets in their current order, must be called inside a render pass.
+         */
+        void record(vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex);
+
+        [[nodiscard]] std::span<const Packet> getPackets() const;
+
+        /**
+         * @return Binds issued and skipped during the last record().
+         */
+        [[nodiscard]] const Statistics &getStatistics() const;
+
+    private:
+        std::vector<Packet> packets;
+        Statistics statistics;
+
+        std::unordered_map<const void *, uint32_t> pipelineIds;
+        std::unordered_map<const void *, uint32_t> geometryIds;
+        std::unordered_map<const void *, uint32_t> materialIds;
+
+        static uint32_t getId(std::unordered_map<const void *, uint32_t> &ids, const void *key);
+    };
+}  // namespace pvk
+
+#endif //PVK_RENDERQUEUE_HPP
@@ -10,6 +10,8 @@
 
 #include "context.hpp"
 
+#include <algorithm>
+
 namespace pvk
 {
 static vk::PhysicalDevice physicalDevice = nullptr;
@@ -19,6 +21,8 @@ static vk::UniqueCommandPool commandPool{nullptr};
 static vk::UniquePipelineCache pipelineCache{nullptr};
 static vk::Queue graphicsQueue{nullptr};
 static std::vector<vk::Image> swapChainImages;
+static vk::PhysicalDeviceFeatures enabledFeatures{};
+static std::vector<std::string> enabledExtensions;
 
 void Context::tearDown()
 {
@@ -28,6 +32,7 @@ void Context::tearDown()
     instance.reset();
     graphicsQueue = nullptr;
     physicalDevice = nullptr;
+    enabledExtensions.clear();
 }
 
 void Context::setPhysicalDevice(vk::PhysicalDevice &&_physicalDevice)
@@ -64,6 +69,16 @@ void Context::setSwapChainImages(std::vector<vk::Image> _swapChainImages)
     swapChainImages = std::move(_swapChainImages);
 }
 
+void Context::setEnabledFeatures(const vk::PhysicalDeviceFeatures &_enabledFeatures)
+{
+    enabledFeatures = _enabledFeatures;
+}
+
+void Context::setEnabledExtensions(const std::vector<const char *> &_enabledExtensions)
+{
+    enabledExtensions.assign(_enabledExtensions.begin(), _enabledExtensions.end());
+}
+
 vk::PhysicalDevice Context::getPhysicalDevice()
 {
     return physicalDevice;
@@ -103,6 +118,16 @@ size_t Context::getNumberOfSwapChainImages()
 {
     return swapChainImages.size();
 }
+
+const vk::PhysicalDeviceFeatures &Context::getEnabledFeatures()
+{
+    return enabledFeatures;
+}
+
+bool Context::isExtensionEnabled(const char *extensionName)
+{
+    return std::find(enabledExtensions.begin(), enabledExtensions.end(), extensionName) != enabledExtensions.end();
+}
 } // namespace pvk
 
 #pragma clang diagnostic pop
\ No newline at end of file
@@ -8,6 +8,7 @@
 #ifndef context_hpp
 #define context_hpp
 
+#include <string>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
@@ -29,6 +30,10 @@ namespace pvk {
         static void setGraphicsQueue(vk::Queue &&_queue);
 
         static void setSwapChainImages(std::vector<vk::Image> _swapChainImages);
+
+        static void setEnabledFeatures(const vk::PhysicalDeviceFeatures &_enabledFeatures);
+
+        static void setEnabledExtensions(const std::vector<const char *> &_enabledExtensions);
         
         static vk::PhysicalDevice getPhysicalDevice();
 
@@ -46,6 +51,10 @@ namespace pvk {
 
         static size_t getNumberOfSwapChainImages();
 
+        static const vk::PhysicalDeviceFeatures &getEnabledFeatures();
+
+        static bool isExtensionEnabled(const char *extensionName);
+
     private:
         Context() = default;
     };
@@ -0,0 +1,209 @@
+//
+//  depthPyramid.cpp
+//  PVK
+//
+
+#include "depthPyramid.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "../context/context.hpp"
+#include "../image/image.hpp"
+
+namespace {
+    constexpr uint32_t NUMBER_OF_BINDINGS = 2;
+    constexpr uint32_t BINDING_SOURCE = 0;
+    constexpr uint32_t BINDING_DESTINATION = 1;
+
+    constexpr vk::Format FORMAT = vk::Format::eR32Sfloat;
+
+    vk::ImageSubresourceRange getLevelRange(uint32_t level, uint32_t numberOfLevels) {
+        return {vk::ImageAspectFlagBits::eColor, level, numberOfLevels, 0, 1};
+    }
+}  // namespace
+
+namespace pvk::culling {
+    DepthPyramid::DepthPyramid(const ComputePipeline &newPipeline,
+                               vk::ImageView newDepthImageView,
+                               vk::Extent2D newDepthExtent)
+            : pipeline(newPipeline),
+              depthImageView(newDepthImageView),
+              depthExtent(newDepthExtent),
+              levelExtents(getLevelExtents(newDepthExtent)) {
+        const auto numberOfLevels = this->getNumberOfLevels();
+
+        image::create(this->levelExtents.front().width,
+                      this->levelExtents.front().height,
+                      numberOfLevels,
+                      1,
+                      vk::SampleCountFlagBits::e1,
+                      FORMAT,
+                      vk::ImageTiling::eOptimal,
+                      vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+                      vk::MemoryPropertyFlagBits::eDeviceLocal,
+                      {},
+                      this->image,
+                      this->imageMemory);
+
+        this->imageView = Context::getLogicalDevice().createImageViewUnique(
+                {{}, this->image.get(), vk::ImageViewType::e2D, FORMAT, {}, getLevelRange(0, numberOfLevels)}
+        );
+
+        for (uint32_t i = 0; i < numberOfLevels; i++) {
+            this->levelImageViews.emplace_back(Context::getLogicalDevice().createImageViewUnique(
+                    {{}, this->image.get(), vk::ImageViewType::e2D, FORMAT, {}, getLevelRange(i, 1)}
+            ));
+        }
+
+        // Texels are only fetched, never filtered.
+        vk::SamplerCreateInfo samplerCreateInfo{};
+        samplerCreateInfo.magFilter = vk::Filter::eNearest;
+        samplerCreateInfo.minFilter = vk::Filter::eNearest;
+        samplerCreateInfo.mipmapMode = vk::SamplerMipmapMode::eNearest;
+        samplerCreateInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;
+        samplerCreateInfo.maxLod = static_cast<float>(numberOfLevels);
+        this->sampler = Context::getLogicalDevice().createSamplerUnique(samplerCreateInfo);
+
+        this->createDescriptorSets();
+    }
+
+    void DepthPyramid::createDescriptorSets() {
+        const auto numberOfLevels = this->getNumberOfLevels();
+
+        std::vector<vk::DescriptorPoolSize> poolSizes{
+                {vk::DescriptorType::eCombinedImageSampler, numberOfLevels},
+                {vk::DescriptorType::eStorageImage, numberOfLevels},
+        };
+
+        this->descriptorPool = Context::getLogicalDevice().createDescriptorPoolUnique(
+                {{}, numberOfLevels, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()}
+        );
+
+        std::vector<vk::DescriptorSetLayout> layouts(numberOfLevels, this->pipeline.getDescriptorSetLayout(0));
+        this->descriptorSets = Context::getLogicalDevice().allocateDescriptorSets(
+                {this->descriptorPool.get(), numberOfLevels, layouts.data()}
+        );
+
+        for (uint32_t i = 0; i < numberOfLevels; i++) {
+            // Level 0 reduces the depth attachment, every other level the level below it.
+            const vk::DescriptorImageInfo sourceInfo = i == 0
+                    ? vk::DescriptorImageInfo{this->sampler.get(),
+                                              this->depthImageView,
+                                              vk::ImageLayout::eDepthStencilReadOnlyOptimal}
+                    : vk::DescriptorImageInfo{this->sampler.get(),
+                                              this->levelImageViews[i - 1].get(),
+                                              vk::ImageLayout::eGeneral};
+            const vk::DescriptorImageInfo destinationInfo{
+                    nullptr, this->levelImageViews[i].get(), vk::ImageLayout::eGeneral
+            };
+
+            const std::array<vk::WriteDescriptorSet, NUMBER_OF_BINDINGS> writeDescriptorSets{
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_SOURCE, 0, 1,
+                                           vk::DescriptorType::eCombinedImageSampler, &sourceInfo},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_DESTINATION, 0, 1,
+                                           vk::DescriptorType::eStorageImage, &destinationInfo},
+            };
+
+            Context::getLogicalDevice().updateDescriptorSets(writeDescriptorSets, nullptr);
+        }
+    }
+
+    void DepthPyramid::record(const vk::CommandBuffer &commandBuffer) const {
+        const auto numberOfLevels = this->getNumberOfLevels();
+        const auto pipelineLayout = this->pipeline.getPipelineLayout().get();
+
+        // Every level is rewritten, so the previous contents are discarded once culling of the last frame is done.
+        vk::ImageMemoryBarrier discardBarrier{
+                {},
+                vk::AccessFlagBits::eShaderWrite,
+                vk::ImageLayout::eUndefined,
+                vk::ImageLayout::eGeneral,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                this->image.get(),
+                getLevelRange(0, numberOfLevels)
+        };
+
+        commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eComputeShader,
+                {},
+                nullptr,
+                nullptr,
+                discardBarrier
+        );
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline.getVulkanPipeline().get());
+
+        for (uint32_t i = 0; i < numberOfLevels; i++) {
+            const auto &sourceExtent = i == 0 ? this->depthExtent : this->levelExtents[i - 1];
+            const auto &extent = this->levelExtents[i];
+
+            Reduction reduction;
+            reduction.sourceSize = glm::uvec2(sourceExtent.width, sourceExtent.height);
+            reduction.size = glm::uvec2(extent.width, extent.height);
+
+            commandBuffer.bindDescriptorSets(
+                    vk::PipelineBindPoint::eCompute, pipelineLayout, 0, this->descriptorSets[i], nullptr
+            );
+            commandBuffer.pushConstants(
+                    pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(Reduction), &reduction
+            );
+            commandBuffer.dispatch(ComputePipeline::getNumberOfWorkGroups(extent.width, WORK_GROUP_SIZE),
+                                   ComputePipeline::getNumberOfWorkGroups(extent.height, WORK_GROUP_SIZE),
+                                   1);
+
+            // The next level and culling read this level.
+            vk::ImageMemoryBarrier levelBarrier{
+                    vk::AccessFlagBits::eShaderWrite,
+                    vk::AccessFlagBits::eShaderRead,
+                    vk::ImageLayout::eGeneral,
+                    vk::ImageLayout::eGeneral,
+                    VK_QUEUE_FAMILY_IGNORED,
+                    VK_QUEUE_FAMILY_IGNORED,
+                    this->image.get(),
+                    getLevelRange(i, 1)
+            };
+
+            commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    {},
+                    nullptr,
+                    nullptr,
+                    levelBarrier
+            );
+        }
+    }
+
+    vk::ImageView DepthPyramid::getImageView() const {
+        return this->imageView.get();
+    }
+
+    vk::Sampler DepthPyramid::getSampler() const {
+        return this->sampler.get();
+    }
+
+    vk::Extent2D DepthPyramid::getDepthExtent() const {
+        return this->depthExtent;
+    }
+
+    uint32_t DepthPyramid::getNumberOfLevels() const {
+        return static_cast<uint32_t>(this->levelExtents.size());
+    }
+
+    std::vector<vk::Extent2D> DepthPyramid::getLevelExtents(vk::Extent2D depthExtent) {
+        std::vector<vk::Extent2D> extents;
+        auto extent = depthExtent;
+
+        do {
+            extent = vk::Extent2D{std::max(extent.width / 2, 1U), std::max(extent.height / 2, 1U)};
+            extents.push_back(extent);
+        } while (extent.width > 1 || extent.height > 1);
+
+        return extents;
+    }
+}  // namespace pvk::culling
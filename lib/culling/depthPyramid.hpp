@@ -0,0 +1,83 @@
+//
+//  depthPyramid.hpp
+//  PVK
+//
+
+#ifndef PVK_DEPTHPYRAMID_HPP
+#define PVK_DEPTHPYRAMID_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../pipeline/computePipeline.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::culling {
+    /**
+     * Hierarchical depth of a depth attachment for occlusion culling. Every texel of a level holds the farthest
+     * depth of the texels it covers in the level below, level 0 covers 2x2 pixels of the depth attachment. Levels
+     * halve rounding down, the last texel of a row or column covers the extra texel of an odd sized level, so no
+     * depth is ever skipped. depth_pyramid.comp builds one level per dispatch.
+     */
+    class DepthPyramid : util::NoCopy {
+    public:
+        // Has to match local_size_x and local_size_y in depth_pyramid.comp.
+        static constexpr uint32_t WORK_GROUP_SIZE = 8;
+
+        /**
+         * Push constants of a reduction, has to match the push constant block in depth_pyramid.comp.
+         */
+        struct Reduction {
+            glm::uvec2 sourceSize{0};
+            glm::uvec2 size{0};
+        };
+
+        /**
+         * @param newDepthImageView View of the depth aspect of the attachment, which has to be sampleable.
+         */
+        DepthPyramid(const ComputePipeline &newPipeline, vk::ImageView newDepthImageView, vk::Extent2D newDepthExtent);
+
+        /**
+         * Records the reductions of all levels and the barriers which make them visible to compute shaders. The
+         * depth attachment has to be in eDepthStencilReadOnlyOptimal with its writes visible to compute shaders,
+         * and this has to be recorded outside of a render pass.
+         */
+        void record(const vk::CommandBuffer &commandBuffer) const;
+
+        /**
+         * @return View of all levels in eGeneral layout, read with texelFetch.
+         */
+        [[nodiscard]] vk::ImageView getImageView() const;
+
+        [[nodiscard]] vk::Sampler getSampler() const;
+
+        [[nodiscard]] vk::Extent2D getDepthExtent() const;
+
+        [[nodiscard]] uint32_t getNumberOfLevels() const;
+
+        /**
+         * @return Extents of the levels of a pyramid over a depth attachment of the given extent.
+         */
+        [[nodiscard]] static std::vector<vk::Extent2D> getLevelExtents(vk::Extent2D depthExtent);
+
+    private:
+        void createDescriptorSets();
+
+        const ComputePipeline &pipeline;
+        vk::ImageView depthImageView;
+        vk::Extent2D depthExtent;
+        std::vector<vk::Extent2D> levelExtents;
+
+        vk::UniqueImage image;
+        vk::UniqueDeviceMemory imageMemory;
+        vk::UniqueImageView imageView;
+        std::vector<vk::UniqueImageView> levelImageViews;
+        vk::UniqueSampler sampler;
+
+        vk::UniqueDescriptorPool descriptorPool;
+        std::vector<vk::DescriptorSet> descriptorSets;
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_DEPTHPYRAMID_HPP
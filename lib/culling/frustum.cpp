@@ -0,0 +1,49 @@
+//
+//  frustum.cpp
+//  PVK
+//
+
+#include "frustum.hpp"
+
+namespace {
+    glm::vec4 normalizePlane(const glm::vec4 &plane) {
+        return plane / glm::length(glm::vec3(plane));
+    }
+
+    glm::vec4 getRow(const glm::mat4 &matrix, glm::length_t row) {
+        return {matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]};
+    }
+}  // namespace
+
+namespace pvk::culling {
+    Frustum Frustum::fromMatrix(const glm::mat4 &viewProjection) {
+        const auto x = getRow(viewProjection, 0);
+        const auto y = getRow(viewProjection, 1);
+        const auto z = getRow(viewProjection, 2);
+        const auto w = getRow(viewProjection, 3);
+
+        Frustum frustum;
+        frustum.planes[0] = normalizePlane(w + x);  // Left
+        frustum.planes[1] = normalizePlane(w - x);  // Right
+        frustum.planes[2] = normalizePlane(w + y);  // Bottom
+        frustum.planes[3] = normalizePlane(w - y);  // Top
+        frustum.planes[4] = normalizePlane(z);      // Near, depth range is [0, 1]
+        frustum.planes[5] = normalizePlane(w - z);  // Far
+
+        return frustum;
+    }
+
+    bool Frustum::isSphereVisible(const glm::vec3 &center, float radius) const {
+        for (const auto &plane : this->planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    const std::array<glm::vec4, 6> &Frustum::getPlanes() const {
+        return this->planes;
+    }
+}  // namespace pvk::culling
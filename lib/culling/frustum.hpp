@@ -0,0 +1,37 @@
+//
+//  frustum.hpp
+//  PVK
+//
+
+#ifndef PVK_FRUSTUM_HPP
+#define PVK_FRUSTUM_HPP
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace pvk::culling {
+    /**
+     * View frustum as six normalized planes (xyz = normal pointing inwards, w = distance).
+     */
+    class Frustum {
+    public:
+        Frustum() = default;
+
+        /**
+         * Extracts the planes from a combined projection * view matrix using zero to one depth.
+         */
+        static Frustum fromMatrix(const glm::mat4 &viewProjection);
+
+        [[nodiscard]] bool isSphereVisible(const glm::vec3 &center, float radius) const;
+
+        [[nodiscard]] const std::array<glm::vec4, 6> &getPlanes() const;
+
+    private:
+        std::array<glm::vec4, 6> planes{};
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_FRUSTUM_HPP
@@ -0,0 +1,456 @@
+//
+//  gpuCuller.cpp
+//  PVK
+//
+
+#include "gpuCuller.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "../buffer/buffer.hpp"
+#include "../context/context.hpp"
+
+namespace {
+    constexpr uint32_t NUMBER_OF_BINDINGS = 4;
+    constexpr uint32_t BINDING_DRAW_RECORDS = 0;
+    constexpr uint32_t BINDING_INSTANCES = 1;
+    constexpr uint32_t BINDING_DRAW_COMMANDS = 2;
+    constexpr uint32_t BINDING_DRAW_COUNTS = 3;
+
+    // Additional bindings of occlusion_culling.comp.
+    constexpr uint32_t NUMBER_OF_OCCLUSION_BINDINGS = 3;
+    constexpr uint32_t BINDING_VISIBILITIES = 4;
+    constexpr uint32_t BINDING_OCCLUSION = 5;
+    constexpr uint32_t BINDING_DEPTH_PYRAMID = 6;
+
+    constexpr auto COMMAND_STRIDE = static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand));
+
+    // gpu_culling.comp addresses instances as an array of floats with this stride.
+    static_assert(sizeof(pvk::Instance) == 18 * sizeof(float), "Instance layout does not match gpu_culling.comp");
+    static_assert(sizeof(pvk::culling::GpuCuller::DrawRecord) == 64, "DrawRecord does not match gpu_culling.comp");
+    static_assert(sizeof(pvk::culling::GpuCuller::Occlusion) == 80, "Occlusion does not match occlusion_culling.comp");
+}  // namespace
+
+namespace pvk::culling {
+    GpuCuller::GpuCuller(const ComputePipeline &newPipeline,
+                         const gltf::Object &newObject,
+                         const object::InstanceBatches &newInstanceBatches)
+            : GpuCuller(newPipeline, newObject, newInstanceBatches, nullptr) {
+    }
+
+    GpuCuller::GpuCuller(const ComputePipeline &newPipeline,
+                         const gltf::Object &newObject,
+                         const object::InstanceBatches &newInstanceBatches,
+                         const DepthPyramid &newDepthPyramid)
+            : GpuCuller(newPipeline, newObject, newInstanceBatches, &newDepthPyramid) {
+    }
+
+    GpuCuller::GpuCuller(const ComputePipeline &newPipeline,
+                         const gltf::Object &newObject,
+                         const object::InstanceBatches &newInstanceBatches,
+                         const DepthPyramid *newDepthPyramid)
+            : pipeline(newPipeline),
+              object(newObject),
+              instanceBatches(newInstanceBatches),
+              depthPyramid(newDepthPyramid) {
+        if (this->object.indices.empty()) {
+            throw std::runtime_error("GPU culling can only draw indexed geometry.");
+        }
+
+        if (Context::getEnabledFeatures().drawIndirectFirstInstance == VK_FALSE) {
+            throw std::runtime_error("GPU culling requires drawIndirectFirstInstance.");
+        }
+
+        for (const auto &batch : this->instanceBatches.getBatches()) {
+            for (const auto &primitive : batch.node->primitives) {
+                const auto &bounds = primitive->getBounds();
+                const Group group{batch.node, primitive.get(), this->numberOfCommands, batch.numberOfInstances};
+
+                for (uint32_t i = 0; i < batch.numberOfInstances; i++) {
+                    DrawRecord record;
+                    record.center = glm::vec4(bounds.getCenter(), bounds.isEmpty() ? 1.0F : 0.0F);
+                    record.extent = glm::vec4(bounds.getExtent(), 0.0F);
+                    record.transformIndex = batch.firstInstance + i;
+                    record.groupIndex = static_cast<uint32_t>(this->groups.size());
+                    record.firstCommand = group.firstCommand;
+                    record.firstIndex = primitive->getFirstIndex();
+                    record.indexCount = primitive->getIndexCount();
+                    record.vertexOffset = primitive->getVertexOffset();
+                    this->records.push_back(record);
+                }
+
+                this->groups.push_back(group);
+                this->numberOfCommands += group.numberOfCommands;
+            }
+        }
+
+        if (Context::isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME)) {
+            this->drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                    Context::getLogicalDevice().getProcAddr("vkCmdDrawIndexedIndirectCountKHR")
+            );
+        }
+
+        // Records never change, only the transforms they point at do.
+        buffer::createDeviceLocal(
+                this->records.data(),
+                sizeof(DrawRecord) * std::max<size_t>(this->records.size(), 1),
+                vk::BufferUsageFlagBits::eStorageBuffer,
+                this->recordBuffer,
+                this->recordBufferMemory
+        );
+
+        const auto numberOfSwapChainImages = Context::getNumberOfSwapChainImages();
+        const auto usage = vk::BufferUsageFlagBits::eStorageBuffer |
+                           vk::BufferUsageFlagBits::eIndirectBuffer |
+                           vk::BufferUsageFlagBits::eTransferDst;
+        // Early and late draws of occlusion culling each have their own half.
+        const uint32_t numberOfRanges = this->isOcclusionCulling() ? 2 : 1;
+        this->indirectBufferSize = COMMAND_STRIDE * numberOfRanges * std::max<uint32_t>(this->numberOfCommands, 1);
+        this->countBufferSize = sizeof(uint32_t) * numberOfRanges * std::max<size_t>(this->groups.size(), 1);
+
+        this->indirectBuffers.resize(numberOfSwapChainImages);
+        this->indirectBufferMemories.resize(numberOfSwapChainImages);
+        this->countBuffers.resize(numberOfSwapChainImages);
+        this->countBufferMemories.resize(numberOfSwapChainImages);
+
+        for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+            buffer::create(
+                    this->indirectBufferSize,
+                    usage,
+                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                    this->indirectBuffers[i],
+                    this->indirectBufferMemories[i]
+            );
+            buffer::create(
+                    this->countBufferSize,
+                    usage,
+                    vk::MemoryPropertyFlagBits::eDeviceLocal,
+                    this->countBuffers[i],
+                    this->countBufferMemories[i]
+            );
+        }
+
+        if (this->isOcclusionCulling()) {
+            // Nothing counts as visible in the first frame, so its late phase draws everything which is not occluded.
+            const std::vector<uint32_t> visibilities(std::max<size_t>(this->records.size(), 1), 0);
+
+            buffer::createDeviceLocal(
+                    visibilities.data(),
+                    sizeof(uint32_t) * visibilities.size(),
+                    vk::BufferUsageFlagBits::eStorageBuffer,
+                    this->visibilityBuffer,
+                    this->visibilityBufferMemory
+            );
+
+            this->occlusionBuffers.resize(numberOfSwapChainImages);
+            this->occlusionBufferMemories.resize(numberOfSwapChainImages);
+            this->mappedOcclusions.resize(numberOfSwapChainImages);
+
+            for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+                this->mappedOcclusions[i] = static_cast<Occlusion *>(buffer::createMapped(
+                        sizeof(Occlusion),
+                        vk::BufferUsageFlagBits::eUniformBuffer,
+                        this->occlusionBuffers[i],
+                        this->occlusionBufferMemories[i]
+                ));
+            }
+        }
+
+        this->createDescriptorSets();
+    }
+
+    GpuCuller::~GpuCuller() {
+        for (auto &memory : this->occlusionBufferMemories) {
+            Context::getLogicalDevice().unmapMemory(memory.get());
+        }
+    }
+
+    void GpuCuller::createDescriptorSets() {
+        const auto numberOfSwapChainImages = static_cast<uint32_t>(Context::getNumberOfSwapChainImages());
+
+        std::vector<vk::DescriptorPoolSize> poolSizes{
+                {vk::DescriptorType::eStorageBuffer, (NUMBER_OF_BINDINGS + 1) * numberOfSwapChainImages},
+                {vk::DescriptorType::eUniformBuffer, numberOfSwapChainImages},
+                {vk::DescriptorType::eCombinedImageSampler, numberOfSwapChainImages},
+        };
+
+        this->descriptorPool = Context::getLogicalDevice().createDescriptorPoolUnique(
+                {{}, numberOfSwapChainImages, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()}
+        );
+
+        std::vector<vk::DescriptorSetLayout> layouts(numberOfSwapChainImages, this->pipeline.getDescriptorSetLayout(0));
+        this->descriptorSets = Context::getLogicalDevice().allocateDescriptorSets(
+                {this->descriptorPool.get(), numberOfSwapChainImages, layouts.data()}
+        );
+
+        for (uint32_t i = 0; i < numberOfSwapChainImages; i++) {
+            const std::array<vk::DescriptorBufferInfo, NUMBER_OF_BINDINGS> bufferInfos{
+                    vk::DescriptorBufferInfo{this->recordBuffer.get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->instanceBatches.getInstanceBuffer(i), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->indirectBuffers[i].get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->countBuffers[i].get(), 0, VK_WHOLE_SIZE},
+            };
+
+            const std::array<vk::WriteDescriptorSet, NUMBER_OF_BINDINGS> writeDescriptorSets{
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_DRAW_RECORDS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[0]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_INSTANCES, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[1]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_DRAW_COMMANDS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[2]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_DRAW_COUNTS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[3]},
+            };
+
+            Context::getLogicalDevice().updateDescriptorSets(writeDescriptorSets, nullptr);
+
+            if (!this->isOcclusionCulling()) {
+                continue;
+            }
+
+            const vk::DescriptorBufferInfo visibilityInfo{this->visibilityBuffer.get(), 0, VK_WHOLE_SIZE};
+            const vk::DescriptorBufferInfo occlusionInfo{this->occlusionBuffers[i].get(), 0, VK_WHOLE_SIZE};
+            const vk::DescriptorImageInfo depthPyramidInfo{
+                    this->depthPyramid->getSampler(), this->depthPyramid->getImageView(), vk::ImageLayout::eGeneral
+            };
+
+            const std::array<vk::WriteDescriptorSet, NUMBER_OF_OCCLUSION_BINDINGS> occlusionWriteDescriptorSets{
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_VISIBILITIES, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &visibilityInfo},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_OCCLUSION, 0, 1,
+                                           vk::DescriptorType::eUniformBuffer, nullptr, &occlusionInfo},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_DEPTH_PYRAMID, 0, 1,
+                                           vk::DescriptorType::eCombinedImageSampler, &depthPyramidInfo},
+            };
+
+            Context::getLogicalDevice().updateDescriptorSets(occlusionWriteDescriptorSets, nullptr);
+        }
+    }
+
+    void GpuCuller::recordCulling(const vk::CommandBuffer &commandBuffer,
+                                  const Frustum &frustum,
+                                  uint32_t swapChainIndex) const {
+        this->recordDispatch(
+                commandBuffer, frustum, swapChainIndex, this->isOcclusionCulling() ? Phase::EARLY : Phase::FRUSTUM
+        );
+    }
+
+    void GpuCuller::recordLateCulling(const vk::CommandBuffer &commandBuffer,
+                                      const glm::mat4 &viewProjection,
+                                      uint32_t swapChainIndex) const {
+        if (!this->isOcclusionCulling()) {
+            throw std::runtime_error("The late culling phase requires a depth pyramid.");
+        }
+
+        const auto depthExtent = this->depthPyramid->getDepthExtent();
+        auto &occlusion = *this->mappedOcclusions.at(swapChainIndex);
+        occlusion.viewProjection = viewProjection;
+        occlusion.depthSize = glm::vec2(depthExtent.width, depthExtent.height);
+        occlusion.numberOfLevels = this->depthPyramid->getNumberOfLevels();
+
+        this->recordDispatch(commandBuffer, Frustum::fromMatrix(viewProjection), swapChainIndex, Phase::LATE);
+    }
+
+    void GpuCuller::recordDispatch(const vk::CommandBuffer &commandBuffer,
+                                   const Frustum &frustum,
+                                   uint32_t swapChainIndex,
+                                   Phase phase) const {
+        if (this->records.empty()) {
+            return;
+        }
+
+        const auto indirectBuffer = this->indirectBuffers.at(swapChainIndex).get();
+        const auto countBuffer = this->countBuffers.at(swapChainIndex).get();
+        const auto pipelineLayout = this->pipeline.getPipelineLayout().get();
+
+        if (phase == Phase::LATE) {
+            // The early phase of this frame read the visibilities the late phase overwrites, the commands and
+            // counts were already cleared before it.
+            const vk::MemoryBarrier visibilityBarrier{
+                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+            };
+
+            commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    {},
+                    visibilityBarrier,
+                    nullptr,
+                    nullptr
+            );
+        } else {
+            // The previous frame which used this swap chain image may still be reading the commands.
+            commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eDrawIndirect,
+                    vk::PipelineStageFlagBits::eTransfer,
+                    {},
+                    nullptr,
+                    nullptr,
+                    nullptr
+            );
+
+            commandBuffer.fillBuffer(countBuffer, 0, VK_WHOLE_SIZE, 0);
+
+            if (this->drawIndexedIndirectCount == nullptr) {
+                // Every command of a range is drawn, the ones the shader does not write have to be empty.
+                commandBuffer.fillBuffer(indirectBuffer, 0, VK_WHOLE_SIZE, 0);
+            }
+
+            // Clears and, for the early phase, the visibilities written by the late phase of the previous frame.
+            const vk::MemoryBarrier clearBarrier{
+                    vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eShaderWrite,
+                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+            };
+
+            commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eTransfer | vk::PipelineStageFlagBits::eComputeShader,
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    {},
+                    clearBarrier,
+                    nullptr,
+                    nullptr
+            );
+        }
+
+        Culling culling;
+        culling.planes = frustum.getPlanes();
+        culling.numberOfRecords = static_cast<uint32_t>(this->records.size());
+        culling.phase = static_cast<uint32_t>(phase);
+
+        if (phase == Phase::LATE) {
+            culling.firstCommand = this->numberOfCommands;
+            culling.firstCount = static_cast<uint32_t>(this->groups.size());
+        }
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline.getVulkanPipeline().get());
+        commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eCompute, pipelineLayout, 0, this->descriptorSets.at(swapChainIndex), nullptr
+        );
+        commandBuffer.pushConstants(pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(Culling), &culling);
+        commandBuffer.dispatch(ComputePipeline::getNumberOfWorkGroups(culling.numberOfRecords, WORK_GROUP_SIZE), 1, 1);
+
+        const vk::MemoryBarrier cullBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eIndirectCommandRead};
+
+        commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eDrawIndirect,
+                {},
+                cullBarrier,
+                nullptr,
+                nullptr
+        );
+    }
+
+    void GpuCuller::recordDraws(const vk::CommandBuffer &commandBuffer,
+                                const Pipeline &graphicsPipeline,
+                                uint32_t swapChainIndex) const {
+        this->recordIndirectDraws(commandBuffer, graphicsPipeline, swapChainIndex, 0);
+    }
+
+    void GpuCuller::recordLateDraws(const vk::CommandBuffer &commandBuffer,
+                                    const Pipeline &graphicsPipeline,
+                                    uint32_t swapChainIndex) const {
+        if (!this->isOcclusionCulling()) {
+            throw std::runtime_error("Late draws require a depth pyramid.");
+        }
+
+        this->recordIndirectDraws(commandBuffer, graphicsPipeline, swapChainIndex, 1);
+    }
+
+    void GpuCuller::recordIndirectDraws(const vk::CommandBuffer &commandBuffer,
+                                        const Pipeline &graphicsPipeline,
+                                        uint32_t swapChainIndex,
+                                        uint32_t range) const {
+        if (this->groups.empty()) {
+            return;
+        }
+
+        const auto pipelineLayout = graphicsPipeline.getPipelineLayout().get();
+        const auto indirectBuffer = this->indirectBuffers.at(swapChainIndex).get();
+        const auto countBuffer = this->countBuffers.at(swapChainIndex).get();
+        const bool isMultiDrawSupported = Context::getEnabledFeatures().multiDrawIndirect == VK_TRUE;
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, graphicsPipeline.getVulkanPipeline().get());
+        graphicsPipeline.bindVertices(
+                commandBuffer, this->object.getVertexBuffer(), this->object.getVertexLayout()
+        );
+        commandBuffer.bindVertexBuffers(Instance::BINDING, this->instanceBatches.getInstanceBuffer(swapChainIndex), {0});
+        commandBuffer.bindIndexBuffer(this->object.getIndexBuffer(), 0, vk::IndexType::eUint32);
+
+        const gltf::Node *boundNode = nullptr;
+
+        for (size_t i = 0; i < this->groups.size(); i++) {
+            const auto &group = this->groups[i];
+
+            if (group.node != boundNode) {
+                const auto nodeDescriptorSets = group.node->getDescriptorSetsBySwapChainIndex(swapChainIndex);
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                 pipelineLayout,
+                                                 0,
+                                                 static_cast<uint32_t>(nodeDescriptorSets.size()),
+                                                 nodeDescriptorSets.data(),
+                                                 0,
+                                                 nullptr);
+                boundNode = group.node;
+            }
+
+            const auto primitiveDescriptorSets = group.primitive->getDescriptorSetsBySwapChainIndex(swapChainIndex);
+
+            if (!primitiveDescriptorSets.empty()) {
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                                 pipelineLayout,
+                                                 1,
+                                                 static_cast<uint32_t>(primitiveDescriptorSets.size()),
+                                                 primitiveDescriptorSets.data(),
+                                                 0,
+                                                 nullptr);
+            }
+
+            const vk::DeviceSize offset =
+                    static_cast<vk::DeviceSize>(range * this->numberOfCommands + group.firstCommand) * COMMAND_STRIDE;
+            const vk::DeviceSize countOffset = (range * this->groups.size() + i) * sizeof(uint32_t);
+
+            if (this->drawIndexedIndirectCount != nullptr) {
+                this->drawIndexedIndirectCount(static_cast<VkCommandBuffer>(commandBuffer),
+                                               static_cast<VkBuffer>(indirectBuffer),
+                                               offset,
+                                               static_cast<VkBuffer>(countBuffer),
+                                               countOffset,
+                                               group.numberOfCommands,
+                                               COMMAND_STRIDE);
+            } else if (isMultiDrawSupported) {
+                commandBuffer.drawIndexedIndirect(indirectBuffer, offset, group.numberOfCommands, COMMAND_STRIDE);
+            } else {
+                for (uint32_t j = 0; j < group.numberOfCommands; j++) {
+                    commandBuffer.drawIndexedIndirect(indirectBuffer, offset + j * COMMAND_STRIDE, 1, COMMAND_STRIDE);
+                }
+            }
+        }
+    }
+
+    std::span<const GpuCuller::DrawRecord> GpuCuller::getRecords() const {
+        return this->records;
+    }
+
+    std::span<const GpuCuller::Group> GpuCuller::getGroups() const {
+        return this->groups;
+    }
+
+    vk::DeviceSize GpuCuller::getIndirectBufferSize() const {
+        return this->indirectBufferSize;
+    }
+
+    vk::DeviceSize GpuCuller::getCountBufferSize() const {
+        return this->countBufferSize;
+    }
+
+    bool GpuCuller::isDrawCountSupported() const {
+        return this->drawIndexedIndirectCount != nullptr;
+    }
+
+    bool GpuCuller::isOcclusionCulling() const {
+        return this->depthPyramid != nullptr;
+    }
+}  // namespace pvk::culling
@@ -0,0 +1,227 @@
+//
+//  gpuCuller.hpp
+//  PVK
+//
+
+#ifndef PVK_GPUCULLER_HPP
+#define PVK_GPUCULLER_HPP
+
+#include <array>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "depthPyramid.hpp"
+#include "frustum.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../object/instanceBatches.hpp"
+#include "../pipeline/computePipeline.hpp"
+#include "../pipeline/pipeline.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::culling {
+    /**
+     * GPU driven drawing of the instance batches of an object. Every instance of every primitive is a draw record
+     * in a device local buffer. Once per frame gpu_culling.comp tests the records against the view frustum and
+     * appends an indexed indirect draw command for every visible record to the range of its primitive, counting
+     * the draws per primitive. The CPU only records one indirect draw per primitive, independent of the number
+     * of instances and of what is visible.
+     *
+     * With VK_KHR_draw_indirect_count the GPU count is used directly. Without it, commands are cleared to empty
+     * draws every frame and the whole range of every primitive is drawn.
+     *
+     * The transform of a record is the instance it was created for, so it is drawn with firstInstance set to
+     * that instance and a pipeline created from pbr_instanced.json. Bounds are tested in the space of the node
+     * world matrices, the frustum has to be built without the model matrix of the object.
+     *
+     * Created with a DepthPyramid, records are culled in two phases with occlusion_culling.comp and a visibility
+     * flag per record which persists across frames. The early phase draws the records which were visible last
+     * frame and are still in the frustum. After the depth pyramid has been built from that depth, the late phase
+     * tests all records in the frustum against the pyramid, remembers the result and draws the records which
+     * became visible. Early and late draws have their own half of the indirect and count buffers.
+     */
+    class GpuCuller : util::NoCopy {
+    public:
+        // Has to match local_size_x in gpu_culling.comp.
+        static constexpr uint32_t WORK_GROUP_SIZE = 64;
+
+        /**
+         * Draw record of a single instance of a primitive, has to match DrawRecord in gpu_culling.comp.
+         */
+        struct DrawRecord {
+            // Local bounds of the primitive, center.w is 1 for records which are never culled.
+            glm::vec4 center{0.0F};
+            glm::vec4 extent{0.0F};
+            uint32_t transformIndex = 0;
+            uint32_t groupIndex = 0;
+            uint32_t firstCommand = 0;
+            uint32_t firstIndex = 0;
+            uint32_t indexCount = 0;
+            int32_t vertexOffset = 0;
+            std::array<uint32_t, 2> padding{};
+        };
+
+        /**
+         * Push constants of the culling dispatch, has to match the push constant block in gpu_culling.comp.
+         */
+        struct Culling {
+            std::array<glm::vec4, 6> planes{};
+            uint32_t numberOfRecords = 0;
+            uint32_t phase = 0;
+            // Start of the half of the indirect and count buffers the late phase appends to, 0 otherwise.
+            uint32_t firstCommand = 0;
+            uint32_t firstCount = 0;
+        };
+
+        /**
+         * Value of Culling::phase, has to match the phases in occlusion_culling.comp.
+         */
+        enum class Phase : uint32_t {
+            FRUSTUM, EARLY, LATE
+        };
+
+        /**
+         * Parameters of the late phase, has to match the Occlusion uniform block in occlusion_culling.comp.
+         */
+        struct Occlusion {
+            glm::mat4 viewProjection{1.0F};
+            glm::vec2 depthSize{0.0F};
+            uint32_t numberOfLevels = 0;
+            uint32_t padding = 0;
+        };
+
+        /**
+         * Records of a primitive of a batch, their commands occupy a contiguous range of the indirect buffer.
+         */
+        struct Group {
+            const gltf::Node *node = nullptr;
+            const gltf::Primitive *primitive = nullptr;
+            uint32_t firstCommand = 0;
+            uint32_t numberOfCommands = 0;
+        };
+
+        GpuCuller(const ComputePipeline &newPipeline,
+                  const gltf::Object &newObject,
+                  const object::InstanceBatches &newInstanceBatches);
+
+        /**
+         * Culls against the depth pyramid as well, the pipeline has to be created from occlusion_culling.json.
+         */
+        GpuCuller(const ComputePipeline &newPipeline,
+                  const gltf::Object &newObject,
+                  const object::InstanceBatches &newInstanceBatches,
+                  const DepthPyramid &newDepthPyramid);
+
+        ~GpuCuller();
+
+        /**
+         * Records the culling dispatch and the barrier which makes its commands visible to indirect draws. Has to
+         * be recorded outside of a render pass, after the instance batches of the image have been updated. With
+         * occlusion culling this is the early phase.
+         */
+        void recordCulling(const vk::CommandBuffer &commandBuffer,
+                           const Frustum &frustum,
+                           uint32_t swapChainIndex) const;
+
+        /**
+         * Records the late phase of occlusion culling, after the early draws have been rendered and the depth
+         * pyramid has been built from their depth. Has to be recorded outside of a render pass.
+         * @param viewProjection Matrix the frame is rendered with, without the model matrix of the object.
+         */
+        void recordLateCulling(const vk::CommandBuffer &commandBuffer,
+                               const glm::mat4 &viewProjection,
+                               uint32_t swapChainIndex) const;
+
+        /**
+         * Records one indirect draw per group, must be called inside a render pass. With occlusion culling these
+         * are the draws of the early phase.
+         */
+        void recordDraws(const vk::CommandBuffer &commandBuffer,
+                         const Pipeline &graphicsPipeline,
+                         uint32_t swapChainIndex) const;
+
+        /**
+         * Records the draws of the late phase, must be called inside a render pass.
+         */
+        void recordLateDraws(const vk::CommandBuffer &commandBuffer,
+                             const Pipeline &graphicsPipeline,
+                             uint32_t swapChainIndex) const;
+
+        [[nodiscard]] std::span<const DrawRecord> getRecords() const;
+
+        [[nodiscard]] std::span<const Group> getGroups() const;
+
+        /**
+         * @return Size of the indirect buffer of a swap chain image, including the late half with occlusion culling.
+         */
+        [[nodiscard]] vk::DeviceSize getIndirectBufferSize() const;
+
+        /**
+         * @return Size of the count buffer of a swap chain image, including the late half with occlusion culling.
+         */
+        [[nodiscard]] vk::DeviceSize getCountBufferSize() const;
+
+        [[nodiscard]] bool isDrawCountSupported() const;
+
+        [[nodiscard]] bool isOcclusionCulling() const;
+
+    private:
+        GpuCuller(const ComputePipeline &newPipeline,
+                  const gltf::Object &newObject,
+                  const object::InstanceBatches &newInstanceBatches,
+                  const DepthPyramid *newDepthPyramid);
+
+        void createDescriptorSets();
+
+        void recordDispatch(const vk::CommandBuffer &commandBuffer,
+                            const Frustum &frustum,
+                            uint32_t swapChainIndex,
+                            Phase phase) const;
+
+        /**
+         * @param range 0 for the early or only draws, 1 for the late draws.
+         */
+        void recordIndirectDraws(const vk::CommandBuffer &commandBuffer,
+                                 const Pipeline &graphicsPipeline,
+                                 uint32_t swapChainIndex,
+                                 uint32_t range) const;
+
+        const ComputePipeline &pipeline;
+        const gltf::Object &object;
+        const object::InstanceBatches &instanceBatches;
+
+        // Null without occlusion culling.
+        const DepthPyramid *depthPyramid = nullptr;
+
+        std::vector<DrawRecord> records;
+        std::vector<Group> groups;
+        uint32_t numberOfCommands = 0;
+
+        // Null without VK_KHR_draw_indirect_count.
+        PFN_vkCmdDrawIndexedIndirectCountKHR drawIndexedIndirectCount = nullptr;
+
+        vk::UniqueBuffer recordBuffer;
+        vk::UniqueDeviceMemory recordBufferMemory;
+
+        vk::DeviceSize indirectBufferSize = 0;
+        vk::DeviceSize countBufferSize = 0;
+        std::vector<vk::UniqueBuffer> indirectBuffers;
+        std::vector<vk::UniqueDeviceMemory> indirectBufferMemories;
+        std::vector<vk::UniqueBuffer> countBuffers;
+        std::vector<vk::UniqueDeviceMemory> countBufferMemories;
+
+        // One flag per record, set when the record passed the late phase of the last frame.
+        vk::UniqueBuffer visibilityBuffer;
+        vk::UniqueDeviceMemory visibilityBufferMemory;
+
+        std::vector<vk::UniqueBuffer> occlusionBuffers;
+        std::vector<vk::UniqueDeviceMemory> occlusionBufferMemories;
+        std::vector<Occlusion *> mappedOcclusions;
+
+        vk::UniqueDescriptorPool descriptorPool;
+        std::vector<vk::DescriptorSet> descriptorSets;
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_GPUCULLER_HPP
@@ -0,0 +1,228 @@
+//
+//  meshletCuller.cpp
+//  PVK
+//
+
+#include "meshletCuller.hpp"
+
+#include <numeric>
+
+#include "../buffer/buffer.hpp"
+#include "../context/context.hpp"
+#include "../util/threadPool.hpp"
+
+namespace {
+    constexpr size_t BATCHES_PER_TASK = 4;
+
+    float getMaximumScale(const glm::mat4 &matrix) {
+        const auto scaleX = glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0]));
+        const auto scaleY = glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1]));
+        const auto scaleZ = glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]));
+
+        return std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+    }
+
+    bool isBackFacing(const pvk::gltf::Meshlet &meshlet,
+                      const glm::vec3 &center,
+                      const glm::vec3 &coneAxis,
+                      float radius,
+                      const glm::vec3 &cameraPosition) {
+        if (meshlet.coneCutoff >= 1.0F) {
+            return false;
+        }
+
+        const auto direction = center - cameraPosition;
+
+        return glm::dot(direction, coneAxis) >= meshlet.coneCutoff * glm::length(direction) + radius;
+    }
+
+    /**
+     * Draws a range of the indices of a primitive, the start index is relative to the indices of the object.
+     */
+    vk::DrawIndexedIndirectCommand makeCommand(const pvk::gltf::Primitive &primitive,
+                                               uint32_t startIndex,
+                                               uint32_t indexCount) {
+        const auto firstIndex = primitive.getFirstIndex() - primitive.getStartIndex() + startIndex;
+
+        return {indexCount, 1, firstIndex, primitive.getVertexOffset(), 0};
+    }
+}  // namespace
+
+namespace pvk::culling {
+    MeshletCuller::MeshletCuller(const gltf::Object &object) {
+        for (const auto &[nodeIndex, node] : object.getNodes()) {
+            const auto firstBatch = this->batches.size();
+
+            for (const auto &primitive : node->primitives) {
+                const auto numberOfPrimitiveMeshlets = static_cast<uint32_t>(primitive->getMeshlets().size());
+
+                if (numberOfPrimitiveMeshlets == 0) {
+                    continue;
+                }
+
+                this->batches.push_back({node.get(), primitive.get(), this->numberOfCommands, numberOfPrimitiveMeshlets});
+                this->numberOfCommands += numberOfPrimitiveMeshlets;
+            }
+
+            if (this->batches.size() > firstBatch) {
+                this->batchRangeByNode[nodeIndex] = {firstBatch, this->batches.size() - firstBatch};
+            }
+        }
+
+        this->numberOfMeshlets = this->numberOfCommands;
+        this->visibleMeshletsPerThread.resize(util::ThreadPool::getInstance().getNumberOfThreads());
+
+        if (this->numberOfCommands == 0) {
+            return;
+        }
+
+        const auto numberOfSwapChainImages = Context::getNumberOfSwapChainImages();
+        const auto bufferSize = sizeof(vk::DrawIndexedIndirectCommand) * this->numberOfCommands;
+
+        this->indirectBuffers.resize(numberOfSwapChainImages);
+        this->indirectBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedCommands.resize(numberOfSwapChainImages);
+
+        for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+            buffer::create(
+                    bufferSize,
+                    vk::BufferUsageFlagBits::eIndirectBuffer,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                    this->indirectBuffers[i],
+                    this->indirectBufferMemories[i]
+            );
+
+            this->mappedCommands[i] = static_cast<vk::DrawIndexedIndirectCommand *>(
+                    Context::getLogicalDevice().mapMemory(this->indirectBufferMemories[i].get(), 0, bufferSize)
+            );
+
+            // Draw everything until the first cull for this swap chain image has run.
+            for (const auto &batch : this->batches) {
+                for (uint32_t j = 0; j < batch.numberOfCommands; j++) {
+                    const auto &meshlet = batch.primitive->getMeshlets()[j];
+                    this->mappedCommands[i][batch.firstCommand + j] = makeCommand(
+                            *batch.primitive, meshlet.startIndex, meshlet.indexCount
+                    );
+                }
+            }
+        }
+    }
+
+    MeshletCuller::~MeshletCuller() {
+        for (auto &memory : this->indirectBufferMemories) {
+            Context::getLogicalDevice().unmapMemory(memory.get());
+        }
+    }
+
+    void MeshletCuller::cull(const Frustum &frustum, const glm::vec3 &cameraPosition, uint32_t swapChainIndex) {
+        if (this->numberOfCommands == 0) {
+            return;
+        }
+
+        auto *commands = this->mappedCommands.at(swapChainIndex);
+        std::fill(this->visibleMeshletsPerThread.begin(), this->visibleMeshletsPerThread.end(), 0);
+
+        util::ThreadPool::getInstance().parallelFor(
+                this->batches.size(),
+                BATCHES_PER_TASK,
+                [&](size_t begin, size_t end, uint32_t threadIndex) {
+                    for (auto i = begin; i < end; i++) {
+                        this->visibleMeshletsPerThread[threadIndex] +=
+                                this->cullBatch(this->batches[i], frustum, cameraPosition, commands);
+                    }
+                }
+        );
+
+        this->numberOfVisibleMeshlets = std::accumulate(
+                this->visibleMeshletsPerThread.begin(), this->visibleMeshletsPerThread.end(), 0U
+        );
+    }
+
+    uint32_t MeshletCuller::cullBatch(const Batch &batch,
+                                      const Frustum &frustum,
+                                      const glm::vec3 &cameraPosition,
+                                      vk::DrawIndexedIndirectCommand *commands) const {
+        const auto &meshlets = batch.primitive->getMeshlets();
+        auto *batchCommands = commands + batch.firstCommand;
+        uint32_t numberOfWrittenCommands = 0;
+        uint32_t numberOfVisibleMeshletsInBatch = 0;
+
+        if (batch.node->skinIndex > -1) {
+            // Meshlet bounds are in bind pose, skinned primitives are drawn as a whole.
+            batchCommands[numberOfWrittenCommands++] = makeCommand(
+                    *batch.primitive, batch.primitive->getStartIndex(), batch.primitive->getIndexCount()
+            );
+            numberOfVisibleMeshletsInBatch = batch.numberOfCommands;
+        } else {
+            const auto worldMatrix = batch.node->getGlobalMatrix();
+            const auto normalMatrix = glm::mat3(worldMatrix);
+            const auto maximumScale = getMaximumScale(worldMatrix);
+
+            for (const auto &meshlet : meshlets) {
+                const auto center = glm::vec3(worldMatrix * glm::vec4(meshlet.center, 1.0F));
+                const auto radius = meshlet.radius * maximumScale;
+
+                if (!frustum.isSphereVisible(center, radius)) {
+                    continue;
+                }
+
+                if (isBackFacing(meshlet, center, glm::normalize(normalMatrix * meshlet.coneAxis), radius,
+                                 cameraPosition)) {
+                    continue;
+                }
+
+                numberOfVisibleMeshletsInBatch++;
+
+                const auto command = makeCommand(*batch.primitive, meshlet.startIndex, meshlet.indexCount);
+
+                if (numberOfWrittenCommands > 0) {
+                    auto &previous = batchCommands[numberOfWrittenCommands - 1];
+
+                    if (previous.firstIndex + previous.indexCount == command.firstIndex) {
+                        // Adjacent in the index buffer, extend the previous draw instead of adding one.
+                        previous.indexCount += meshlet.indexCount;
+                        continue;
+                    }
+                }
+
+                batchCommands[numberOfWrittenCommands++] = command;
+            }
+        }
+
+        for (auto i = numberOfWrittenCommands; i < batch.numberOfCommands; i++) {
+            batchCommands[i] = vk::DrawIndexedIndirectCommand(0, 0, 0, 0, 0);
+        }
+
+        return numberOfVisibleMeshletsInBatch;
+    }
+
+    vk::Buffer MeshletCuller::getIndirectBuffer(uint32_t swapChainIndex) const {
+        return this->indirectBuffers.at(swapChainIndex).get();
+    }
+
+    std::span<const vk::DrawIndexedIndirectCommand> MeshletCuller::getCommands(uint32_t swapChainIndex) const {
+        if (this->numberOfCommands == 0) {
+            return {};
+        }
+
+        return {this->mappedCommands.at(swapChainIndex), this->numberOfCommands};
+    }
+
+    std::span<const MeshletCuller::Batch> MeshletCuller::getBatchesByNode(uint32_t nodeIndex) const {
+        const auto it = this->batchRangeByNode.find(nodeIndex);
+
+        if (it == this->batchRangeByNode.end()) {
+            return {};
+        }
+
+        return {this->batches.data() + it->second.first, it->second.second};
+    }
+
+    uint32_t MeshletCuller::getNumberOfMeshlets() const {
+        return this->numberOfMeshlets;
+    }
+
+    uint32_t MeshletCuller::getNumberOfVisibleMeshlets() const {
+        return this->numberOfVisibleMeshlets;
+    }
+}  // namespace pvk::culling
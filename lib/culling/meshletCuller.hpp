@@ -0,0 +1,83 @@
+//
+//  meshletCuller.hpp
+//  PVK
+//
+
+#ifndef PVK_MESHLETCULLER_HPP
+#define PVK_MESHLETCULLER_HPP
+
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include "frustum.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::culling {
+    /**
+     * Culls the meshlets of an object against the view frustum and their normal cones on the CPU, spread over the
+     * thread pool. The surviving meshlets are written as indexed indirect draw commands into a persistently mapped
+     * buffer per swap chain image, so recorded command buffers stay valid while the visible set changes.
+     */
+    class MeshletCuller : util::NoCopy {
+    public:
+        /**
+         * Range of indirect commands reserved for one primitive of a node. Visible commands are compacted at the
+         * start of the range, the remaining commands draw nothing.
+         */
+        struct Batch {
+            const gltf::Node *node = nullptr;
+            const gltf::Primitive *primitive = nullptr;
+            uint32_t firstCommand = 0;
+            uint32_t numberOfCommands = 0;
+        };
+
+        explicit MeshletCuller(const gltf::Object &object);
+
+        ~MeshletCuller();
+
+        MeshletCuller(MeshletCuller &&other) = delete;
+
+        MeshletCuller &operator=(MeshletCuller &&other) = delete;
+
+        /**
+         * Writes the draw commands of all visible meshlets into the indirect buffer of the given swap chain image.
+         * Must be called after the node transforms of the frame have been updated.
+         */
+        void cull(const Frustum &frustum, const glm::vec3 &cameraPosition, uint32_t swapChainIndex);
+
+        [[nodiscard]] vk::Buffer getIndirectBuffer(uint32_t swapChainIndex) const;
+
+        /**
+         * @return Draw commands of a swap chain image as written by the last cull(), indexed like the batches.
+         */
+        [[nodiscard]] std::span<const vk::DrawIndexedIndirectCommand> getCommands(uint32_t swapChainIndex) const;
+
+        [[nodiscard]] std::span<const Batch> getBatchesByNode(uint32_t nodeIndex) const;
+
+        [[nodiscard]] uint32_t getNumberOfMeshlets() const;
+
+        [[nodiscard]] uint32_t getNumberOfVisibleMeshlets() const;
+
+    private:
+        uint32_t cullBatch(const Batch &batch,
+                           const Frustum &frustum,
+                           const glm::vec3 &cameraPosition,
+                           vk::DrawIndexedIndirectCommand *commands) const;
+
+        std::vector<Batch> batches;
+        boost::container::flat_map<uint32_t, std::pair<size_t, size_t>> batchRangeByNode;
+        uint32_t numberOfCommands = 0;
+        uint32_t numberOfMeshlets = 0;
+        uint32_t numberOfVisibleMeshlets = 0;
+
+        std::vector<vk::UniqueBuffer> indirectBuffers;
+        std::vector<vk::UniqueDeviceMemory> indirectBufferMemories;
+        std::vector<vk::DrawIndexedIndirectCommand *> mappedCommands;
+        std::vector<uint32_t> visibleMeshletsPerThread;
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_MESHLETCULLER_HPP
@@ -0,0 +1,147 @@
+//
+//  primitiveCuller.cpp
+//  PVK
+//
+
+#include "primitiveCuller.hpp"
+
+#include <algorithm>
+
+#include "../util/threadPool.hpp"
+
+namespace {
+    constexpr size_t BLOCKS_PER_TASK = 64;
+
+    size_t roundUpToLanes(size_t count) {
+        constexpr auto lanes = pvk::culling::PrimitiveCuller::LANES;
+
+        return (count + lanes - 1) / lanes * lanes;
+    }
+
+    /**
+     * Bounds relative to the node, covering all EXT_mesh_gpu_instancing instances of the node.
+     */
+    pvk::gltf::BoundingBox getLocalBounds(const pvk::gltf::Node &node, const pvk::gltf::Primitive &primitive) {
+        if (node.instanceMatrices.empty() || primitive.getBounds().isEmpty()) {
+            return primitive.getBounds();
+        }
+
+        pvk::gltf::BoundingBox bounds;
+
+        for (const auto &instanceMatrix : node.instanceMatrices) {
+            bounds.extend(primitive.getBounds().transform(instanceMatrix));
+        }
+
+        return bounds;
+    }
+}  // namespace
+
+namespace pvk::culling {
+    void PrimitiveCuller::addObject(const gltf::Object &object) {
+        for (const auto &[nodeIndex, node] : object.getNodes()) {
+            for (const auto &primitive : node->primitives) {
+                // Skinned vertices do not follow the node, so its world matrix says nothing about them.
+                const auto *skinBounds = node->skinIndex > -1 ? &object.getSkinBounds(*node) : nullptr;
+                const auto localBounds = skinBounds != nullptr ? *skinBounds : getLocalBounds(*node, *primitive);
+
+                this->draws.push_back({&object, node.get(), primitive.get()});
+                this->skinBounds.push_back(skinBounds);
+                this->localBounds.push_back(localBounds);
+                this->isAlwaysVisible.push_back(localBounds.isEmpty());
+            }
+        }
+
+        const auto paddedSize = roundUpToLanes(this->draws.size());
+
+        for (auto *values : {&this->centerX, &this->centerY, &this->centerZ,
+                             &this->extentX, &this->extentY, &this->extentZ}) {
+            values->resize(paddedSize, 0.0F);
+        }
+
+        this->visibilityMasks.resize(paddedSize / LANES);
+        this->visibleDraws.reserve(this->draws.size());
+    }
+
+    void PrimitiveCuller::cull(const Frustum &frustum) {
+        util::ThreadPool::getInstance().parallelFor(
+                this->visibilityMasks.size(),
+                BLOCKS_PER_TASK,
+                [&](size_t begin, size_t end, uint32_t) {
+                    for (auto block = begin; block < end; block++) {
+                        const auto firstIndex = block * LANES;
+                        const auto lastIndex = std::min(firstIndex + LANES, this->draws.size());
+
+                        for (auto i = firstIndex; i < lastIndex; i++) {
+                            if (this->isAlwaysVisible[i] == 0) {
+                                this->updateWorldBounds(i);
+                            }
+                        }
+
+                        this->visibilityMasks[block] = this->cullLanes(firstIndex, frustum);
+                    }
+                }
+        );
+
+        this->visibleDraws.clear();
+
+        for (size_t i = 0; i < this->draws.size(); i++) {
+            const auto isInside = (this->visibilityMasks[i / LANES] >> (i % LANES)) & 1U;
+
+            if (isInside != 0 || this->isAlwaysVisible[i] != 0) {
+                this->visibleDraws.push_back(this->draws[i]);
+            }
+        }
+    }
+
+    std::span<const PrimitiveCuller::Draw> PrimitiveCuller::getVisibleDraws() const {
+        return this->visibleDraws;
+    }
+
+    size_t PrimitiveCuller::getNumberOfDraws() const {
+        return this->draws.size();
+    }
+
+    void PrimitiveCuller::updateWorldBounds(size_t index) {
+        const auto &draw = this->draws[index];
+        const auto bounds = this->skinBounds[index] != nullptr
+                            ? *this->skinBounds[index]
+                            : this->localBounds[index].transform(draw.node->getGlobalMatrix());
+        const auto center = bounds.getCenter();
+        const auto extent = bounds.getExtent();
+
+        this->centerX[index] = center.x;
+        this->centerY[index] = center.y;
+        this->centerZ[index] = center.z;
+        this->extentX[index] = extent.x;
+        this->extentY[index] = extent.y;
+        this->extentZ[index] = extent.z;
+    }
+
+    uint32_t PrimitiveCuller::cullLanes(size_t firstIndex, const Frustum &frustum) const {
+        uint32_t mask = (1U << LANES) - 1;
+
+        for (const auto &plane : frustum.getPlanes()) {
+            const auto absoluteNormal = glm::abs(glm::vec3(plane));
+            uint32_t planeMask = 0;
+
+            // Distance of the box corner furthest along the plane normal, the box is outside when it is negative.
+            for (size_t lane = 0; lane < LANES; lane++) {
+                const auto i = firstIndex + lane;
+                const auto distance = plane.x * this->centerX[i] + plane.y * this->centerY[i] +
+                                      plane.z * this->centerZ[i] + plane.w +
+                                      absoluteNormal.x * this->extentX[i] + absoluteNormal.y * this->extentY[i] +
+                                      absoluteNormal.z * this->extentZ[i];
+
+                planeMask |= static_cast<uint32_t>(distance >= 0.0F) << lane;
+            }
+
+            mask &= planeMask;
+
+            if (mask == 0) {
+                break;
+            }
+        }
+
+        return mask;
+    }
+}  // namespace pvk::culling
@@ -0,0 +1,82 @@
+//
+//  primitiveCuller.hpp
+//  PVK
+//
+
+#ifndef PVK_PRIMITIVECULLER_HPP
+#define PVK_PRIMITIVECULLER_HPP
+
+#include <span>
+#include <vector>
+
+#include "frustum.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::culling {
+    /**
+     * Culls whole primitives against the view frustum on the CPU and keeps the visible ones as a draw list, which
+     * is recorded after culling. World bounds are derived from the local bounds of the primitives and the cached
+     * world matrices of their nodes; nodes with EXT_mesh_gpu_instancing are bounded by all of their instances.
+     * Skinned primitives use the bounds of their skin in the current pose instead, which the skin keeps up to date
+     * with its joint palette. Bounds are stored as structure of arrays and tested LANES boxes at a time, so the
+     * plane tests compile to vector instructions.
+     */
+    class PrimitiveCuller : util::NoCopy {
+    public:
+        static constexpr size_t LANES = 8;
+
+        struct Draw {
+            const gltf::Object *object = nullptr;
+            const gltf::Node *node = nullptr;
+            const gltf::Primitive *primitive = nullptr;
+        };
+
+        /**
+         * Adds all primitives of an object, the object has to outlive the culler.
+         */
+        void addObject(const gltf::Object &object);
+
+        /**
+         * Rebuilds the visible draw list, must be called after the node transforms of the frame have been updated.
+         */
+        void cull(const Frustum &frustum);
+
+        /**
+         * @return Visible draws in the order they were added, draws of the same node are adjacent.
+         */
+        [[nodiscard]] std::span<const Draw> getVisibleDraws() const;
+
+        [[nodiscard]] size_t getNumberOfDraws() const;
+
+    private:
+        void updateWorldBounds(size_t index);
+
+        [[nodiscard]] uint32_t cullLanes(size_t firstIndex, const Frustum &frustum) const;
+
+        std::vector<Draw> draws;
+        std::vector<Draw> visibleDraws;
+
+        // Primitives without bounds are never culled.
+        std::vector<uint8_t> isAlwaysVisible;
+
+        // Bounds of the skin for skinned primitives, already in object space, otherwise null.
+        std::vector<const gltf::BoundingBox *> skinBounds;
+
+        // Bounds relative to the node, including the instances of EXT_mesh_gpu_instancing.
+        std::vector<gltf::BoundingBox> localBounds;
+
+        // World space bounds as center and half extent, padded to a multiple of LANES.
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+
+        // One bit per lane, set when the box is inside or intersecting the frustum.
+        std::vector<uint32_t> visibilityMasks;
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_PRIMITIVECULLER_HPP
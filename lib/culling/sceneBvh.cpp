@@ -0,0 +1,568 @@
+//
+//  sceneBvh.cpp
+//  PVK
+//
+
+#include "sceneBvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+
+namespace {
+    constexpr size_t PRIMITIVES_PER_TASK = 256;
+    constexpr uint32_t MIN_PRIMITIVES_PER_SUBTREE = 256;
+    constexpr uint32_t SUBTREES_PER_THREAD = 4;
+
+    // Cost of visiting a node relative to testing the bounds of one primitive.
+    constexpr float TRAVERSAL_COST = 1.0F;
+
+    struct Bin {
+        pvk::gltf::BoundingBox bounds;
+        uint32_t count = 0;
+    };
+
+    /**
+     * Bounds relative to the node, covering all EXT_mesh_gpu_instancing instances of the node.
+     */
+    pvk::gltf::BoundingBox getLocalBounds(const pvk::gltf::Node &node, const pvk::gltf::Primitive &primitive) {
+        if (node.instanceMatrices.empty() || primitive.getBounds().isEmpty()) {
+            return primitive.getBounds();
+        }
+
+        pvk::gltf::BoundingBox bounds;
+
+        for (const auto &instanceMatrix : node.instanceMatrices) {
+            bounds.extend(primitive.getBounds().transform(instanceMatrix));
+        }
+
+        return bounds;
+    }
+
+    float getSurfaceArea(const pvk::gltf::BoundingBox &bounds) {
+        if (bounds.isEmpty()) {
+            return 0.0F;
+        }
+
+        const auto size = bounds.maximum - bounds.minimum;
+
+        return 2.0F * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    uint32_t getBin(float centroid, float minimum, float scale) {
+        constexpr auto lastBin = pvk::culling::SceneBvh::BINS - 1;
+
+        return std::min(lastBin, static_cast<uint32_t>((centroid - minimum) * scale));
+    }
+
+    enum class Containment {
+        OUTSIDE,
+        INTERSECTING,
+        INSIDE,
+    };
+
+    Containment getContainment(const pvk::culling::Frustum &frustum, const pvk::gltf::BoundingBox &bounds) {
+        const auto center = bounds.getCenter();
+        const auto extent = bounds.getExtent();
+        auto containment = Containment::INSIDE;
+
+        for (const auto &plane : frustum.getPlanes()) {
+            const auto distance = glm::dot(glm::vec3(plane), center) + plane.w;
+            const auto radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+
+            if (distance + radius < 0.0F) {
+                return Containment::OUTSIDE;
+            }
+
+            if (distance - radius < 0.0F) {
+                containment = Containment::INTERSECTING;
+            }
+        }
+
+        return containment;
+    }
+
+    bool isSphereIntersecting(const pvk::gltf::BoundingBox &bounds, const glm::vec3 &center, float radius) {
+        const auto offset = glm::clamp(center, bounds.minimum, bounds.maximum) - center;
+
+        return glm::dot(offset, offset) <= radius * radius;
+    }
+
+    /**
+     * @return Distance at which the ray enters the bounds, negative when it misses them.
+     */
+    float intersectRay(const pvk::gltf::BoundingBox &bounds,
+                       const pvk::culling::SceneBvh::Ray &ray,
+                       const glm::vec3 &inverseDirection) {
+        auto entry = 0.0F;
+        auto exit = ray.maximumDistance;
+
+        for (glm::length_t axis = 0; axis < 3; axis++) {
+            // A ray parallel to the slab never enters or leaves it. Its distance to the planes is infinite, which
+            // is not computed, since an origin on a plane would multiply zero by infinity.
+            if (std::isinf(inverseDirection[axis])) {
+                if (ray.origin[axis] < bounds.minimum[axis] || ray.origin[axis] > bounds.maximum[axis]) {
+                    return -1.0F;
+                }
+
+                continue;
+            }
+
+            const auto nearPlane = (bounds.minimum[axis] - ray.origin[axis]) * inverseDirection[axis];
+            const auto farPlane = (bounds.maximum[axis] - ray.origin[axis]) * inverseDirection[axis];
+            entry = std::max(entry, std::min(nearPlane, farPlane));
+            exit = std::min(exit, std::max(nearPlane, farPlane));
+        }
+
+        return entry <= exit ? entry : -1.0F;
+    }
+}  // namespace
+
+namespace pvk::culling {
+    SceneBvh::SceneBvh(util::ThreadPool &newThreadPool) : threadPool(newThreadPool) {
+    }
+
+    void SceneBvh::addObject(const gltf::Object &object) {
+        this->objects.push_back(&object);
+
+        for (const auto &[nodeIndex, node] : object.getNodes()) {
+            const PrimitiveRange range{static_cast<PrimitiveHandle>(this->primitives.size()),
+                                       static_cast<uint32_t>(node->primitives.size())};
+
+            for (const auto &primitive : node->primitives) {
+                // Skinned vertices do not follow the node, so its world matrix says nothing about them.
+                const auto *skin = node->skinIndex > -1 ? &object.getSkinBounds(*node) : nullptr;
+
+                this->primitives.push_back({&object, node.get(), primitive.get()});
+                this->skinBounds.push_back(skin);
+                this->localBounds.push_back(skin != nullptr ? *skin : getLocalBounds(*node, *primitive));
+            }
+
+            this->nodePrimitives[node.get()] = range;
+        }
+
+        this->worldBounds.resize(this->primitives.size());
+    }
+
+    void SceneBvh::build() {
+        this->threadPool.parallelFor(
+                this->primitives.size(),
+                PRIMITIVES_PER_TASK,
+                [this](size_t begin, size_t end, uint32_t) {
+                    for (auto i = begin; i < end; i++) {
+                        this->updateWorldBounds(static_cast<PrimitiveHandle>(i));
+                    }
+                }
+        );
+
+        this->primitiveOrder.clear();
+        this->unboundedPrimitives.clear();
+        this->nodes.clear();
+
+        for (PrimitiveHandle handle = 0; handle < this->primitives.size(); handle++) {
+            if (this->worldBounds[handle].isEmpty()) {
+                this->unboundedPrimitives.push_back(handle);
+            } else {
+                this->primitiveOrder.push_back(handle);
+            }
+        }
+
+        this->leaves.assign(this->primitives.size(), NO_NODE);
+
+        if (this->primitiveOrder.empty()) {
+            this->parents.clear();
+            this->isNodeStale.clear();
+            return;
+        }
+
+        // Splits the upper levels here, the subtrees below them cover disjoint ranges and are built in parallel.
+        const auto numberOfPrimitives = static_cast<uint32_t>(this->primitiveOrder.size());
+        const auto subtreeSize = std::max(
+                MIN_PRIMITIVES_PER_SUBTREE,
+                numberOfPrimitives / (this->threadPool.getNumberOfThreads() * SUBTREES_PER_THREAD)
+        );
+
+        this->nodes.push_back(this->createNode(0, numberOfPrimitives));
+
+        std::vector<uint32_t> subtreeRoots;
+        std::vector<uint32_t> stack{0};
+
+        while (!stack.empty()) {
+            const auto index = stack.back();
+            stack.pop_back();
+
+            if (this->nodes[index].numberOfPrimitives <= subtreeSize) {
+                subtreeRoots.push_back(index);
+            } else if (this->splitNode(this->nodes, index)) {
+                stack.push_back(this->nodes[index].leftChild);
+                stack.push_back(this->nodes[index].leftChild + 1);
+            }
+        }
+
+        std::vector<std::vector<Node>> subtrees(subtreeRoots.size());
+
+        this->threadPool.parallelFor(
+                subtreeRoots.size(),
+                1,
+                [&](size_t begin, size_t end, uint32_t) {
+                    for (auto i = begin; i < end; i++) {
+                        auto &subtree = subtrees[i];
+                        subtree.push_back(this->nodes[subtreeRoots[i]]);
+
+                        std::vector<uint32_t> subtreeStack{0};
+
+                        while (!subtreeStack.empty()) {
+                            const auto index = subtreeStack.back();
+                            subtreeStack.pop_back();
+
+                            if (this->splitNode(subtree, index)) {
+                                subtreeStack.push_back(subtree[index].leftChild);
+                                subtreeStack.push_back(subtree[index].leftChild + 1);
+                            }
+                        }
+                    }
+                }
+        );
+
+        // Appends every subtree behind the upper levels, its root replaces the node it was built from.
+        for (size_t i = 0; i < subtrees.size(); i++) {
+            const auto offset = static_cast<uint32_t>(this->nodes.size()) - 1;
+
+            for (auto &node : subtrees[i]) {
+                if (node.leftChild != 0) {
+                    node.leftChild += offset;
+                }
+            }
+
+            this->nodes[subtreeRoots[i]] = subtrees[i].front();
+            this->nodes.insert(this->nodes.end(), subtrees[i].begin() + 1, subtrees[i].end());
+        }
+
+        this->parents.assign(this->nodes.size(), NO_NODE);
+        this->isNodeStale.assign(this->nodes.size(), 0);
+
+        for (uint32_t index = 0; index < this->nodes.size(); index++) {
+            const auto &node = this->nodes[index];
+
+            if (node.leftChild != 0) {
+                this->parents[node.leftChild] = index;
+                this->parents[node.leftChild + 1] = index;
+                continue;
+            }
+
+            for (auto i = node.firstPrimitive; i < node.firstPrimitive + node.numberOfPrimitives; i++) {
+                this->leaves[this->primitiveOrder[i]] = index;
+            }
+        }
+    }
+
+    void SceneBvh::refit() {
+        for (const auto *object : this->objects) {
+            for (const auto *node : object->getChangedNodes()) {
+                const auto range = this->nodePrimitives.find(node);
+
+                if (range == this->nodePrimitives.end()) {
+                    continue;
+                }
+
+                const auto [firstHandle, count] = range->second;
+
+                for (auto handle = firstHandle; handle < firstHandle + count; handle++) {
+                    // Primitives added or without bounds at the last build() are not in the tree.
+                    if (handle < this->leaves.size() && this->leaves[handle] != NO_NODE) {
+                        this->updateWorldBounds(handle);
+                        this->markStale(this->leaves[handle]);
+                    }
+                }
+            }
+        }
+
+        // Children always come after their parent, so refitting in reverse order visits them first.
+        std::sort(this->staleNodes.begin(), this->staleNodes.end(), std::greater<>());
+
+        for (const auto index : this->staleNodes) {
+            auto &node = this->nodes[index];
+            node.bounds = {};
+
+            if (node.leftChild != 0) {
+                node.bounds.extend(this->nodes[node.leftChild].bounds);
+                node.bounds.extend(this->nodes[node.leftChild + 1].bounds);
+            } else {
+                for (auto i = node.firstPrimitive; i < node.firstPrimitive + node.numberOfPrimitives; i++) {
+                    node.bounds.extend(this->worldBounds[this->primitiveOrder[i]]);
+                }
+            }
+
+            this->isNodeStale[index] = 0;
+        }
+
+        this->staleNodes.clear();
+    }
+
+    void SceneBvh::queryFrustum(const Frustum &frustum, std::vector<PrimitiveHandle> &handles) const {
+        handles = this->unboundedPrimitives;
+
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        std::vector<uint32_t> stack{0};
+
+        while (!stack.empty()) {
+            const auto &node = this->nodes[stack.back()];
+            stack.pop_back();
+
+            const auto containment = getContainment(frustum, node.bounds);
+
+            if (containment == Containment::OUTSIDE) {
+                continue;
+            }
+
+            // The whole subtree is visible, its primitives are contiguous.
+            if (containment == Containment::INSIDE) {
+                const auto first = this->primitiveOrder.begin() + node.firstPrimitive;
+                handles.insert(handles.end(), first, first + node.numberOfPrimitives);
+                continue;
+            }
+
+            if (node.leftChild != 0) {
+                stack.push_back(node.leftChild);
+                stack.push_back(node.leftChild + 1);
+                continue;
+            }
+
+            for (auto i = node.firstPrimitive; i < node.firstPrimitive + node.numberOfPrimitives; i++) {
+                const auto handle = this->primitiveOrder[i];
+
+                if (getContainment(frustum, this->worldBounds[handle]) != Containment::OUTSIDE) {
+                    handles.push_back(handle);
+                }
+            }
+        }
+    }
+
+    void SceneBvh::querySphere(const glm::vec3 &center, float radius, std::vector<PrimitiveHandle> &handles) const {
+        handles = this->unboundedPrimitives;
+
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        std::vector<uint32_t> stack{0};
+
+        while (!stack.empty()) {
+            const auto &node = this->nodes[stack.back()];
+            stack.pop_back();
+
+            if (!isSphereIntersecting(node.bounds, center, radius)) {
+                continue;
+            }
+
+            if (node.leftChild != 0) {
+                stack.push_back(node.leftChild);
+                stack.push_back(node.leftChild + 1);
+                continue;
+            }
+
+            for (auto i = node.firstPrimitive; i < node.firstPrimitive + node.numberOfPrimitives; i++) {
+                const auto handle = this->primitiveOrder[i];
+
+                if (isSphereIntersecting(this->worldBounds[handle], center, radius)) {
+                    handles.push_back(handle);
+                }
+            }
+        }
+    }
+
+    void SceneBvh::queryRay(const Ray &ray, std::vector<RayHit> &hits) const {
+        hits.clear();
+
+        if (this->nodes.empty()) {
+            return;
+        }
+
+        // Axes the ray is parallel to divide to infinity, intersectRay() only tests the origin against their slabs.
+        const auto inverseDirection = 1.0F / ray.direction;
+        std::vector<uint32_t> stack{0};
+
+        while (!stack.empty()) {
+            const auto &node = this->nodes[stack.back()];
+            stack.pop_back();
+
+            if (intersectRay(node.bounds, ray, inverseDirection) < 0.0F) {
+                continue;
+            }
+
+            if (node.leftChild != 0) {
+                stack.push_back(node.leftChild);
+                stack.push_back(node.leftChild + 1);
+                continue;
+            }
+
+            for (auto i = node.firstPrimitive; i < node.firstPrimitive + node.numberOfPrimitives; i++) {
+                const auto handle = this->primitiveOrder[i];
+                const auto distance = intersectRay(this->worldBounds[handle], ray, inverseDirection);
+
+                if (distance >= 0.0F) {
+                    hits.push_back({handle, distance});
+                }
+            }
+        }
+
+        std::sort(hits.begin(), hits.end(), [](const RayHit &a, const RayHit &b) {
+            return a.distance < b.distance;
+        });
+    }
+
+    const SceneBvh::Primitive &SceneBvh::getPrimitive(PrimitiveHandle handle) const {
+        return this->primitives.at(handle);
+    }
+
+    const gltf::BoundingBox &SceneBvh::getWorldBounds(PrimitiveHandle handle) const {
+        return this->worldBounds.at(handle);
+    }
+
+    size_t SceneBvh::getNumberOfPrimitives() const {
+        return this->primitives.size();
+    }
+
+    size_t SceneBvh::getNumberOfNodes() const {
+        return this->nodes.size();
+    }
+
+    void SceneBvh::updateWorldBounds(PrimitiveHandle handle) {
+        if (this->localBounds[handle].isEmpty()) {
+            this->worldBounds[handle] = {};
+        } else if (this->skinBounds[handle] != nullptr) {
+            this->worldBounds[handle] = *this->skinBounds[handle];
+        } else {
+            this->worldBounds[handle] = this->localBounds[handle].transform(
+                    this->primitives[handle].node->getGlobalMatrix()
+            );
+        }
+    }
+
+    SceneBvh::Node SceneBvh::createNode(uint32_t firstPrimitive, uint32_t numberOfPrimitives) const {
+        Node node;
+        node.firstPrimitive = firstPrimitive;
+        node.numberOfPrimitives = numberOfPrimitives;
+
+        for (auto i = firstPrimitive; i < firstPrimitive + numberOfPrimitives; i++) {
+            node.bounds.extend(this->worldBounds[this->primitiveOrder[i]]);
+        }
+
+        return node;
+    }
+
+    bool SceneBvh::splitNode(std::vector<Node> &treeNodes, uint32_t index) {
+        const auto node = treeNodes[index];
+        const auto numberOfLeftPrimitives = this->partition(node);
+
+        if (numberOfLeftPrimitives == 0) {
+            return false;
+        }
+
+        treeNodes[index].leftChild = static_cast<uint32_t>(treeNodes.size());
+        treeNodes.push_back(this->createNode(node.firstPrimitive, numberOfLeftPrimitives));
+        treeNodes.push_back(this->createNode(node.firstPrimitive + numberOfLeftPrimitives,
+                                             node.numberOfPrimitives - numberOfLeftPrimitives));
+
+        return true;
+    }
+
+    uint32_t SceneBvh::partition(const Node &node) {
+        if (node.numberOfPrimitives <= 1) {
+            return 0;
+        }
+
+        const auto first = this->primitiveOrder.begin() + node.firstPrimitive;
+        const auto last = first + node.numberOfPrimitives;
+
+        gltf::BoundingBox centroidBounds;
+
+        for (auto it = first; it != last; it++) {
+            centroidBounds.extend(this->worldBounds[*it].getCenter());
+        }
+
+        const auto centroidSize = centroidBounds.maximum - centroidBounds.minimum;
+        auto bestCost = std::numeric_limits<float>::max();
+        glm::length_t bestAxis = 0;
+        uint32_t bestBin = 0;
+
+        for (glm::length_t axis = 0; axis < 3; axis++) {
+            if (centroidSize[axis] <= 0.0F) {
+                continue;
+            }
+
+            const auto minimum = centroidBounds.minimum[axis];
+            const auto scale = static_cast<float>(BINS) / centroidSize[axis];
+            std::array<Bin, BINS> bins{};
+
+            for (auto it = first; it != last; it++) {
+                auto &bin = bins[getBin(this->worldBounds[*it].getCenter()[axis], minimum, scale)];
+                bin.bounds.extend(this->worldBounds[*it]);
+                bin.count++;
+            }
+
+            // Cost of everything right of each split, the left side is accumulated while sweeping back.
+            std::array<Bin, BINS - 1> rightSides{};
+            Bin right;
+
+            for (auto i = BINS - 1; i > 0; i--) {
+                right.bounds.extend(bins[i].bounds);
+                right.count += bins[i].count;
+                rightSides[i - 1] = right;
+            }
+
+            Bin left;
+
+            for (uint32_t i = 0; i < BINS - 1; i++) {
+                left.bounds.extend(bins[i].bounds);
+                left.count += bins[i].count;
+
+                if (left.count == 0 || rightSides[i].count == 0) {
+                    continue;
+                }
+
+                const auto cost = getSurfaceArea(left.bounds) * static_cast<float>(left.count) +
+                                  getSurfaceArea(rightSides[i].bounds) * static_cast<float>(rightSides[i].count);
+
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = i;
+                }
+            }
+        }
+
+        const auto area = getSurfaceArea(node.bounds);
+        const auto isSplitCheaper =
+                TRAVERSAL_COST * area + bestCost < area * static_cast<float>(node.numberOfPrimitives);
+
+        if (node.numberOfPrimitives <= MAX_LEAF_SIZE && !isSplitCheaper) {
+            return 0;
+        }
+
+        // All centroids coincide, any split is as good as the other.
+        if (bestCost == std::numeric_limits<float>::max()) {
+            return node.numberOfPrimitives / 2;
+        }
+
+        const auto minimum = centroidBounds.minimum[bestAxis];
+        const auto scale = static_cast<float>(BINS) / centroidSize[bestAxis];
+        const auto middle = std::partition(first, last, [&](PrimitiveHandle handle) {
+            return getBin(this->worldBounds[handle].getCenter()[bestAxis], minimum, scale) <= bestBin;
+        });
+
+        return static_cast<uint32_t>(middle - first);
+    }
+
+    void SceneBvh::markStale(uint32_t index) {
+        while (index != NO_NODE && this->isNodeStale[index] == 0) {
+            this->isNodeStale[index] = 1;
+            this->staleNodes.push_back(index);
+            index = this->parents[index];
+        }
+    }
+}  // namespace pvk::culling
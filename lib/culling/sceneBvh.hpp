@@ -0,0 +1,166 @@
+//
+//  sceneBvh.hpp
+//  PVK
+//
+
+#ifndef PVK_SCENEBVH_HPP
+#define PVK_SCENEBVH_HPP
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "frustum.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../util/threadPool.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::culling {
+    /**
+     * Bounding volume hierarchy over the world bounds of all primitives of a scene, so frustum, sphere and ray
+     * queries visit O(log n) nodes instead of every primitive. World bounds are derived the same way as in
+     * PrimitiveCuller.
+     *
+     * build() splits nodes with the surface area heuristic, evaluated over BINS bins per axis. The upper levels are
+     * split on the calling thread until the remaining subtrees are small enough to be built in parallel on the
+     * thread pool. refit() only recomputes the bounds of the primitives whose node changed during the last
+     * Object::updateTransforms() and of the tree nodes above them. The topology is kept, so queries slow down when
+     * primitives move far from where they were at the last build().
+     */
+    class SceneBvh : util::NoCopy {
+    public:
+        static constexpr uint32_t BINS = 16;
+        static constexpr uint32_t MAX_LEAF_SIZE = 4;
+
+        using PrimitiveHandle = uint32_t;
+
+        struct Primitive {
+            const gltf::Object *object = nullptr;
+            const gltf::Node *node = nullptr;
+            const gltf::Primitive *primitive = nullptr;
+        };
+
+        struct Ray {
+            glm::vec3 origin{0.0F};
+            glm::vec3 direction{0.0F, 0.0F, -1.0F};
+            float maximumDistance = std::numeric_limits<float>::max();
+        };
+
+        struct RayHit {
+            PrimitiveHandle handle = 0;
+            // Distance along the direction at which the ray enters the bounds, zero when it starts inside them.
+            float distance = 0.0F;
+        };
+
+        /**
+         * @param newThreadPool Pool the world bounds and the subtrees are built on by build().
+         */
+        explicit SceneBvh(util::ThreadPool &newThreadPool = util::ThreadPool::getInstance());
+
+        /**
+         * Adds all primitives of an object, the object has to outlive the hierarchy. Takes effect with the next
+         * build().
+         */
+        void addObject(const gltf::Object &object);
+
+        /**
+         * Rebuilds the hierarchy from the current world bounds of all primitives.
+         */
+        void build();
+
+        /**
+         * Updates the bounds of primitives whose node changed, must be called after the node transforms of the
+         * frame have been updated.
+         */
+        void refit();
+
+        /**
+         * Replaces the contents of handles with the primitives whose bounds are inside or intersecting the frustum.
+         * Primitives without bounds are always included.
+         */
+        void queryFrustum(const Frustum &frustum, std::vector<PrimitiveHandle> &handles) const;
+
+        /**
+         * Replaces the contents of handles with the primitives whose bounds intersect the sphere. Primitives
+         * without bounds are always included.
+         */
+        void querySphere(const glm::vec3 &center, float radius, std::vector<PrimitiveHandle> &handles) const;
+
+        /**
+         * Replaces the contents of hits with the primitives whose bounds the ray hits, nearest first, so picking
+         * can test the geometry in order and stop at the first hit. Primitives without bounds are never hit.
+         */
+        void queryRay(const Ray &ray, std::vector<RayHit> &hits) const;
+
+        [[nodiscard]] const Primitive &getPrimitive(PrimitiveHandle handle) const;
+
+        /**
+         * @return World bounds of a primitive as of the last build() or refit().
+         */
+        [[nodiscard]] const gltf::BoundingBox &getWorldBounds(PrimitiveHandle handle) const;
+
+        [[nodiscard]] size_t getNumberOfPrimitives() const;
+
+        [[nodiscard]] size_t getNumberOfNodes() const;
+
+    private:
+        static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max();
+
+        struct Node {
+            gltf::BoundingBox bounds;
+            // Range of primitiveOrder covered by the subtree of this node.
+            uint32_t firstPrimitive = 0;
+            uint32_t numberOfPrimitives = 0;
+            // Index of the left child, the right child follows it. Zero for leaves, since the root is no child.
+            uint32_t leftChild = 0;
+        };
+
+        struct PrimitiveRange {
+            PrimitiveHandle first = 0;
+            uint32_t count = 0;
+        };
+
+        void updateWorldBounds(PrimitiveHandle handle);
+
+        [[nodiscard]] Node createNode(uint32_t firstPrimitive, uint32_t numberOfPrimitives) const;
+
+        /**
+         * Splits a node into two children appended to treeNodes, or leaves it a leaf.
+         * @return Whether the node was split.
+         */
+        bool splitNode(std::vector<Node> &treeNodes, uint32_t index);
+
+        /**
+         * @return Number of primitives of the range moved to the left child, zero when the range stays a leaf.
+         */
+        uint32_t partition(const Node &node);
+
+        void markStale(uint32_t index);
+
+        util::ThreadPool &threadPool;
+
+        std::vector<Primitive> primitives;
+        std::vector<const gltf::Object *> objects;
+        std::unordered_map<const gltf::Node *, PrimitiveRange> nodePrimitives;
+
+        // Bounds of the skin for skinned primitives, already in object space, otherwise null.
+        std::vector<const gltf::BoundingBox *> skinBounds;
+        // Bounds relative to the node, including the instances of EXT_mesh_gpu_instancing.
+        std::vector<gltf::BoundingBox> localBounds;
+        std::vector<gltf::BoundingBox> worldBounds;
+        std::vector<PrimitiveHandle> unboundedPrimitives;
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> parents;
+        // Primitives with bounds, ordered so every node covers a contiguous range.
+        std::vector<PrimitiveHandle> primitiveOrder;
+        // Leaf of every primitive, NO_NODE for primitives which are not in the tree.
+        std::vector<uint32_t> leaves;
+
+        std::vector<uint8_t> isNodeStale;
+        std::vector<uint32_t> staleNodes;
+    };
+}  // namespace pvk::culling
+
+#endif //PVK_SCENEBVH_HPP
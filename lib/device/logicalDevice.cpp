@@ -7,12 +7,50 @@
 
 #include "logicalDevice.hpp"
 
+#include <algorithm>
+#include <cstring>
+
 namespace pvk::device::logical {
+    auto getEnabledFeatures(const vk::PhysicalDevice &physicalDevice) -> vk::PhysicalDeviceFeatures {
+        const auto supportedFeatures = physicalDevice.getFeatures();
+        auto enabledFeatures = vk::PhysicalDeviceFeatures();
+
+        // Used to submit all visible meshlets of a primitive with a single indirect draw.
+        enabledFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        enabledFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+        return enabledFeatures;
+    }
+
+    auto getEnabledExtensions(const vk::PhysicalDevice &physicalDevice,
+                              const std::vector<const char *> &requiredExtensions) -> std::vector<const char *> {
+        // Lets the GPU decide how many of the indirect draws written by a culling pass are executed.
+        const std::vector<const char *> optionalExtensions{VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
+
+        const auto supportedExtensions = physicalDevice.enumerateDeviceExtensionProperties();
+        auto enabledExtensions = requiredExtensions;
+
+        for (const auto *extension : optionalExtensions) {
+            const auto isSupported = std::any_of(
+                    supportedExtensions.begin(), supportedExtensions.end(), [&](const auto &properties) {
+                        return std::strcmp(properties.extensionName, extension) == 0;
+                    }
+            );
+
+            if (isSupported) {
+                enabledExtensions.push_back(extension);
+            }
+        }
+
+        return enabledExtensions;
+    }
+
     auto create(const vk::PhysicalDevice &physicalDevice,
                 const QueueFamilyIndices &indices,
                 const std::vector<const char *> &deviceExtensions,
                 const std::vector<const char *> &validationLayers,
-                const bool enableValidationLayers) -> vk::UniqueDevice {
+                const bool enableValidationLayers,
+                const vk::PhysicalDeviceFeatures &enabledFeatures) -> vk::UniqueDevice {
         std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
 
@@ -28,13 +66,12 @@ namespace pvk::device::logical {
             );
         }
 
-        auto deviceFeatures = vk::PhysicalDeviceFeatures();
         auto createInfo = vk::DeviceCreateInfo(
                 vk::DeviceCreateFlags(),
                 static_cast<uint32_t>(queueCreateInfos.size()),
                 queueCreateInfos.data()
         );
-        createInfo.pEnabledFeatures = &deviceFeatures;
+        createInfo.pEnabledFeatures = &enabledFeatures;
         createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
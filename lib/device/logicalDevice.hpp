@@ -14,11 +14,24 @@
 #include "physicalDevice.hpp"
 
 namespace pvk::device::logical {
+    /**
+     * Selects the optional device features the engine makes use of, limited to those supported by the device.
+     */
+    auto getEnabledFeatures(const vk::PhysicalDevice &physicalDevice) -> vk::PhysicalDeviceFeatures;
+
+    /**
+     * @return The required extensions followed by the optional extensions the engine makes use of, limited to
+     * those supported by the device.
+     */
+    auto getEnabledExtensions(const vk::PhysicalDevice &physicalDevice,
+                              const std::vector<const char *> &requiredExtensions) -> std::vector<const char *>;
+
     auto create(const vk::PhysicalDevice &physicalDevice,
                 const QueueFamilyIndices &indices,
                 const std::vector<const char *> &deviceExtensions,
                 const std::vector<const char *> &validationLayers,
-                bool enableValidationLayers) -> vk::UniqueDevice;
+                bool enableValidationLayers,
+                const vk::PhysicalDeviceFeatures &enabledFeatures) -> vk::UniqueDevice;
 }
 
 #endif /* logicalDevice_hpp */
@@ -6,3 +6,368 @@
 //
 
 #include "GLTFAnimation.hpp"
+#include "GLTFAnimationCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Number of keyframes the cursor may step forward before falling back to a binary search.
+    constexpr size_t MAXIMUM_CURSOR_STEPS = 4;
+
+    size_t searchKeyframe(const std::vector<float> &inputs, float time) {
+        const auto it = std::upper_bound(inputs.begin(), inputs.end(), time);
+
+        if (it == inputs.begin()) {
+            return 0;
+        }
+
+        return std::min(static_cast<size_t>(std::distance(inputs.begin(), it) - 1), inputs.size() - 2);
+    }
+
+    glm::vec4 evaluateHermite(const pvk::gltf::CubicSegment &segment, float t) {
+        const auto t2 = t * t;
+        const auto t3 = t2 * t;
+
+        return (2.0F * t3 - 3.0F * t2 + 1.0F) * segment.value +
+               (t3 - 2.0F * t2 + t) * segment.outTangent +
+               (-2.0F * t3 + 3.0F * t2) * segment.nextValue +
+               (t3 - t2) * segment.inTangent;
+    }
+}  // namespace
+
+namespace pvk::gltf {
+    void Animation::prepare() {
+        std::stable_sort(this->channels.begin(), this->channels.end(), [](const Channel &a, const Channel &b) {
+            return a.pathType < b.pathType;
+        });
+
+        for (size_t pathType = 0; pathType <= NUMBER_OF_PATH_TYPES; pathType++) {
+            const auto it = std::find_if(this->channels.begin(), this->channels.end(), [pathType](const auto &c) {
+                return static_cast<size_t>(c.pathType) >= pathType;
+            });
+            this->pathOffsets[pathType] = static_cast<size_t>(std::distance(this->channels.begin(), it));
+        }
+
+        const auto numberOfValues = this->channels.size() * 4;
+        this->sourceValues.assign(numberOfValues, 0.0F);
+        this->targetValues.assign(numberOfValues, 0.0F);
+        this->resultValues.assign(numberOfValues, 0.0F);
+        this->factors.assign(this->channels.size(), 0.0F);
+        this->scratch.assign(this->channels.size(), 0.0F);
+        this->cursors.assign(this->channels.size(), 0);
+    }
+
+    void Pose::copyFrom(const Hierarchy &hierarchy) {
+        const auto numberOfNodes = hierarchy.size();
+        this->translations.resize(numberOfNodes);
+        this->rotations.resize(numberOfNodes);
+        this->scales.resize(numberOfNodes);
+
+        for (uint32_t i = 0; i < numberOfNodes; i++) {
+            this->translations[i] = hierarchy.getTranslation(i);
+            this->rotations[i] = hierarchy.getRotation(i);
+            this->scales[i] = hierarchy.getScale(i);
+        }
+
+        this->morphWeights.resize(hierarchy.getNumberOfMorphWeights());
+
+        for (uint32_t i = 0; i < numberOfNodes; i++) {
+            const auto weights = hierarchy.getMorphWeights(i);
+            std::copy(weights.begin(), weights.end(), this->morphWeights.begin() + hierarchy.getMorphWeightOffset(i));
+        }
+    }
+
+    template<typename Fn>
+    void Animation::evaluate(Fn &&write) {
+        for (size_t pathType = 0; pathType < NUMBER_OF_PATH_TYPES; pathType++) {
+            const auto first = this->pathOffsets[pathType];
+            const auto last = this->pathOffsets[pathType + 1];
+            const auto n = last - first;
+
+            if (n == 0) {
+                continue;
+            }
+
+            const bool isRotation = pathType == Channel::ROTATION;
+            const uint32_t numberOfComponents = isRotation ? 4 : 3;
+
+            this->gatherKeyframes(first, last, numberOfComponents);
+
+            if (isRotation) {
+                this->interpolateNormalizedLinear(n);
+            } else {
+                this->interpolateLinear(n, numberOfComponents);
+            }
+
+            const auto *x = this->resultValues.data();
+            const auto *y = x + n;
+            const auto *z = y + n;
+            const auto *w = z + n;
+
+            for (size_t k = 0; k < n; k++) {
+                write(pathType, this->channels[first + k].node, x[k], y[k], z[k], isRotation ? w[k] : 0.0F);
+            }
+        }
+    }
+
+    template<typename Fn>
+    void Animation::evaluateMorphWeights(Fn &&write) {
+        for (auto channelIndex = this->pathOffsets[NUMBER_OF_PATH_TYPES];
+             channelIndex < this->channels.size();
+             channelIndex++) {
+            const auto &channel = this->channels[channelIndex];
+            const auto &sampler = this->samplers[channel.samplerIndex];
+            const auto numberOfTargets = sampler.numberOfComponents;
+
+            const auto i = this->findKeyframe(channelIndex);
+            const auto next = std::min(i + 1, sampler.inputs.size() - 1);
+            const auto duration = sampler.inputs[next] - sampler.inputs[i];
+
+            auto factor = duration > 0.0F
+                          ? std::clamp((this->currentTime - sampler.inputs[i]) / duration, 0.0F, 1.0F)
+                          : 0.0F;
+
+            if (sampler.interpolationType == Sampler::CUBICSPLINE) {
+                // Every keyframe holds the in-tangents, values and out-tangents of all targets.
+                const auto *source = &sampler.outputs[i * 3 * numberOfTargets];
+                const auto *target = &sampler.outputs[next * 3 * numberOfTargets];
+
+                for (uint32_t k = 0; k < numberOfTargets; k++) {
+                    const CubicSegment segment{
+                            glm::vec4(source[numberOfTargets + k]),
+                            glm::vec4(source[2 * numberOfTargets + k] * duration),
+                            glm::vec4(target[k] * duration),
+                            glm::vec4(target[numberOfTargets + k])
+                    };
+                    write(channel.node, k, evaluateHermite(segment, factor).x);
+                }
+
+                continue;
+            }
+
+            if (sampler.interpolationType == Sampler::STEP) {
+                factor = factor < 1.0F ? 0.0F : 1.0F;
+            }
+
+            const auto *source = &sampler.outputs[i * numberOfTargets];
+            const auto *target = &sampler.outputs[next * numberOfTargets];
+
+            for (uint32_t k = 0; k < numberOfTargets; k++) {
+                write(channel.node, k, source[k] + (target[k] - source[k]) * factor);
+            }
+        }
+    }
+
+    void Animation::advance(float deltaTime) {
+        this->currentTime += deltaTime;
+
+        if (this->currentTime > this->endTime) {
+            this->currentTime = this->endTime > 0.0F ? std::fmod(this->currentTime, this->endTime) : 0.0F;
+        }
+    }
+
+    void Animation::update(float deltaTime) {
+        this->advance(deltaTime);
+        this->apply();
+    }
+
+    void Animation::sample(Pose &pose) {
+        this->evaluate([&pose](size_t pathType, uint32_t node, float x, float y, float z, float w) {
+            switch (pathType) {
+                case Channel::TRANSLATION:
+                    pose.translations[node] = glm::vec3(x, y, z);
+                    break;
+                case Channel::ROTATION:
+                    pose.rotations[node] = glm::quat(w, x, y, z);
+                    break;
+                case Channel::SCALE:
+                    pose.scales[node] = glm::vec3(x, y, z);
+                    break;
+                default:
+                    break;
+            }
+        });
+
+        const auto &source = *this->hierarchy;
+
+        this->evaluateMorphWeights([&pose, &source](uint32_t node, uint32_t target, float weight) {
+            pose.morphWeights[source.getMorphWeightOffset(node) + target] = weight;
+        });
+    }
+
+    void Animation::seek(float time) {
+        this->currentTime = time;
+
+        for (size_t i = 0; i < this->channels.size(); i++) {
+            const auto &inputs = this->samplers[this->channels[i].samplerIndex].inputs;
+            this->cursors[i] = inputs.size() > 1 ? searchKeyframe(inputs, time) : 0;
+        }
+
+        this->apply();
+    }
+
+    size_t Animation::findKeyframe(size_t channelIndex) {
+        const auto &inputs = this->samplers[this->channels[channelIndex].samplerIndex].inputs;
+        auto &cursor = this->cursors[channelIndex];
+
+        if (inputs.size() < 2) {
+            return 0;
+        }
+
+        if (cursor > inputs.size() - 2 || inputs[cursor] > this->currentTime) {
+            // Time moved backwards, which happens once per loop when the animation wraps around.
+            cursor = searchKeyframe(inputs, this->currentTime);
+            return cursor;
+        }
+
+        for (size_t step = 0; cursor + 2 < inputs.size() && inputs[cursor + 1] <= this->currentTime; step++) {
+            if (step == MAXIMUM_CURSOR_STEPS) {
+                cursor = searchKeyframe(inputs, this->currentTime);
+                break;
+            }
+
+            cursor++;
+        }
+
+        return cursor;
+    }
+
+    void Animation::apply() {
+        auto &target = *this->hierarchy;
+
+        this->evaluate([&target](size_t pathType, uint32_t node, float x, float y, float z, float w) {
+            switch (pathType) {
+                case Channel::TRANSLATION:
+                    target.setTranslation(node, glm::vec3(x, y, z));
+                    break;
+                case Channel::ROTATION:
+                    target.setRotation(node, glm::quat(w, x, y, z));
+                    break;
+                case Channel::SCALE:
+                    target.setScale(node, glm::vec3(x, y, z));
+                    break;
+                default:
+                    break;
+            }
+        });
+
+        this->evaluateMorphWeights([&target](uint32_t node, uint32_t morphTarget, float weight) {
+            target.setMorphWeight(node, morphTarget, weight);
+        });
+    }
+
+    void Animation::gatherKeyframes(size_t first, size_t last, uint32_t numberOfComponents) {
+        const auto n = last - first;
+
+        for (size_t k = 0; k < n; k++) {
+            const auto channelIndex = first + k;
+            const auto &sampler = this->samplers[this->channels[channelIndex].samplerIndex];
+
+            const auto i = this->findKeyframe(channelIndex);
+            const auto next = std::min(i + 1, sampler.inputs.size() - 1);
+            const auto duration = sampler.inputs[next] - sampler.inputs[i];
+
+            auto factor = duration > 0.0F
+                          ? std::clamp((this->currentTime - sampler.inputs[i]) / duration, 0.0F, 1.0F)
+                          : 0.0F;
+
+            if (sampler.interpolationType == Sampler::CUBICSPLINE) {
+                // Cubic values are final, store them as a zero length interpolation for the batched pass.
+                const auto value = evaluateHermite(sampler.segments[i], factor);
+
+                for (uint32_t component = 0; component < numberOfComponents; component++) {
+                    this->sourceValues[component * n + k] = value[static_cast<glm::length_t>(component)];
+                    this->targetValues[component * n + k] = value[static_cast<glm::length_t>(component)];
+                }
+
+                this->factors[k] = 0.0F;
+                continue;
+            }
+
+            if (sampler.interpolationType == Sampler::STEP) {
+                factor = factor < 1.0F ? 0.0F : 1.0F;
+            }
+
+            this->factors[k] = factor;
+
+            std::array<float, 4> decodedSource{};
+            std::array<float, 4> decodedTarget{};
+            const float *source = nullptr;
+            const float *target = nullptr;
+
+            if (sampler.isQuantized) {
+                compression::decodeKeyframe(sampler, i, decodedSource.data());
+                compression::decodeKeyframe(sampler, next, decodedTarget.data());
+                source = decodedSource.data();
+                target = decodedTarget.data();
+            } else {
+                source = &sampler.outputs[i * numberOfComponents];
+                target = &sampler.outputs[next * numberOfComponents];
+            }
+
+            for (uint32_t component = 0; component < numberOfComponents; component++) {
+                this->sourceValues[component * n + k] = source[component];
+                this->targetValues[component * n + k] = target[component];
+            }
+        }
+    }
+
+    void Animation::interpolateLinear(size_t n, uint32_t numberOfComponents) {
+        const auto *factor = this->factors.data();
+
+        for (uint32_t component = 0; component < numberOfComponents; component++) {
+            const auto *source = this->sourceValues.data() + component * n;
+            const auto *target = this->targetValues.data() + component * n;
+            auto *result = this->resultValues.data() + component * n;
+
+            for (size_t k = 0; k < n; k++) {
+                result[k] = source[k] + (target[k] - source[k]) * factor[k];
+            }
+        }
+    }
+
+    void Animation::interpolateNormalizedLinear(size_t n) {
+        const auto *factor = this->factors.data();
+        auto *sign = this->scratch.data();
+
+        {
+            const auto *source = this->sourceValues.data();
+            const auto *target = this->targetValues.data();
+
+            for (size_t k = 0; k < n; k++) {
+                const auto dot = source[k] * target[k] + source[n + k] * target[n + k] +
+                                 source[2 * n + k] * target[2 * n + k] + source[3 * n + k] * target[3 * n + k];
+
+                // Take the shortest path between both rotations.
+                sign[k] = dot < 0.0F ? -1.0F : 1.0F;
+            }
+        }
+
+        for (uint32_t component = 0; component < 4; component++) {
+            const auto *source = this->sourceValues.data() + component * n;
+            const auto *target = this->targetValues.data() + component * n;
+            auto *result = this->resultValues.data() + component * n;
+
+            for (size_t k = 0; k < n; k++) {
+                result[k] = source[k] + (target[k] * sign[k] - source[k]) * factor[k];
+            }
+        }
+
+        auto *inverseLength = this->scratch.data();
+        const auto *x = this->resultValues.data();
+
+        for (size_t k = 0; k < n; k++) {
+            inverseLength[k] = 1.0F / std::sqrt(x[k] * x[k] + x[n + k] * x[n + k] +
+                                                x[2 * n + k] * x[2 * n + k] + x[3 * n + k] * x[3 * n + k]);
+        }
+
+        for (uint32_t component = 0; component < 4; component++) {
+            auto *result = this->resultValues.data() + component * n;
+
+            for (size_t k = 0; k < n; k++) {
+                result[k] *= inverseLength[k];
+            }
+        }
+    }
+}  // namespace pvk::gltf
@@ -9,93 +9,165 @@
 #define GLTFAnimation_hpp
 
 
+#include <array>
+#include <memory>
 #include <vector>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 
+#include "GLTFHierarchy.hpp"
 #include "GLTFNode.hpp"
 
 namespace pvk::gltf {
+    /**
+     * Everything needed to evaluate one cubic spline interval, padded to exactly one cache line.
+     * Tangents are pre-multiplied with the duration of the interval.
+     */
+    struct alignas(64) CubicSegment {
+        glm::vec4 value;
+        glm::vec4 outTangent;
+        glm::vec4 inTangent;
+        glm::vec4 nextValue;
+    };
+
+    static_assert(sizeof(CubicSegment) == 64 && alignof(CubicSegment) == 64);
+
     struct Sampler {
         enum InterpolationType {
             LINEAR, STEP, CUBICSPLINE
         } interpolationType;
         std::vector<float> inputs;
-        std::vector<glm::vec4> outputs;
+
+        // Keyframe values packed back to back, numberOfComponents floats per keyframe (3 for translation and
+        // scale, 4 for rotation as x, y, z, w, one per morph target for weights). Empty for CUBICSPLINE, which is
+        // stored as segments instead, except for weights which keep the glTF layout of in-tangents, values and
+        // out-tangents.
+        std::vector<float> outputs;
+        uint32_t numberOfComponents;
+
+        // One segment per keyframe interval, only used for CUBICSPLINE.
+        std::vector<CubicSegment> segments;
+
+        // Replaces outputs when the sampler is compressed, three 16 bit words per keyframe. Translation and scale
+        // are quantized against rangeMinimum and rangeExtent, rotations use the smallest-three encoding.
+        bool isQuantized = false;
+        std::vector<uint16_t> quantizedOutputs;
+        glm::vec3 rangeMinimum{0.0F};
+        glm::vec3 rangeExtent{0.0F};
+    };
+
+    /**
+     * Optional compression of animation clips during import.
+     */
+    struct AnimationCompression {
+        bool isEnabled = false;
+        bool isQuantized = true;
+
+        // Maximum error per component introduced by removing keyframes.
+        float translationTolerance = 1e-4F;
+        float rotationTolerance = 1e-4F;
+        float scaleTolerance = 1e-4F;
     };
 
     struct Channel {
         enum PathType {
-            TRANSLATION, ROTATION, SCALE
+            TRANSLATION, ROTATION, SCALE, WEIGHTS
         } pathType;
-        std::weak_ptr<Node> node;
+
+        // Index of the target node in the hierarchy of the object.
+        uint32_t node;
         uint32_t samplerIndex;
     };
 
+    /**
+     * Local transforms of all nodes of a hierarchy, used as intermediate result when blending animations.
+     */
+    struct Pose {
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+
+        // Morph weights of all nodes, laid out like in the hierarchy.
+        std::vector<float> morphWeights;
+
+        void copyFrom(const Hierarchy &hierarchy);
+    };
+
     struct Animation {
+        // Transform path types, which are evaluated in batches. WEIGHTS channels come after them.
+        static constexpr size_t NUMBER_OF_PATH_TYPES = 3;
+
         float currentTime;
         float startTime;
         float endTime;
         std::vector<Sampler> samplers;
+
+        // Sorted by path type, so every path type is evaluated as one contiguous batch.
         std::vector<Channel> channels;
 
-        void update(float time) {
-            this->currentTime = this->currentTime + time;
-
-            if (this->currentTime > endTime) {
-                this->currentTime -= endTime;
-            }
-
-            for (auto &channel : channels) {
-                auto &sampler = samplers[channel.samplerIndex];
-
-                for (size_t i = 0; i < sampler.inputs.size() - 1; i++) {
-                    if (currentTime >= sampler.inputs[i] && time <= sampler.inputs[i + 1]) {
-                        float delta = (currentTime - sampler.inputs[i]) / (sampler.inputs[i + 1] - sampler.inputs[i]);
-
-                        switch (channel.pathType) {
-                            case Channel::TRANSLATION: {
-                                glm::vec4 translation = glm::mix(sampler.outputs[i], sampler.outputs[i + 1], delta);
-                                channel.node.lock()->translation = glm::vec3(translation);
-                                break;
-                            }
-                            case Channel::ROTATION: {
-                                glm::quat rotationSource{
-                                        sampler.outputs[i].w,
-                                        sampler.outputs[i].x,
-                                        sampler.outputs[i].y,
-                                        sampler.outputs[i].z,
-                                };
-
-                                glm::quat rotationTarget{
-                                        sampler.outputs[i + 1].w,
-                                        sampler.outputs[i + 1].x,
-                                        sampler.outputs[i + 1].y,
-                                        sampler.outputs[i + 1].z,
-                                };
-
-                                channel.node.lock()->rotation = glm::mat4(
-                                        glm::normalize(glm::slerp(rotationSource, rotationTarget, delta)));
-                                break;
-                            }
-                            case Channel::SCALE: {
-                                glm::vec4 scale = glm::mix(sampler.outputs[i], sampler.outputs[i + 1], delta);
-                                channel.node.lock()->scale = glm::vec3(scale);
-                                break;
-                            }
-                        }
-
-                        auto translationMatrix = glm::translate(glm::mat4(1.0F), channel.node.lock()->translation);
-                        auto rotationMatrix = glm::mat4(channel.node.lock()->rotation);
-                        auto scaleMatrix = glm::scale(glm::mat4(1.0F), channel.node.lock()->scale);
-
-                        channel.node.lock()->matrix = translationMatrix * rotationMatrix * scaleMatrix * glm::mat4(1.0F);
-                    }
-                }
-            }
-        }
+        // Keyframe index per channel, only moves forward during playback so lookups are amortised O(1).
+        std::vector<size_t> cursors;
+
+        std::shared_ptr<Hierarchy> hierarchy;
+
+        /**
+         * Sorts the channels by path type and allocates the buffers used during evaluation. Must be called once
+         * after all samplers and channels have been added.
+         */
+        void prepare();
+
+        /**
+         * Advances the animation by deltaTime seconds, wrapping around at the end, without applying it.
+         */
+        void advance(float deltaTime);
+
+        /**
+         * Advances the animation by deltaTime seconds, wrapping around at the end, and applies it to the nodes.
+         */
+        void update(float deltaTime);
+
+        /**
+         * Evaluates the animation at the current time into a pose, only the animated nodes are written.
+         */
+        void sample(Pose &pose);
+
+        /**
+         * Jumps to an arbitrary time, the keyframes are looked up with a binary search.
+         */
+        void seek(float time);
+
+    private:
+        [[nodiscard]] size_t findKeyframe(size_t channelIndex);
+
+        void apply();
+
+        template<typename Fn>
+        void evaluate(Fn &&write);
+
+        /**
+         * Evaluates the WEIGHTS channels, calls write for every morph target of every animated node.
+         */
+        template<typename Fn>
+        void evaluateMorphWeights(Fn &&write);
+
+        void gatherKeyframes(size_t first, size_t last, uint32_t numberOfComponents);
+
+        void interpolateLinear(size_t n, uint32_t numberOfComponents);
+
+        void interpolateNormalizedLinear(size_t n);
+
+        // First channel of every path type, channels of path type p are [pathOffsets[p], pathOffsets[p + 1]).
+        // WEIGHTS channels are [pathOffsets[NUMBER_OF_PATH_TYPES], channels.size()).
+        std::array<size_t, NUMBER_OF_PATH_TYPES + 1> pathOffsets{};
+
+        // Evaluation buffers holding one component of all channels of a batch contiguously.
+        std::vector<float> sourceValues;
+        std::vector<float> targetValues;
+        std::vector<float> resultValues;
+        std::vector<float> factors;
+        std::vector<float> scratch;
     };
 }
 
@@ -0,0 +1,231 @@
+//
+//  GLTFAnimationCompression.cpp
+//  PVK
+//
+
+#include "GLTFAnimationCompression.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+    constexpr float MAXIMUM_SMALLEST_THREE = 0.70710678F;  // 1 / sqrt(2)
+    constexpr float MAXIMUM_15_BIT = 32767.0F;
+    constexpr float MAXIMUM_16_BIT = 65535.0F;
+    constexpr uint16_t LOWER_15_BITS = 0x7FFF;
+
+    void interpolate(const pvk::gltf::Sampler &sampler, size_t from, size_t to, float t, float *result) {
+        const auto numberOfComponents = sampler.numberOfComponents;
+        const auto *source = &sampler.outputs[from * numberOfComponents];
+        const auto *target = &sampler.outputs[to * numberOfComponents];
+
+        if (sampler.interpolationType == pvk::gltf::Sampler::STEP) {
+            std::copy(source, source + numberOfComponents, result);
+            return;
+        }
+
+        auto sign = 1.0F;
+
+        if (numberOfComponents == 4) {
+            const auto dot = source[0] * target[0] + source[1] * target[1] +
+                             source[2] * target[2] + source[3] * target[3];
+            sign = dot < 0.0F ? -1.0F : 1.0F;
+        }
+
+        for (uint32_t i = 0; i < numberOfComponents; i++) {
+            result[i] = source[i] + (target[i] * sign - source[i]) * t;
+        }
+
+        if (numberOfComponents == 4) {
+            const auto length = std::sqrt(result[0] * result[0] + result[1] * result[1] +
+                                          result[2] * result[2] + result[3] * result[3]);
+
+            for (uint32_t i = 0; i < 4; i++) {
+                result[i] /= length;
+            }
+        }
+    }
+
+    float getDifference(const float *a, const float *b, uint32_t numberOfComponents) {
+        auto difference = 0.0F;
+        auto negatedDifference = 0.0F;
+
+        for (uint32_t i = 0; i < numberOfComponents; i++) {
+            difference = std::max(difference, std::abs(a[i] - b[i]));
+            negatedDifference = std::max(negatedDifference, std::abs(a[i] + b[i]));
+        }
+
+        // q and -q describe the same rotation.
+        return numberOfComponents == 4 ? std::min(difference, negatedDifference) : difference;
+    }
+
+    bool isReproduced(const pvk::gltf::Sampler &sampler, size_t from, size_t to, float tolerance) {
+        const auto &inputs = sampler.inputs;
+        const auto numberOfComponents = sampler.numberOfComponents;
+        std::array<float, 4> value{};
+
+        for (auto i = from + 1; i < to; i++) {
+            const auto t = (inputs[i] - inputs[from]) / (inputs[to] - inputs[from]);
+            interpolate(sampler, from, to, t, value.data());
+
+            if (getDifference(value.data(), &sampler.outputs[i * numberOfComponents], numberOfComponents) >
+                tolerance) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    uint16_t quantizeUnit(float value, float maximum) {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0F, 1.0F) * maximum));
+    }
+}  // namespace
+
+namespace pvk::gltf::compression {
+    void reduceKeyframes(Sampler &sampler, float tolerance) {
+        const auto numberOfKeyframes = sampler.inputs.size();
+        const auto numberOfComponents = sampler.numberOfComponents;
+
+        if (sampler.interpolationType == Sampler::CUBICSPLINE || sampler.isQuantized || numberOfKeyframes < 3) {
+            return;
+        }
+
+        std::vector<size_t> keptKeyframes{0};
+        size_t start = 0;
+
+        for (size_t end = 2; end < numberOfKeyframes; end++) {
+            if (!isReproduced(sampler, start, end, tolerance)) {
+                start = end - 1;
+                keptKeyframes.emplace_back(start);
+            }
+        }
+
+        keptKeyframes.emplace_back(numberOfKeyframes - 1);
+
+        std::vector<float> inputs;
+        std::vector<float> outputs;
+        inputs.reserve(keptKeyframes.size());
+        outputs.reserve(keptKeyframes.size() * numberOfComponents);
+
+        for (const auto keyframe : keptKeyframes) {
+            inputs.emplace_back(sampler.inputs[keyframe]);
+
+            const auto begin = sampler.outputs.begin() + static_cast<std::ptrdiff_t>(keyframe * numberOfComponents);
+            outputs.insert(outputs.end(), begin, begin + numberOfComponents);
+        }
+
+        sampler.inputs = std::move(inputs);
+        sampler.outputs = std::move(outputs);
+    }
+
+    void quantize(Sampler &sampler) {
+        const auto numberOfKeyframes = sampler.inputs.size();
+        const auto numberOfComponents = sampler.numberOfComponents;
+
+        if (sampler.interpolationType == Sampler::CUBICSPLINE || sampler.isQuantized ||
+            (numberOfComponents != 3 && numberOfComponents != 4)) {
+            return;
+        }
+
+        sampler.quantizedOutputs.clear();
+        sampler.quantizedOutputs.reserve(numberOfKeyframes * 3);
+
+        if (numberOfComponents == 4) {
+            for (size_t i = 0; i < numberOfKeyframes; i++) {
+                const auto encodedRotation = encodeRotation(&sampler.outputs[i * 4]);
+                sampler.quantizedOutputs.insert(
+                        sampler.quantizedOutputs.end(), encodedRotation.begin(), encodedRotation.end()
+                );
+            }
+        } else {
+            glm::vec3 minimum(std::numeric_limits<float>::max());
+            glm::vec3 maximum(std::numeric_limits<float>::lowest());
+
+            for (size_t i = 0; i < numberOfKeyframes; i++) {
+                const auto value = glm::make_vec3(&sampler.outputs[i * 3]);
+                minimum = glm::min(minimum, value);
+                maximum = glm::max(maximum, value);
+            }
+
+            sampler.rangeMinimum = minimum;
+            sampler.rangeExtent = maximum - minimum;
+
+            for (size_t i = 0; i < numberOfKeyframes; i++) {
+                for (glm::length_t j = 0; j < 3; j++) {
+                    const auto extent = sampler.rangeExtent[j];
+                    const auto value = sampler.outputs[i * 3 + static_cast<size_t>(j)];
+                    const auto normalized = extent > 0.0F ? (value - minimum[j]) / extent : 0.0F;
+
+                    sampler.quantizedOutputs.emplace_back(quantizeUnit(normalized, MAXIMUM_16_BIT));
+                }
+            }
+        }
+
+        sampler.isQuantized = true;
+        sampler.outputs.clear();
+        sampler.outputs.shrink_to_fit();
+    }
+
+    void decodeKeyframe(const Sampler &sampler, size_t keyframe, float *values) {
+        const auto *encoded = &sampler.quantizedOutputs[keyframe * 3];
+
+        if (sampler.numberOfComponents == 4) {
+            decodeRotation(encoded, values);
+            return;
+        }
+
+        for (glm::length_t i = 0; i < 3; i++) {
+            const auto normalized = static_cast<float>(encoded[i]) / MAXIMUM_16_BIT;
+            values[i] = sampler.rangeMinimum[i] + normalized * sampler.rangeExtent[i];
+        }
+    }
+
+    std::array<uint16_t, 3> encodeRotation(const float *rotation) {
+        uint16_t largestIndex = 0;
+
+        for (uint16_t i = 1; i < 4; i++) {
+            if (std::abs(rotation[i]) > std::abs(rotation[largestIndex])) {
+                largestIndex = i;
+            }
+        }
+
+        // The largest component is restored from the other three, its sign is folded into them.
+        const auto sign = rotation[largestIndex] < 0.0F ? -1.0F : 1.0F;
+        std::array<uint16_t, 3> result{};
+
+        for (uint16_t i = 0, j = 0; i < 4; i++) {
+            if (i == largestIndex) {
+                continue;
+            }
+
+            const auto normalized = (rotation[i] * sign / MAXIMUM_SMALLEST_THREE + 1.0F) * 0.5F;
+            result[j++] = quantizeUnit(normalized, MAXIMUM_15_BIT);
+        }
+
+        // The two bit index of the largest component is stored in the top bits of the first two words.
+        result[0] |= static_cast<uint16_t>(((largestIndex >> 1U) & 1U) << 15U);
+        result[1] |= static_cast<uint16_t>((largestIndex & 1U) << 15U);
+
+        return result;
+    }
+
+    void decodeRotation(const uint16_t *encodedRotation, float *rotation) {
+        const auto largestIndex = static_cast<uint32_t>(((encodedRotation[0] >> 15U) << 1U) |
+                                                        (encodedRotation[1] >> 15U));
+        auto sumOfSquares = 0.0F;
+
+        for (uint32_t i = 0, j = 0; i < 4; i++) {
+            if (i == largestIndex) {
+                continue;
+            }
+
+            const auto quantized = static_cast<float>(encodedRotation[j++] & LOWER_15_BITS);
+            rotation[i] = (quantized / MAXIMUM_15_BIT * 2.0F - 1.0F) * MAXIMUM_SMALLEST_THREE;
+            sumOfSquares += rotation[i] * rotation[i];
+        }
+
+        rotation[largestIndex] = std::sqrt(std::max(0.0F, 1.0F - sumOfSquares));
+    }
+}  // namespace pvk::gltf::compression
@@ -0,0 +1,37 @@
+//
+//  GLTFAnimationCompression.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFANIMATIONCOMPRESSION_HPP
+#define PVK_GLTFANIMATIONCOMPRESSION_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "GLTFAnimation.hpp"
+
+namespace pvk::gltf::compression {
+    /**
+     * Removes keyframes that the sampler's own interpolation reproduces within the tolerance (maximum absolute
+     * difference per component). Only LINEAR and STEP samplers are reduced, cubic splines are left untouched.
+     */
+    void reduceKeyframes(Sampler &sampler, float tolerance);
+
+    /**
+     * Replaces the float outputs of a LINEAR or STEP sampler by 48 bits per keyframe. Rotations are stored as
+     * smallest-three quaternions, translation and scale are quantized against the range of the track.
+     */
+    void quantize(Sampler &sampler);
+
+    /**
+     * Decodes one keyframe of a quantized sampler into numberOfComponents floats.
+     */
+    void decodeKeyframe(const Sampler &sampler, size_t keyframe, float *values);
+
+    std::array<uint16_t, 3> encodeRotation(const float *rotation);
+
+    void decodeRotation(const uint16_t *encodedRotation, float *rotation);
+}  // namespace pvk::gltf::compression
+
+#endif //PVK_GLTFANIMATIONCOMPRESSION_HPP
@@ -0,0 +1,232 @@
+//
+//  GLTFAnimationMixer.cpp
+//  PVK
+//
+
+#include "GLTFAnimationMixer.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace pvk::gltf {
+    AnimationMixer::AnimationMixer(std::shared_ptr<Hierarchy> newHierarchy) : hierarchy(std::move(newHierarchy)) {
+        this->restPose.copyFrom(*this->hierarchy);
+        this->blendedPose = this->restPose;
+        this->totalWeights.resize(this->hierarchy->size());
+        this->totalLayerWeights.resize(this->hierarchy->size());
+    }
+
+    size_t AnimationMixer::addLayer(Animation &animation, float weight, BlendMode blendMode) {
+        if (animation.hierarchy != this->hierarchy) {
+            throw std::runtime_error("Animation does not belong to the hierarchy of the mixer.");
+        }
+
+        Layer layer;
+        layer.animation = &animation;
+        layer.weight = weight;
+        layer.blendMode = blendMode;
+        layer.pose = this->restPose;
+        layer.isNodeAnimated.resize(this->hierarchy->size(), 0);
+
+        if (blendMode == BlendMode::ADDITIVE) {
+            const auto currentTime = animation.currentTime;
+            animation.currentTime = animation.startTime;
+            layer.referencePose = this->restPose;
+            animation.sample(layer.referencePose);
+            animation.currentTime = currentTime;
+        }
+
+        for (const auto &channel : animation.channels) {
+            layer.isNodeAnimated[channel.node] = 1;
+            this->animatedNodes.emplace_back(channel.node);
+        }
+
+        std::sort(this->animatedNodes.begin(), this->animatedNodes.end());
+        this->animatedNodes.erase(
+                std::unique(this->animatedNodes.begin(), this->animatedNodes.end()),
+                this->animatedNodes.end()
+        );
+
+        this->layers.emplace_back(std::move(layer));
+
+        return this->layers.size() - 1;
+    }
+
+    void AnimationMixer::setWeight(size_t layerIndex, float weight) {
+        this->layers.at(layerIndex).weight = weight;
+    }
+
+    void AnimationMixer::setMask(size_t layerIndex, std::vector<float> mask) {
+        if (!mask.empty() && mask.size() != this->hierarchy->size()) {
+            throw std::runtime_error("Mask must contain a weight for every node of the hierarchy.");
+        }
+
+        this->layers.at(layerIndex).mask = std::move(mask);
+    }
+
+    void AnimationMixer::update(float deltaTime) {
+        if (this->layers.empty()) {
+            return;
+        }
+
+        for (auto &layer : this->layers) {
+            layer.animation->advance(deltaTime);
+
+            if (layer.weight > 0.0F) {
+                layer.animation->sample(layer.pose);
+            }
+        }
+
+        this->blendOverrideLayers();
+        this->addAdditiveLayers();
+        this->writePose();
+    }
+
+    float AnimationMixer::getNodeWeight(const Layer &layer, uint32_t node) const {
+        return layer.mask.empty() ? layer.weight : layer.weight * layer.mask[node];
+    }
+
+    void AnimationMixer::blendOverrideLayers() {
+        auto &pose = this->blendedPose;
+        const auto &hierarchyReference = *this->hierarchy;
+
+        for (const auto node : this->animatedNodes) {
+            pose.translations[node] = glm::vec3(0.0F);
+            pose.rotations[node] = glm::quat(0.0F, 0.0F, 0.0F, 0.0F);
+            pose.scales[node] = glm::vec3(0.0F);
+            this->totalWeights[node] = 0.0F;
+            this->totalLayerWeights[node] = 0.0F;
+
+            const auto offset = hierarchyReference.getMorphWeightOffset(node);
+            const auto count = hierarchyReference.getMorphWeights(node).size();
+            std::fill_n(pose.morphWeights.begin() + offset, count, 0.0F);
+        }
+
+        const auto accumulate = [&pose, &hierarchyReference, this](const Pose &source, uint32_t node, float weight) {
+            const auto &rotation = source.rotations[node];
+            // Keep all rotations in the same hemisphere, otherwise they partially cancel each other out.
+            const auto sign = glm::dot(pose.rotations[node], rotation) < 0.0F ? -1.0F : 1.0F;
+
+            pose.translations[node] += source.translations[node] * weight;
+            pose.rotations[node] = pose.rotations[node] + rotation * (weight * sign);
+            pose.scales[node] += source.scales[node] * weight;
+            this->totalWeights[node] += weight;
+
+            const auto offset = hierarchyReference.getMorphWeightOffset(node);
+            const auto count = hierarchyReference.getMorphWeights(node).size();
+
+            for (size_t k = offset; k < offset + count; k++) {
+                pose.morphWeights[k] += source.morphWeights[k] * weight;
+            }
+        };
+
+        for (const auto &layer : this->layers) {
+            if (layer.blendMode != BlendMode::OVERRIDE || layer.weight <= 0.0F) {
+                continue;
+            }
+
+            for (const auto node : this->animatedNodes) {
+                const auto weight = this->getNodeWeight(layer, node);
+
+                if (weight <= 0.0F) {
+                    continue;
+                }
+
+                this->totalLayerWeights[node] += weight;
+
+                // The pose of a layer only holds the rest pose for nodes its animation does not target.
+                if (layer.isNodeAnimated[node] != 0) {
+                    accumulate(layer.pose, node, weight);
+                }
+            }
+        }
+
+        for (const auto node : this->animatedNodes) {
+            const auto layerWeight = this->totalLayerWeights[node];
+
+            if (this->totalWeights[node] <= 0.0F) {
+                accumulate(this->restPose, node, 1.0F);
+            } else if (layerWeight < 1.0F) {
+                // Renormalizes the animating layers to the weight of all layers, the rest pose fills up the rest.
+                accumulate(this->restPose, node, (1.0F - layerWeight) * this->totalWeights[node] / layerWeight);
+            }
+
+            const auto inverseWeight = 1.0F / this->totalWeights[node];
+            pose.translations[node] *= inverseWeight;
+            pose.scales[node] *= inverseWeight;
+            pose.rotations[node] = glm::normalize(pose.rotations[node]);
+
+            const auto offset = hierarchyReference.getMorphWeightOffset(node);
+            const auto count = hierarchyReference.getMorphWeights(node).size();
+
+            for (size_t k = offset; k < offset + count; k++) {
+                pose.morphWeights[k] *= inverseWeight;
+            }
+        }
+    }
+
+    void AnimationMixer::addAdditiveLayers() {
+        auto &pose = this->blendedPose;
+        const auto identity = glm::quat(1.0F, 0.0F, 0.0F, 0.0F);
+
+        for (const auto &layer : this->layers) {
+            if (layer.blendMode != BlendMode::ADDITIVE || layer.weight <= 0.0F) {
+                continue;
+            }
+
+            for (const auto node : this->animatedNodes) {
+                const auto weight = this->getNodeWeight(layer, node);
+
+                if (weight <= 0.0F) {
+                    continue;
+                }
+
+                const auto &reference = layer.referencePose;
+                const auto rotationDelta = glm::inverse(reference.rotations[node]) * layer.pose.rotations[node];
+                const auto scaleDelta = layer.pose.scales[node] / reference.scales[node];
+
+                pose.translations[node] += (layer.pose.translations[node] - reference.translations[node]) * weight;
+                pose.rotations[node] = glm::normalize(
+                        pose.rotations[node] * glm::slerp(identity, rotationDelta, weight)
+                );
+                pose.scales[node] *= glm::mix(glm::vec3(1.0F), scaleDelta, weight);
+
+                const auto offset = this->hierarchy->getMorphWeightOffset(node);
+                const auto count = this->hierarchy->getMorphWeights(node).size();
+
+                for (size_t k = offset; k < offset + count; k++) {
+                    pose.morphWeights[k] += (layer.pose.morphWeights[k] - reference.morphWeights[k]) * weight;
+                }
+            }
+        }
+    }
+
+    void AnimationMixer::writePose() {
+        const auto &pose = this->blendedPose;
+        auto &target = *this->hierarchy;
+
+        // Only touch transforms that changed, so unchanged joints are not marked dirty.
+        for (const auto node : this->animatedNodes) {
+            if (target.getTranslation(node) != pose.translations[node]) {
+                target.setTranslation(node, pose.translations[node]);
+            }
+
+            if (target.getRotation(node) != pose.rotations[node]) {
+                target.setRotation(node, pose.rotations[node]);
+            }
+
+            if (target.getScale(node) != pose.scales[node]) {
+                target.setScale(node, pose.scales[node]);
+            }
+
+            const auto weights = target.getMorphWeights(node);
+            const auto offset = target.getMorphWeightOffset(node);
+
+            for (uint32_t k = 0; k < weights.size(); k++) {
+                if (weights[k] != pose.morphWeights[offset + k]) {
+                    target.setMorphWeight(node, k, pose.morphWeights[offset + k]);
+                }
+            }
+        }
+    }
+}  // namespace pvk::gltf
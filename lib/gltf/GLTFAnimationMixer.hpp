@@ -0,0 +1,88 @@
+//
+//  GLTFAnimationMixer.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFANIMATIONMIXER_HPP
+#define PVK_GLTFANIMATIONMIXER_HPP
+
+#include <memory>
+#include <vector>
+
+#include "GLTFAnimation.hpp"
+#include "GLTFHierarchy.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::gltf {
+    /**
+     * Blends any number of animations of one object. Every layer samples its animation into its own pose,
+     * the poses are blended once and only the resulting transforms that actually changed are written to the
+     * hierarchy.
+     */
+    class AnimationMixer : util::NoCopy {
+    public:
+        enum class BlendMode {
+            // Weighted average with the other override layers, missing weight is filled with the rest pose. The
+            // weight of layers which do not animate a node is shared by the layers which do.
+            OVERRIDE,
+            // Difference between the animation and its first frame is added on top of the blended result.
+            ADDITIVE
+        };
+
+        explicit AnimationMixer(std::shared_ptr<Hierarchy> newHierarchy);
+
+        /**
+         * Adds a layer playing the given animation. The animation must outlive the mixer and should not be
+         * updated by anything else while it is part of the mixer.
+         * @return Index of the new layer.
+         */
+        size_t addLayer(Animation &animation, float weight, BlendMode blendMode = BlendMode::OVERRIDE);
+
+        void setWeight(size_t layerIndex, float weight);
+
+        /**
+         * Limits a layer to a subset of the joints.
+         * @param mask Weight between 0 and 1 per hierarchy index, an empty mask affects all nodes.
+         */
+        void setMask(size_t layerIndex, std::vector<float> mask);
+
+        /**
+         * Advances all layers by deltaTime seconds and writes the blended pose to the hierarchy.
+         */
+        void update(float deltaTime);
+
+    private:
+        struct Layer {
+            Animation *animation = nullptr;
+            float weight = 1.0F;
+            BlendMode blendMode = BlendMode::OVERRIDE;
+            std::vector<float> mask;
+            // Non-zero per hierarchy index targeted by a channel of the animation.
+            std::vector<uint8_t> isNodeAnimated;
+            Pose pose;
+            Pose referencePose;
+        };
+
+        [[nodiscard]] float getNodeWeight(const Layer &layer, uint32_t node) const;
+
+        void blendOverrideLayers();
+
+        void addAdditiveLayers();
+
+        void writePose();
+
+        std::shared_ptr<Hierarchy> hierarchy;
+        std::vector<Layer> layers;
+
+        Pose restPose;
+        Pose blendedPose;
+        // Weight of the layers which animate a node, and of all override layers.
+        std::vector<float> totalWeights;
+        std::vector<float> totalLayerWeights;
+
+        // Sorted hierarchy indices of all nodes targeted by at least one layer.
+        std::vector<uint32_t> animatedNodes;
+    };
+}  // namespace pvk::gltf
+
+#endif //PVK_GLTFANIMATIONMIXER_HPP
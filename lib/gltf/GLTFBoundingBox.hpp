@@ -0,0 +1,56 @@
+//
+//  GLTFBoundingBox.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFBOUNDINGBOX_HPP
+#define PVK_GLTFBOUNDINGBOX_HPP
+
+#include <limits>
+#include <glm/glm.hpp>
+
+namespace pvk::gltf {
+    /**
+     * Axis aligned bounding box, a default constructed box is empty and grows with every extend().
+     */
+    struct BoundingBox {
+        glm::vec3 minimum{std::numeric_limits<float>::max()};
+        glm::vec3 maximum{std::numeric_limits<float>::lowest()};
+
+        [[nodiscard]] bool isEmpty() const {
+            return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z;
+        }
+
+        [[nodiscard]] glm::vec3 getCenter() const {
+            return (minimum + maximum) * 0.5F;
+        }
+
+        [[nodiscard]] glm::vec3 getExtent() const {
+            return (maximum - minimum) * 0.5F;
+        }
+
+        void extend(const glm::vec3 &point) {
+            minimum = glm::min(minimum, point);
+            maximum = glm::max(maximum, point);
+        }
+
+        void extend(const BoundingBox &other) {
+            minimum = glm::min(minimum, other.minimum);
+            maximum = glm::max(maximum, other.maximum);
+        }
+
+        /**
+         * @return Smallest axis aligned box containing this box after it has been transformed by an affine matrix.
+         */
+        [[nodiscard]] BoundingBox transform(const glm::mat4 &matrix) const {
+            const auto center = glm::vec3(matrix * glm::vec4(getCenter(), 1.0F));
+            const auto extent = glm::abs(glm::vec3(matrix[0])) * getExtent().x +
+                                glm::abs(glm::vec3(matrix[1])) * getExtent().y +
+                                glm::abs(glm::vec3(matrix[2])) * getExtent().z;
+
+            return {center - extent, center + extent};
+        }
+    };
+}  // namespace pvk::gltf
+
+#endif //PVK_GLTFBOUNDINGBOX_HPP
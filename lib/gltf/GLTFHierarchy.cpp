@@ -0,0 +1,167 @@
+//
+//  GLTFHierarchy.cpp
+//  PVK
+//
+
+#include "GLTFHierarchy.hpp"
+
+#include <stdexcept>
+
+namespace {
+    glm::mat4 composeMatrix(const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale) {
+        const auto rotationMatrix = glm::mat3_cast(rotation);
+
+        return {
+                glm::vec4(rotationMatrix[0] * scale.x, 0.0F),
+                glm::vec4(rotationMatrix[1] * scale.y, 0.0F),
+                glm::vec4(rotationMatrix[2] * scale.z, 0.0F),
+                glm::vec4(translation, 1.0F)
+        };
+    }
+}  // namespace
+
+namespace pvk::gltf {
+    uint32_t Hierarchy::addNode(int32_t parent) {
+        if (parent >= static_cast<int32_t>(this->parents.size())) {
+            throw std::runtime_error("Parent must be added to the hierarchy before its children.");
+        }
+
+        this->parents.emplace_back(parent);
+        this->translations.emplace_back(0.0F);
+        this->rotations.emplace_back(1.0F, 0.0F, 0.0F, 0.0F);
+        this->scales.emplace_back(1.0F);
+        this->hasMatrix.emplace_back(0);
+        this->localMatrices.emplace_back(1.0F);
+        this->worldMatrices.emplace_back(1.0F);
+        this->morphWeightOffsets.emplace_back(0);
+        this->morphWeightCounts.emplace_back(0);
+        this->isLocalDirty.emplace_back(1);
+        this->isMorphDirty.emplace_back(0);
+        this->isMorphChanged.emplace_back(0);
+        this->isWorldChanged.emplace_back(0);
+
+        return static_cast<uint32_t>(this->parents.size() - 1);
+    }
+
+    void Hierarchy::updateWorldMatrices() {
+        const auto numberOfNodes = this->parents.size();
+        this->changedNodes.clear();
+
+        for (size_t i = 0; i < numberOfNodes; i++) {
+            const auto parent = this->parents[i];
+            const bool isParentChanged = parent != NO_PARENT && this->isWorldChanged[parent] != 0;
+
+            this->isMorphChanged[i] = this->isMorphDirty[i];
+            this->isMorphDirty[i] = 0;
+
+            if (this->isLocalDirty[i] == 0 && !isParentChanged) {
+                this->isWorldChanged[i] = 0;
+
+                if (this->isMorphChanged[i] != 0) {
+                    this->changedNodes.emplace_back(static_cast<uint32_t>(i));
+                }
+
+                continue;
+            }
+
+            if (this->isLocalDirty[i] != 0 && this->hasMatrix[i] == 0) {
+                this->localMatrices[i] = composeMatrix(this->translations[i], this->rotations[i], this->scales[i]);
+            }
+
+            if (parent == NO_PARENT) {
+                this->worldMatrices[i] = this->localMatrices[i];
+            } else {
+                this->worldMatrices[i] = this->worldMatrices[parent] * this->localMatrices[i];
+            }
+
+            this->isLocalDirty[i] = 0;
+            this->isWorldChanged[i] = 1;
+            this->changedNodes.emplace_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    const std::vector<uint32_t> &Hierarchy::getChangedNodes() const {
+        return this->changedNodes;
+    }
+
+    bool Hierarchy::hasChanged(uint32_t index) const {
+        return this->isWorldChanged[index] != 0 || this->isMorphChanged[index] != 0;
+    }
+
+    size_t Hierarchy::size() const {
+        return this->parents.size();
+    }
+
+    int32_t Hierarchy::getParent(uint32_t index) const {
+        return this->parents[index];
+    }
+
+    const glm::vec3 &Hierarchy::getTranslation(uint32_t index) const {
+        return this->translations[index];
+    }
+
+    const glm::quat &Hierarchy::getRotation(uint32_t index) const {
+        return this->rotations[index];
+    }
+
+    const glm::vec3 &Hierarchy::getScale(uint32_t index) const {
+        return this->scales[index];
+    }
+
+    const glm::mat4 &Hierarchy::getLocalMatrix(uint32_t index) const {
+        return this->localMatrices[index];
+    }
+
+    const glm::mat4 &Hierarchy::getWorldMatrix(uint32_t index) const {
+        return this->worldMatrices[index];
+    }
+
+    void Hierarchy::setTranslation(uint32_t index, const glm::vec3 &translation) {
+        this->translations[index] = translation;
+        this->isLocalDirty[index] = 1;
+    }
+
+    void Hierarchy::setRotation(uint32_t index, const glm::quat &rotation) {
+        this->rotations[index] = rotation;
+        this->isLocalDirty[index] = 1;
+    }
+
+    void Hierarchy::setScale(uint32_t index, const glm::vec3 &scale) {
+        this->scales[index] = scale;
+        this->isLocalDirty[index] = 1;
+    }
+
+    void Hierarchy::setMatrix(uint32_t index, const glm::mat4 &matrix) {
+        this->hasMatrix[index] = 1;
+        this->localMatrices[index] = matrix;
+        this->isLocalDirty[index] = 1;
+    }
+
+    void Hierarchy::addMorphWeights(uint32_t index, std::span<const float> weights) {
+        if (this->morphWeightCounts[index] != 0) {
+            throw std::runtime_error("Morph weights of a node can only be added once.");
+        }
+
+        this->morphWeightOffsets[index] = static_cast<uint32_t>(this->morphWeights.size());
+        this->morphWeightCounts[index] = static_cast<uint32_t>(weights.size());
+        this->morphWeights.insert(this->morphWeights.end(), weights.begin(), weights.end());
+        this->isMorphDirty[index] = 1;
+    }
+
+    std::span<const float> Hierarchy::getMorphWeights(uint32_t index) const {
+        return {this->morphWeights.data() + this->morphWeightOffsets[index], this->morphWeightCounts[index]};
+    }
+
+    uint32_t Hierarchy::getMorphWeightOffset(uint32_t index) const {
+        return this->morphWeightOffsets[index];
+    }
+
+    size_t Hierarchy::getNumberOfMorphWeights() const {
+        return this->morphWeights.size();
+    }
+
+    void Hierarchy::setMorphWeight(uint32_t index, uint32_t target, float weight) {
+        this->morphWeights[this->morphWeightOffsets[index] + target] = weight;
+        this->isMorphDirty[index] = 1;
+    }
+}  // namespace pvk::gltf
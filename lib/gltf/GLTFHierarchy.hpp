@@ -0,0 +1,113 @@
+//
+//  GLTFHierarchy.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFHIERARCHY_HPP
+#define PVK_GLTFHIERARCHY_HPP
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "../util/util.hpp"
+
+namespace pvk::gltf {
+    /**
+     * Transforms of all nodes of an object stored as flat arrays. Nodes are added in topological order (a parent
+     * always precedes its children), so all world matrices are resolved in a single linear pass.
+     * Setters mark a node dirty, only dirty nodes and their descendants are recomputed.
+     *
+     * Morph target weights of all nodes are stored back to back in a single array as well. Changing them marks
+     * only the node itself as changed, its world matrix and descendants are left alone.
+     */
+    class Hierarchy : util::NoCopy {
+    public:
+        static constexpr int32_t NO_PARENT = -1;
+
+        /**
+         * Adds a node with an identity transform.
+         * @param parent Index of the parent node, which must have been added already, or NO_PARENT.
+         * @return Index of the new node in the hierarchy.
+         */
+        uint32_t addNode(int32_t parent);
+
+        /**
+         * Recomputes the local and world matrices of all dirty nodes and their descendants.
+         * Replaces the list of changed nodes with the nodes whose world matrix was recomputed.
+         */
+        void updateWorldMatrices();
+
+        /**
+         * @return Indices of the nodes whose world matrix or morph weights changed during the last
+         * updateWorldMatrices().
+         */
+        [[nodiscard]] const std::vector<uint32_t> &getChangedNodes() const;
+
+        [[nodiscard]] bool hasChanged(uint32_t index) const;
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] int32_t getParent(uint32_t index) const;
+
+        [[nodiscard]] const glm::vec3 &getTranslation(uint32_t index) const;
+
+        [[nodiscard]] const glm::quat &getRotation(uint32_t index) const;
+
+        [[nodiscard]] const glm::vec3 &getScale(uint32_t index) const;
+
+        [[nodiscard]] const glm::mat4 &getLocalMatrix(uint32_t index) const;
+
+        [[nodiscard]] const glm::mat4 &getWorldMatrix(uint32_t index) const;
+
+        void setTranslation(uint32_t index, const glm::vec3 &translation);
+
+        void setRotation(uint32_t index, const glm::quat &rotation);
+
+        void setScale(uint32_t index, const glm::vec3 &scale);
+
+        /**
+         * Overrides the translation, rotation and scale of a node with a fixed local matrix.
+         */
+        void setMatrix(uint32_t index, const glm::mat4 &matrix);
+
+        /**
+         * Allocates the morph target weights of a node, at most once per node.
+         * @param weights Initial weight of every morph target of the mesh of the node.
+         */
+        void addMorphWeights(uint32_t index, std::span<const float> weights);
+
+        [[nodiscard]] std::span<const float> getMorphWeights(uint32_t index) const;
+
+        /**
+         * @return Position of the first morph weight of a node in the array of all morph weights.
+         */
+        [[nodiscard]] uint32_t getMorphWeightOffset(uint32_t index) const;
+
+        [[nodiscard]] size_t getNumberOfMorphWeights() const;
+
+        void setMorphWeight(uint32_t index, uint32_t target, float weight);
+
+    private:
+        std::vector<int32_t> parents;
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<uint8_t> hasMatrix;
+        std::vector<glm::mat4> localMatrices;
+        std::vector<glm::mat4> worldMatrices;
+
+        std::vector<float> morphWeights;
+        std::vector<uint32_t> morphWeightOffsets;
+        std::vector<uint32_t> morphWeightCounts;
+
+        std::vector<uint8_t> isLocalDirty;
+        std::vector<uint8_t> isMorphDirty;
+        std::vector<uint8_t> isMorphChanged;
+        std::vector<uint8_t> isWorldChanged;
+        std::vector<uint32_t> changedNodes;
+    };
+}  // namespace pvk::gltf
+
+#endif //PVK_GLTFHIERARCHY_HPP
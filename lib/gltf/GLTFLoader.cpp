@@ -10,6 +10,8 @@
 #include "loader/GLTFLoaderVertex.hpp"
 #include "loader/GLTFLoaderAnimation.hpp"
 #include "loader/GLTFLoaderMaterial.hpp"
+#include "loader/GLTFLoaderMeshlet.hpp"
+#include "../util/threadPool.hpp"
 
 #include <numeric>
 #include <utility>
@@ -52,15 +54,53 @@ namespace {
         return nodeLookup;
     }
 
+    /**
+     * Bounds of a primitive whose accessors carry no min and max. Like gltf::loader::vertex::getPositionBounds(),
+     * morph targets grow the box by the min and max of their position deltas, since any set of them can be on at
+     * the same time.
+     */
+    pvk::gltf::BoundingBox computeBounds(const pvk::gltf::Object &object, const pvk::gltf::Primitive &primitive) {
+        pvk::gltf::BoundingBox bounds;
+        const auto startVertex = primitive.getStartVertex();
+
+        for (uint32_t i = 0; i < primitive.getVertexCount(); i++) {
+            bounds.extend(object.vertices[startVertex + i].pos);
+        }
+
+        if (bounds.isEmpty()) {
+            return bounds;
+        }
+
+        for (uint32_t j = 0; j < primitive.getNumberOfMorphTargets(); j++) {
+            const auto firstDelta = primitive.getFirstMorphDelta() + j * primitive.getVertexCount();
+            glm::vec3 minimumDelta(0.0F);
+            glm::vec3 maximumDelta(0.0F);
+
+            for (uint32_t i = 0; i < primitive.getVertexCount(); i++) {
+                minimumDelta = glm::min(minimumDelta, object.morphDeltas[firstDelta + i].position);
+                maximumDelta = glm::max(maximumDelta, object.morphDeltas[firstDelta + i].position);
+            }
+
+            bounds.minimum += minimumDelta;
+            bounds.maximum += maximumDelta;
+        }
+
+        return bounds;
+    }
+
     std::vector<std::unique_ptr<pvk::gltf::Animation>> loadAnimations(
             const tinygltf::Model &model,
-            const boost::container::flat_map<uint32_t, std::shared_ptr<pvk::gltf::Node>> &nodeLookup
+            const boost::container::flat_map<uint32_t, std::shared_ptr<pvk::gltf::Node>> &nodeLookup,
+            const std::shared_ptr<pvk::gltf::Hierarchy> &hierarchy,
+            const pvk::gltf::AnimationCompression &compression
     ) {
         std::vector<std::unique_ptr<pvk::gltf::Animation>> animations;
         animations.reserve(model.animations.size());
 
         for (const auto &animation : model.animations) {
-            animations.emplace_back(pvk::gltf::loader::animation::getAnimation(model, animation, nodeLookup));
+            animations.emplace_back(
+                    pvk::gltf::loader::animation::getAnimation(model, animation, nodeLookup, hierarchy, compression)
+            );
         }
 
         return animations;
@@ -68,7 +108,12 @@ namespace {
 }  // namespace
 
 namespace pvk {
-    std::unique_ptr<gltf::Object> GLTFLoader::loadObject(vk::Queue &graphicsQueue, const std::string &filePath) {
+    std::unique_ptr<gltf::Object> GLTFLoader::loadObject(
+            vk::Queue &graphicsQueue,
+            const std::string &filePath,
+            const gltf::AnimationCompression &animationCompression,
+            GeometryArena *geometryArena
+    ) {
         tinygltf::TinyGLTF loader;
         auto model = std::make_shared<tinygltf::Model>();
         std::string error;
@@ -102,13 +147,24 @@ namespace pvk {
 
         object->nodes = pvk::gltf::loader::node::loadNodes(model, primitiveLookup, graphicsQueue, *object);
         object->setNodeLookup(initializeNodeLookupTable(object->nodes));
+        object->computeJointBounds();
         object->primitiveLookup = GLTFLoader::initializePrimitiveLookupTable(object->nodes);
-        object->animations = loadAnimations(*model, object->getNodes());
+        object->animations = loadAnimations(*model, object->getNodes(), object->hierarchy, animationCompression);
+        object->updateTransforms();
+        object->updateJoints();
+
+        // Skinned and morphed vertices are rewritten per object by the skinning pass, so they keep their own buffers.
+        const bool canUseGeometryArena = geometryArena != nullptr && !object->indices.empty() &&
+                                         object->skinLookup.empty() && object->morphDeltas.empty();
 
-        buffer::vertex::create(graphicsQueue, object->vertexBuffer, object->vertexBufferMemory, object->vertices);
+        if (canUseGeometryArena) {
+            object->placeInGeometryArena(graphicsQueue, *geometryArena);
+        } else {
+            buffer::vertex::create(graphicsQueue, object->vertexBuffer, object->vertexBufferMemory, object->vertices);
 
-        if (!object->indices.empty()) {
-            buffer::index::create(graphicsQueue, object->indexBuffer, object->indexBufferMemory, object->indices);
+            if (!object->indices.empty()) {
+                buffer::index::create(graphicsQueue, object->indexBuffer, object->indexBufferMemory, object->indices);
+            }
         }
 
         t2 = std::chrono::high_resolution_clock::now();
@@ -149,15 +205,12 @@ namespace pvk {
     }
 
     template<typename T>
-    std::future<std::vector<T>> flatten(std::vector<std::future<std::vector<T>>> &&t) {
-        return std::async(std::launch::async, [t = std::move(t)]() mutable {
-            std::vector<T> result;
-            for (auto &fut : t) {
-                auto allElement = fut.get();
-                std::move(allElement.begin(), allElement.end(), std::back_inserter(result));
-            }
-            return result;
-        });
+    std::vector<T> flatten(std::vector<std::vector<T>> &&t) {
+        std::vector<T> result;
+        for (auto &allElement : t) {
+            std::move(allElement.begin(), allElement.end(), std::back_inserter(result));
+        }
+        return result;
     }
 
     std::vector<std::vector<std::shared_ptr<gltf::Primitive>>> GLTFLoader::loadPrimitives(
@@ -207,6 +260,15 @@ namespace pvk {
                         indexCount
                 );
                 _primitive->material = gltf::loader::material::getMaterial(*model, primitive.material);
+                _primitive->setBounds(gltf::loader::vertex::getPositionBounds(*model, primitive));
+
+                if (!primitive.targets.empty()) {
+                    _primitive->setMorphTargets(
+                            static_cast<uint32_t>(object.morphDeltas.size()),
+                            static_cast<uint32_t>(primitive.targets.size())
+                    );
+                    gltf::loader::vertex::loadMorphTargets(*model, primitive, vertexCount, object.morphDeltas);
+                }
                 meshPrimitives.emplace_back(std::move(_primitive));
 
                 currentVertexOffset += vertexCount;
@@ -216,53 +278,75 @@ namespace pvk {
             primitiveLookup.emplace_back(std::move(meshPrimitives));
         }
 
-        std::vector<std::future<std::vector<Vertex>>> primitiveVertices;
-        std::vector<std::future<std::vector<uint32_t>>> primitiveIndices;
+        // Loading runs on the engine thread pool, so it does not spawn a thread per batch and primitive.
+        auto &threadPool = util::ThreadPool::getInstance();
+        const auto numberOfVertexBatches =
+                (vertexAccessorIndexBatches.size() + VERTEX_BATCH_SIZE - 1) / VERTEX_BATCH_SIZE;
+        std::vector<std::vector<Vertex>> primitiveVertices(numberOfVertexBatches);
+        std::vector<std::vector<uint32_t>> primitiveIndices(primitives.size());
+
+        threadPool.parallelFor(numberOfVertexBatches, 1, [&](size_t begin, size_t end, uint32_t) {
+            for (auto i = begin; i < end; i++) {
+                primitiveVertices[i] = loadVerticesByPrimitive(
+                        model, primitives, vertexAccessorIndexBatches, static_cast<uint32_t>(i * VERTEX_BATCH_SIZE));
+            }
+        });
+
+        threadPool.parallelFor(primitives.size(), 1, [&](size_t begin, size_t end, uint32_t) {
+            for (auto i = begin; i < end; i++) {
+                primitiveIndices[i] = loadIndicesByPrimitive(model, primitives[i], vertexOffsets[i]);
+            }
+        });
 
-        for (size_t i = 0;
-             i < ceil(static_cast<float>(vertexAccessorIndexBatches.size()) / static_cast<float>(VERTEX_BATCH_SIZE));
-             i++) {
-            primitiveVertices.emplace_back(
-                    loadVerticesByPrimitive(model, primitives, vertexAccessorIndexBatches, i * VERTEX_BATCH_SIZE));
-        }
+        std::cout << "Done adding primitives" << std::endl;
+
+        object.vertices = flatten(std::move(primitiveVertices));
+        object.indices = flatten(std::move(primitiveIndices));
 
-        for (size_t i = 0; i < primitives.size(); i++) {
-            std::cout << "Adding primitive" << std::endl;
-            primitiveIndices.emplace_back(loadIndicesByPrimitive(model, primitives[i], vertexOffsets[i]));
+        std::vector<gltf::Primitive *> allPrimitives;
+
+        for (auto &meshPrimitives : primitiveLookup) {
+            for (auto &primitive : meshPrimitives) {
+                allPrimitives.emplace_back(primitive.get());
+            }
         }
 
-        std::cout << "Done adding primitives" << std::endl;
+        threadPool.parallelFor(allPrimitives.size(), 1, [&object, &allPrimitives](size_t begin, size_t end, uint32_t) {
+            for (auto i = begin; i < end; i++) {
+                auto &primitive = *allPrimitives[i];
+                primitive.setMeshlets(gltf::loader::meshlet::buildMeshlets(object.vertices, object.indices, primitive));
 
-        object.vertices = flatten(std::move(primitiveVertices)).get();
-        object.indices = flatten(std::move(primitiveIndices)).get();
+                if (primitive.getBounds().isEmpty()) {
+                    primitive.setBounds(computeBounds(object, primitive));
+                }
+            }
+        });
 
         return primitiveLookup;
     }
 
-    std::future<std::vector<Vertex>> GLTFLoader::loadVerticesByPrimitive(
-            std::shared_ptr<tinygltf::Model> model,
+    std::vector<Vertex> GLTFLoader::loadVerticesByPrimitive(
+            const std::shared_ptr<tinygltf::Model> &model,
             const std::vector<tinygltf::Primitive *> &primitives,
             const std::vector<std::pair<size_t, size_t>> &primitiveIndexPairs,
             uint32_t startingIndex
     ) {
-        return std::async(std::launch::async, [&, model = std::move(model), startingIndex] {
-            std::vector<Vertex> vertices;
-            vertices.reserve(VERTEX_BATCH_SIZE);
-            const auto indexEnd = std::min(
-                    primitiveIndexPairs.size(),
-                    startingIndex + static_cast<size_t>(VERTEX_BATCH_SIZE)
-            );
+        std::vector<Vertex> vertices;
+        vertices.reserve(VERTEX_BATCH_SIZE);
+        const auto indexEnd = std::min(
+                primitiveIndexPairs.size(),
+                startingIndex + static_cast<size_t>(VERTEX_BATCH_SIZE)
+        );
 
-            for (size_t i = startingIndex; i < indexEnd; i++) {
-                const auto &attribute = primitiveIndexPairs[i];
-                const auto &primitive = primitives[attribute.second];
-                const auto vertex = gltf::loader::vertex::generateVertexByPrimitive(model, *primitive, attribute.first);
+        for (size_t i = startingIndex; i < indexEnd; i++) {
+            const auto &attribute = primitiveIndexPairs[i];
+            const auto &primitive = primitives[attribute.second];
+            const auto vertex = gltf::loader::vertex::generateVertexByPrimitive(model, *primitive, attribute.first);
 
-                vertices.emplace_back(vertex);
-            }
+            vertices.emplace_back(vertex);
+        }
 
-            return vertices;
-        });
+        return vertices;
     }
 
     template<typename T>
@@ -283,50 +367,49 @@ namespace pvk {
         }
     }
 
-    std::future<std::vector<uint32_t>> GLTFLoader::loadIndicesByPrimitive(
+    std::vector<uint32_t> GLTFLoader::loadIndicesByPrimitive(
             const std::shared_ptr<tinygltf::Model> &model,
             const tinygltf::Primitive *primitive,
             uint32_t vertexStart
     ) {
-        return std::async(std::launch::async, [model = model, primitive, vertexStart] {
-            std::vector<uint32_t> indices;
+        std::vector<uint32_t> indices;
 
-            if (primitive->indices == -1) {
-                // Model has no indices.
-                return indices;
-            }
+        if (primitive->indices == -1) {
+            // Model has no indices.
+            return indices;
+        }
 
-            const tinygltf::Accessor &indexAccessor = model->accessors[primitive->indices];
-            const tinygltf::BufferView &indexBufferView = model->bufferViews[indexAccessor.bufferView];
-            tinygltf::Buffer &indexBuffer = model->buffers[indexBufferView.buffer];
-            indices.reserve(indexAccessor.count);
+        const tinygltf::Accessor &indexAccessor = model->accessors[primitive->indices];
+        const tinygltf::BufferView &indexBufferView = model->bufferViews[indexAccessor.bufferView];
+        tinygltf::Buffer &indexBuffer = model->buffers[indexBufferView.buffer];
+        indices.reserve(indexAccessor.count);
 
-            switch (indexAccessor.componentType) {
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-                    loadIndices<uint32_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
-                    break;
-                }
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-                    loadIndices<uint16_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
-                    break;
-                }
-                case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-                    loadIndices<uint8_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
-                    break;
-                }
-                default: {
-                    throw std::runtime_error("Unsupported glTF index component type");
-                }
+        switch (indexAccessor.componentType) {
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
+                loadIndices<uint32_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
+                break;
             }
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
+                loadIndices<uint16_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
+                break;
+            }
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
+                loadIndices<uint8_t>(indexAccessor, indexBufferView, indexBuffer, indices, vertexStart);
+                break;
+            }
+            default: {
+                throw std::runtime_error("Unsupported glTF index component type");
+            }
+        }
 
-            return indices;
-        });
+        return indices;
     }
 
     namespace gltf::animation {
         std::vector<std::unique_ptr<Animation>> createFromGLTF(
                 const std::string &filename,
-                const Object &object
+                const Object &object,
+                const AnimationCompression &animationCompression
         ) {
             tinygltf::TinyGLTF loader;
             auto model = std::make_shared<tinygltf::Model>();
@@ -345,7 +428,7 @@ namespace pvk {
                 throw std::runtime_error("Could not load glTF animation");
             }
 
-            return loadAnimations(*model, object.getNodes());
+            return loadAnimations(*model, object.getNodes(), object.hierarchy, animationCompression);
         }
     }  // namespace gltf::animation
 } // namespace pvk
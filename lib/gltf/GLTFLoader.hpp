@@ -30,6 +30,8 @@
 #include "../buffer/buffer.hpp"
 #include "../context/context.hpp"
 #include "GLTFAnimation.hpp"
+#include "GLTFAnimationCompression.hpp"
+#include "GLTFAnimationMixer.hpp"
 #include "GLTFMaterial.hpp"
 #include "GLTFNode.hpp"
 #include "GLTFObject.hpp"
@@ -39,7 +41,12 @@
 namespace pvk {
     class GLTFLoader {
     public:
-        static std::unique_ptr<gltf::Object> loadObject(vk::Queue &graphicsQueue, const std::string &filePath);
+        static std::unique_ptr<gltf::Object> loadObject(
+                vk::Queue &graphicsQueue,
+                const std::string &filePath,
+                const gltf::AnimationCompression &animationCompression = {},
+                GeometryArena *geometryArena = nullptr
+        );
 
         static std::vector<std::vector<std::shared_ptr<gltf::Primitive>>> loadPrimitives(
                 const std::shared_ptr<tinygltf::Model> &model,
@@ -47,22 +54,25 @@ namespace pvk {
                 gltf::Object &object
         );
 
-        static auto loadVerticesByPrimitive(std::shared_ptr<tinygltf::Model> model,
+        static auto loadVerticesByPrimitive(const std::shared_ptr<tinygltf::Model> &model,
                                             const std::vector<tinygltf::Primitive *> &primitives,
                                             const std::vector<std::pair<size_t, size_t>> &primitiveIndexPairs,
-                                            uint32_t startingIndex) -> std::future<std::vector<Vertex>>;
+                                            uint32_t startingIndex) -> std::vector<Vertex>;
 
         static auto loadIndicesByPrimitive(const std::shared_ptr<tinygltf::Model> &model,
                                            const tinygltf::Primitive *primitive,
-                                           uint32_t vertexStart) -> std::future<std::vector<uint32_t>>;
+                                           uint32_t vertexStart) -> std::vector<uint32_t>;
 
         static auto initializePrimitiveLookupTable(std::vector<std::shared_ptr<gltf::Node>> &nodes)
         -> std::map<uint32_t, std::vector<std::weak_ptr<gltf::Primitive>>>;
     };
 
     namespace gltf::animation {
-        std::vector<std::unique_ptr<gltf::Animation>> createFromGLTF(const std::string &filename,
-                                                                     const gltf::Object &object);
+        std::vector<std::unique_ptr<gltf::Animation>> createFromGLTF(
+                const std::string &filename,
+                const gltf::Object &object,
+                const gltf::AnimationCompression &animationCompression = {}
+        );
     }
 } // namespace pvk
 
@@ -20,6 +20,9 @@ namespace pvk::gltf {
             float roughnessFactor{};
         } materialFactor;
 
+        // Alpha mode BLEND, such primitives are drawn after all opaque ones.
+        bool isTransparent = false;
+
         Texture &getTextureByBinding(uint32_t binding) {
             switch (binding) {
                 case 1:
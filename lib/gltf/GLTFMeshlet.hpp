@@ -0,0 +1,35 @@
+//
+//  GLTFMeshlet.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFMESHLET_HPP
+#define PVK_GLTFMESHLET_HPP
+
+#include <glm/glm.hpp>
+
+namespace pvk::gltf {
+    constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+    constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+    /**
+     * Cluster of up to 64 vertices / 124 triangles of a primitive. The triangles of a meshlet are stored
+     * contiguously in the index buffer of the object, so a meshlet can be drawn as a single indexed range.
+     * Bounds are stored in the local space of the node that references the primitive.
+     */
+    struct Meshlet {
+        uint32_t startIndex = 0;
+        uint32_t indexCount = 0;
+        uint32_t vertexCount = 0;
+
+        glm::vec3 center{0.0F};
+        float radius = 0.0F;
+
+        // Normal cone, the meshlet is back-facing when seen from inside the cone spanned by -coneAxis.
+        // A cutoff of 1 disables back-face culling for this meshlet.
+        glm::vec3 coneAxis{0.0F, 0.0F, 1.0F};
+        float coneCutoff = 1.0F;
+    };
+}  // namespace pvk::gltf
+
+#endif //PVK_GLTFMESHLET_HPP
@@ -0,0 +1,28 @@
+//
+//  GLTFMorphTarget.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFMORPHTARGET_HPP
+#define PVK_GLTFMORPHTARGET_HPP
+
+#include <glm/glm.hpp>
+
+namespace pvk::gltf {
+    // Has to match MAX_ACTIVE_MORPH_TARGETS in skinning.comp.
+    constexpr uint32_t MAX_ACTIVE_MORPH_TARGETS = 8;
+
+    /**
+     * Position and normal offset of a single vertex for a single morph target. The deltas of a primitive are
+     * stored target after target, so the delta of vertex v for target t is at firstMorphDelta + t * vertexCount + v.
+     */
+    struct MorphDelta {
+        glm::vec3 position{0.0F};
+        glm::vec3 normal{0.0F};
+    };
+
+    // skinning.comp addresses deltas as an array of floats.
+    static_assert(sizeof(MorphDelta) == 6 * sizeof(float));
+}  // namespace pvk::gltf
+
+#endif //PVK_GLTFMORPHTARGET_HPP
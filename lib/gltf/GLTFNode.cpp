@@ -9,29 +9,59 @@
 
 namespace pvk::gltf
 {
-glm::mat4 Node::getGlobalMatrix() const
+const glm::mat4 &Node::getGlobalMatrix() const
 {
-    auto localMatrix = this->getLocalMatrix();
-    auto currentParent = this->parent;
+    return this->hierarchy->getWorldMatrix(this->hierarchyIndex);
+}
+
+const glm::mat4 &Node::getLocalMatrix() const
+{
+    return this->hierarchy->getLocalMatrix(this->hierarchyIndex);
+}
+
+const glm::vec3 &Node::getTranslation() const
+{
+    return this->hierarchy->getTranslation(this->hierarchyIndex);
+}
 
-    while (currentParent.lock())
-    {
-        localMatrix = currentParent.lock()->getLocalMatrix() * localMatrix;
-        currentParent = currentParent.lock()->parent;
-    }
+const glm::quat &Node::getRotation() const
+{
+    return this->hierarchy->getRotation(this->hierarchyIndex);
+}
 
-    return localMatrix;
+const glm::vec3 &Node::getScale() const
+{
+    return this->hierarchy->getScale(this->hierarchyIndex);
 }
 
-glm::mat4 Node::getLocalMatrix() const
+void Node::setTranslation(const glm::vec3 &translation)
 {
-    if (this->matrix == glm::mat4(1.0F))
-    {
-        return glm::translate(glm::mat4(1.0F), this->translation) * glm::mat4(this->rotation) *
-               glm::scale(glm::mat4(1.0F), this->scale) * this->matrix;
-    }
+    this->hierarchy->setTranslation(this->hierarchyIndex, translation);
+}
 
-    return this->matrix;
+void Node::setRotation(const glm::quat &rotation)
+{
+    this->hierarchy->setRotation(this->hierarchyIndex, rotation);
 }
 
+void Node::setScale(const glm::vec3 &scale)
+{
+    this->hierarchy->setScale(this->hierarchyIndex, scale);
+}
+
+void Node::setMatrix(const glm::mat4 &matrix)
+{
+    this->hierarchy->setMatrix(this->hierarchyIndex, matrix);
+}
+
+void Node::setHierarchy(std::shared_ptr<Hierarchy> newHierarchy, uint32_t index)
+{
+    this->hierarchy = std::move(newHierarchy);
+    this->hierarchyIndex = index;
+}
+
+uint32_t Node::getHierarchyIndex() const
+{
+    return this->hierarchyIndex;
+}
 } // namespace pvk::gltf
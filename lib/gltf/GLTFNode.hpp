@@ -18,6 +18,7 @@
 #include "../mesh/mesh.hpp"
 #include "../util/util.hpp"
 #include "Drawable.h"
+#include "GLTFHierarchy.hpp"
 #include "GLTFPrimitive.hpp"
 
 namespace pvk::gltf
@@ -31,8 +32,24 @@ public:
     Node(Node &&other) = default;
     Node &operator=(Node &&other) = default;
 
-    [[nodiscard]] glm::mat4 getGlobalMatrix() const;
-    [[nodiscard]] glm::mat4 getLocalMatrix() const;
+    /**
+     * World matrix as of the last Object::updateTransforms().
+     */
+    [[nodiscard]] const glm::mat4 &getGlobalMatrix() const;
+    [[nodiscard]] const glm::mat4 &getLocalMatrix() const;
+
+    [[nodiscard]] const glm::vec3 &getTranslation() const;
+    [[nodiscard]] const glm::quat &getRotation() const;
+    [[nodiscard]] const glm::vec3 &getScale() const;
+
+    void setTranslation(const glm::vec3 &translation);
+    void setRotation(const glm::quat &rotation);
+    void setScale(const glm::vec3 &scale);
+    void setMatrix(const glm::mat4 &matrix);
+
+    void setHierarchy(std::shared_ptr<Hierarchy> newHierarchy, uint32_t index);
+    [[nodiscard]] uint32_t getHierarchyIndex() const;
+
     [[nodiscard]] constexpr DrawableType getType() const override {
         return DrawableType::DRAWABLE_NODE;
     }
@@ -43,6 +60,10 @@ public:
     std::weak_ptr<Node> parent;
     int32_t skinIndex = -1;
     int32_t nodeIndex = -1;
+    // Nodes referencing the same mesh share its primitives.
+    int32_t meshIndex = -1;
+    // Transforms relative to the node from EXT_mesh_gpu_instancing, empty when the node is not instanced.
+    std::vector<glm::mat4> instanceMatrices;
     std::string name;
 
     struct
@@ -53,10 +74,9 @@ public:
         float jointCount;
     } bufferObject{};
 
-    glm::vec3 translation = glm::vec3(0.0F);
-    glm::vec3 scale = glm::vec3(1.0F);
-    glm::mat4 rotation = glm::mat4(1.0F);
-    glm::mat4 matrix = glm::mat4(1.0F);
+private:
+    std::shared_ptr<Hierarchy> hierarchy;
+    uint32_t hierarchyIndex = 0;
 };
 } // namespace pvk::gltf
 
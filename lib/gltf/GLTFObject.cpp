@@ -7,6 +7,7 @@
 
 #include "GLTFObject.hpp"
 
+#include <algorithm>
 #include <utility>
 
 namespace pvk::gltf {
@@ -16,7 +17,7 @@ namespace pvk::gltf {
                    std::vector<std::unique_ptr<Animation>> animations,
                    std::vector<std::shared_ptr<Skin>> skins) {
         this->nodes = std::move(nodes);
-        this->nodeLookup = std::move(nodeLookup);
+        this->setNodeLookup(std::move(nodeLookup));
         this->primitiveLookup = std::move(primitiveLookup);
         this->animations = std::move(animations);
         this->skins = std::move(skins);
@@ -24,6 +25,40 @@ namespace pvk::gltf {
 
     Object::~Object() = default;
 
+    void Object::placeInGeometryArena(vk::Queue &graphicsQueue, GeometryArena &geometryArena) {
+        this->geometryAllocation = geometryArena.allocate(graphicsQueue, this->vertices, this->indices);
+
+        const auto firstIndex = this->geometryAllocation.getFirstIndex();
+        const auto vertexOffset = static_cast<int32_t>(this->geometryAllocation.getFirstVertex());
+
+        // Nodes sharing a mesh share its primitives, which then simply get the same offsets again.
+        for (const auto &[nodeIndex, node] : this->nodeLookup) {
+            for (const auto &primitive : node->primitives) {
+                primitive->setGeometryOffsets(firstIndex + primitive->getStartIndex(), vertexOffset);
+            }
+        }
+    }
+
+    vk::Buffer Object::getVertexBuffer() const {
+        if (this->geometryAllocation.isValid()) {
+            return this->geometryAllocation.getArena().getVertexBuffer();
+        }
+
+        return this->vertexBuffer.get();
+    }
+
+    vk::Buffer Object::getIndexBuffer() const {
+        if (this->geometryAllocation.isValid()) {
+            return this->geometryAllocation.getArena().getIndexBuffer();
+        }
+
+        return this->indexBuffer.get();
+    }
+
+    VertexLayout Object::getVertexLayout() const {
+        return VertexLayout::fromVertex();
+    }
+
     void Object::initializeWriteDescriptorSets(const vk::DescriptorPool &descriptorPool,
                                                const vk::DescriptorSetLayout &descriptorSetLayout,
                                                uint32_t numberOfSwapChainImages,
@@ -37,29 +72,139 @@ namespace pvk::gltf {
         }
     }
 
-    void Object::updateJoints() {
-        this->updateJointsByNode(*this->nodes[0]);
+    void Object::setNodeLookup(boost::container::flat_map<uint32_t, std::shared_ptr<Node>> newNodeLookup) {
+        this->nodeLookup = std::move(newNodeLookup);
+        this->nodesByHierarchyIndex.assign(this->hierarchy->size(), nullptr);
+        this->skinnedNodes.clear();
+
+        for (auto &[nodeIndex, node] : this->nodeLookup) {
+            this->nodesByHierarchyIndex[node->getHierarchyIndex()] = node.get();
+
+            if (node->mesh && node->skinIndex > -1) {
+                this->skinnedNodes.emplace_back(node.get());
+            }
+        }
+
+        for (auto &[skinIndex, skin] : this->skinLookup) {
+            if (!skin) {
+                continue;
+            }
+
+            std::vector<uint32_t> jointHierarchyIndices;
+            jointHierarchyIndices.reserve(skin->jointsIndices.size());
+
+            for (const auto jointIndex : skin->jointsIndices) {
+                jointHierarchyIndices.emplace_back(this->getNodeByIndex(jointIndex).getHierarchyIndex());
+            }
+
+            skin->resolveJoints(std::move(jointHierarchyIndices));
+        }
     }
 
-    void Object::updateJointsByNode(Node &node) {
-        if (node.mesh && node.skinIndex > -1) {
-            auto inverseTransform = glm::inverse(node.getGlobalMatrix());
-            auto skin = this->skinLookup[node.skinIndex];
-            auto numberOfJoints = skin->jointsIndices.size();
+    void Object::updateTransforms() {
+        this->hierarchy->updateWorldMatrices();
+        this->changedNodes.clear();
 
-            std::vector<glm::mat4> jointMatrices(numberOfJoints);
+        for (const auto index : this->hierarchy->getChangedNodes()) {
+            if (auto *node = this->nodesByHierarchyIndex[index]) {
+                this->changedNodes.emplace_back(node);
+            }
+        }
 
-            for (size_t i = 0; i < numberOfJoints; i++) {
-                jointMatrices[i] =
-                        this->getNodeByIndex(skin->jointsIndices[i]).getGlobalMatrix() * skin->inverseBindMatrices[i];
-                jointMatrices[i] = inverseTransform * jointMatrices[i];
+        for (auto &[skinIndex, skin] : this->skinLookup) {
+            if (skin) {
+                skin->hasChanged = skin->hasJointChanged(*this->hierarchy);
             }
+        }
 
-            this->inverseBindMatrices = jointMatrices;
+        // A skinned node also changes when only its joints moved, since its palette has to be uploaded again.
+        for (auto *node : this->skinnedNodes) {
+            if (!this->hierarchy->hasChanged(node->getHierarchyIndex()) &&
+                this->skinLookup.at(node->skinIndex)->hasChanged) {
+                this->changedNodes.emplace_back(node);
+            }
         }
+    }
+
+    void Object::setSkinningMode(SkinningMode skinningMode) {
+        for (auto &[skinIndex, skin] : this->skinLookup) {
+            if (skin && skin->skinningMode != skinningMode) {
+                skin->setSkinningMode(skinningMode);
+                skin->updateJointMatrices(*this->hierarchy);
+            }
+        }
+    }
+
+    void Object::fillDualQuaternionBufferObject(const Node &node, DualQuaternionBufferObject &bufferObject) const {
+        bufferObject.jointCount = 0.0F;
+
+        if (node.skinIndex < 0) {
+            return;
+        }
+
+        const auto &skin = *this->skinLookup.at(node.skinIndex);
+
+        if (skin.skinningMode != SkinningMode::DUAL_QUATERNION) {
+            throw std::runtime_error("The skin of the node does not build dual quaternions.");
+        }
+
+        const auto numberOfJoints = std::min(
+                skin.jointDualQuaternions.size(), DualQuaternionBufferObject::MAX_JOINTS
+        );
+
+        std::copy_n(skin.jointDualQuaternions.begin(), numberOfJoints, bufferObject.jointDualQuaternions);
+        bufferObject.jointCount = static_cast<float>(numberOfJoints);
+    }
+
+    void Object::computeJointBounds() {
+        for (auto *node : this->skinnedNodes) {
+            auto &jointBounds = this->skinLookup.at(node->skinIndex)->jointBounds;
+
+            for (const auto &primitive : node->primitives) {
+                const auto startVertex = primitive->getStartVertex();
+                const auto vertexCount = primitive->getVertexCount();
 
-        for (auto &child : node.children) {
-            this->updateJointsByNode(*child);
+                for (uint32_t i = 0; i < vertexCount; i++) {
+                    const auto &vertex = this->vertices[startVertex + i];
+                    auto minimum = vertex.pos;
+                    auto maximum = vertex.pos;
+
+                    for (uint32_t j = 0; j < primitive->getNumberOfMorphTargets(); j++) {
+                        const auto &delta = this->morphDeltas[primitive->getFirstMorphDelta() + j * vertexCount + i];
+                        minimum += glm::min(delta.position, glm::vec3(0.0F));
+                        maximum += glm::max(delta.position, glm::vec3(0.0F));
+                    }
+
+                    for (glm::length_t k = 0; k < 4; k++) {
+                        const auto joint = static_cast<size_t>(vertex.joint[k]);
+
+                        if (vertex.weight[k] > 0.0F && joint < jointBounds.size()) {
+                            jointBounds[joint].extend(minimum);
+                            jointBounds[joint].extend(maximum);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    BoundingBox Object::getSkinnedBounds() const {
+        BoundingBox bounds;
+
+        for (const auto &[skinIndex, skin] : this->skinLookup) {
+            if (skin) {
+                bounds.extend(skin->bounds);
+            }
+        }
+
+        return bounds;
+    }
+
+    void Object::updateJoints() {
+        for (auto &[skinIndex, skin] : this->skinLookup) {
+            if (skin && skin->hasChanged) {
+                skin->updateJointMatrices(*this->hierarchy);
+            }
         }
     }
 }  // namespace pvk::gltf
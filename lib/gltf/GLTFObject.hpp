@@ -14,10 +14,14 @@
 #include <vulkan/vulkan.hpp>
 #include <boost/container/flat_map.hpp>
 
+#include "../buffer/geometryArena.hpp"
+#include "../mesh/vertexLayout.hpp"
 #include "GLTFNode.hpp"
 #include "GLTFAnimation.hpp"
+#include "GLTFHierarchy.hpp"
 #include "GLTFSkin.hpp"
 #include "GLTFMaterial.hpp"
+#include "GLTFMorphTarget.hpp"
 
 namespace pvk::gltf {
     class Object {
@@ -33,27 +37,95 @@ namespace pvk::gltf {
         ~Object();
 
         std::vector<std::shared_ptr<Node>> nodes;
+        std::shared_ptr<Hierarchy> hierarchy = std::make_shared<Hierarchy>();
         std::map<uint32_t, std::vector<std::weak_ptr<Primitive>>> primitiveLookup;
         std::map<uint32_t, std::shared_ptr<Skin>> skinLookup;
         std::vector<std::unique_ptr<Animation>> animations;
         std::vector<std::shared_ptr<Skin>> skins;
-        std::vector<glm::mat4> inverseBindMatrices;
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
+        std::vector<MorphDelta> morphDeltas;
         std::vector<std::unique_ptr<gltf::Material>> materials;
         vk::UniqueBuffer vertexBuffer;
         vk::UniqueDeviceMemory vertexBufferMemory;
         vk::UniqueBuffer indexBuffer;
         vk::UniqueDeviceMemory indexBufferMemory;
+        // Range of the object in a GeometryArena, invalid when the object owns its buffers.
+        GeometryArena::Allocation geometryAllocation;
 
         void initializeWriteDescriptorSets(const vk::DescriptorPool &descriptorPool,
                                            const vk::DescriptorSetLayout &descriptorSetLayout,
                                            uint32_t numberOfSwapChainImages,
                                            uint32_t descriptorSetIndex);
 
+        /**
+         * Resolves the world matrices of all dirty nodes, call after animating and before reading global matrices.
+         * Also rebuilds the list of changed nodes for this frame.
+         */
+        void updateTransforms();
+
+        /**
+         * @return Nodes whose global matrix or joint palette changed during the last updateTransforms().
+         */
+        [[nodiscard]] const std::vector<Node *> &getChangedNodes() const {
+            return this->changedNodes;
+        }
+
+        /**
+         * Forgets the changes of the last updateTransforms(), used when an update is skipped.
+         */
+        void clearChangedNodes() {
+            this->changedNodes.clear();
+        }
+
+        /**
+         * Rebuilds the joint palette of every skin whose joints moved during the last updateTransforms().
+         */
         void updateJoints();
 
-        void updateJointsByNode(Node &node);
+        /**
+         * @return Joint palette in object space of the skin used by a skinned node, only updated in
+         * SkinningMode::LINEAR.
+         */
+        [[nodiscard]] const std::vector<glm::mat4> &getJointMatrices(const Node &node) const {
+            return this->skinLookup.at(node.skinIndex)->jointMatrices;
+        }
+
+        /**
+         * @return Joint palette as dual quaternions, only filled in SkinningMode::DUAL_QUATERNION.
+         */
+        [[nodiscard]] const std::vector<DualQuaternion> &getJointDualQuaternions(const Node &node) const {
+            return this->skinLookup.at(node.skinIndex)->jointDualQuaternions;
+        }
+
+        /**
+         * Copies the dual quaternion palette of a node into the node uniform of a SkinningMode::DUAL_QUATERNION
+         * pipeline, nodes without a skin get no joints. Throws when the skin does not build dual quaternions.
+         */
+        void fillDualQuaternionBufferObject(const Node &node, DualQuaternionBufferObject &bufferObject) const;
+
+        /**
+         * Selects which palette the skins of this object build, only the palette of that mode is kept up to date.
+         */
+        void setSkinningMode(SkinningMode skinningMode);
+
+        /**
+         * Computes the bind pose bounds of every joint from the vertices it influences, including the reach of
+         * morph targets. Must be called once the vertices and nodes are loaded.
+         */
+        void computeJointBounds();
+
+        /**
+         * @return Object space bounds of a skinned node in the current pose, updated by updateJoints().
+         */
+        [[nodiscard]] const BoundingBox &getSkinBounds(const Node &node) const {
+            return this->skinLookup.at(node.skinIndex)->bounds;
+        }
+
+        /**
+         * @return Union of the bounds of all skins in the current pose, empty when the object has no skins.
+         */
+        [[nodiscard]] BoundingBox getSkinnedBounds() const;
 
         [[nodiscard]] const Node & getNodeByIndex(uint32_t index) const {
             auto it = nodeLookup.find(index);
@@ -79,12 +151,31 @@ namespace pvk::gltf {
             return this->nodeLookup;
         }
 
-        void setNodeLookup(boost::container::flat_map<uint32_t, std::shared_ptr<Node>> newNodeLookup) {
-            this->nodeLookup = std::move(newNodeLookup);
-        }
+        void setNodeLookup(boost::container::flat_map<uint32_t, std::shared_ptr<Node>> newNodeLookup);
+
+        /**
+         * Uploads the vertices and indices into a geometry arena instead of buffers of the object and points the
+         * first index and vertex offset of every primitive at the allocation.
+         */
+        void placeInGeometryArena(vk::Queue &graphicsQueue, GeometryArena &geometryArena);
+
+        /**
+         * @return Vertex buffer to bind for this object, the buffer of its geometry arena when it lives in one.
+         */
+        [[nodiscard]] vk::Buffer getVertexBuffer() const;
+
+        [[nodiscard]] vk::Buffer getIndexBuffer() const;
+
+        /**
+         * @return Layout of the vertex buffer, pushed to pipelines which pull their vertices.
+         */
+        [[nodiscard]] VertexLayout getVertexLayout() const;
 
     private:
         boost::container::flat_map<uint32_t, std::shared_ptr<Node>> nodeLookup;
+        std::vector<Node *> nodesByHierarchyIndex;
+        std::vector<Node *> skinnedNodes;
+        std::vector<Node *> changedNodes;
     };
 }  // namespace pvk::gltf
 
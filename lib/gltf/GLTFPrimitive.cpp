@@ -12,7 +12,8 @@ namespace pvk::gltf
 Primitive::Primitive() = default;
 
 Primitive::Primitive(uint32_t startVertex, uint32_t startIndex, uint32_t vertexCount, uint32_t indexCount)
-    : startIndex(startIndex), startVertex(startVertex), indexCount(indexCount), vertexCount(vertexCount)
+    : startIndex(startIndex), startVertex(startVertex), indexCount(indexCount), vertexCount(vertexCount),
+      firstIndex(startIndex)
 {
 }
 
@@ -38,6 +39,22 @@ uint32_t Primitive::getStartVertex() const
     return startVertex;
 }
 
+uint32_t Primitive::getFirstIndex() const
+{
+    return firstIndex;
+}
+
+int32_t Primitive::getVertexOffset() const
+{
+    return vertexOffset;
+}
+
+void Primitive::setGeometryOffsets(uint32_t newFirstIndex, int32_t newVertexOffset)
+{
+    firstIndex = newFirstIndex;
+    vertexOffset = newVertexOffset;
+}
+
 uint32_t Primitive::getIndexCount() const
 {
     return indexCount;
@@ -48,4 +65,40 @@ uint32_t Primitive::getVertexCount() const
     return vertexCount;
 }
 
+const std::vector<Meshlet> &Primitive::getMeshlets() const
+{
+    return meshlets;
+}
+
+void Primitive::setMeshlets(std::vector<Meshlet> &&newMeshlets)
+{
+    meshlets = std::move(newMeshlets);
+}
+
+uint32_t Primitive::getFirstMorphDelta() const
+{
+    return firstMorphDelta;
+}
+
+uint32_t Primitive::getNumberOfMorphTargets() const
+{
+    return numberOfMorphTargets;
+}
+
+void Primitive::setMorphTargets(uint32_t newFirstMorphDelta, uint32_t newNumberOfMorphTargets)
+{
+    firstMorphDelta = newFirstMorphDelta;
+    numberOfMorphTargets = newNumberOfMorphTargets;
+}
+
+const BoundingBox &Primitive::getBounds() const
+{
+    return bounds;
+}
+
+void Primitive::setBounds(const BoundingBox &newBounds)
+{
+    bounds = newBounds;
+}
+
 } // namespace pvk::gltf
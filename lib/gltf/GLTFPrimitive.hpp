@@ -16,7 +16,10 @@
 
 #include "../util/util.hpp"
 #include "Drawable.h"
+#include "GLTFBoundingBox.hpp"
 #include "GLTFMaterial.hpp"
+#include "GLTFMeshlet.hpp"
+#include "GLTFMorphTarget.hpp"
 
 namespace pvk::gltf
 {
@@ -45,6 +48,15 @@ class Primitive : public Drawable
     uint32_t startVertex{};
     uint32_t indexCount{};
     uint32_t vertexCount{};
+    // Where the indices and vertices of the primitive are drawn from, differs from the start index and vertex
+    // when the object lives in a GeometryArena.
+    uint32_t firstIndex{};
+    int32_t vertexOffset{};
+    std::vector<Meshlet> meshlets{};
+    uint32_t firstMorphDelta{};
+    uint32_t numberOfMorphTargets{};
+    // Local space bounds including the reach of all morph targets.
+    BoundingBox bounds{};
 
 public:
     [[nodiscard]] const Material &getMaterial() const;
@@ -53,6 +65,22 @@ public:
     [[nodiscard]] uint32_t getStartVertex() const;
     [[nodiscard]] uint32_t getIndexCount() const;
     [[nodiscard]] uint32_t getVertexCount() const;
+    /**
+     * @return First index in the bound index buffer, pass it to indexed draws instead of getStartIndex().
+     */
+    [[nodiscard]] uint32_t getFirstIndex() const;
+    /**
+     * @return Vertex offset of indexed draws, added to every index of the object.
+     */
+    [[nodiscard]] int32_t getVertexOffset() const;
+    void setGeometryOffsets(uint32_t newFirstIndex, int32_t newVertexOffset);
+    [[nodiscard]] const std::vector<Meshlet> &getMeshlets() const;
+    void setMeshlets(std::vector<Meshlet> &&newMeshlets);
+    [[nodiscard]] uint32_t getFirstMorphDelta() const;
+    [[nodiscard]] uint32_t getNumberOfMorphTargets() const;
+    void setMorphTargets(uint32_t newFirstMorphDelta, uint32_t newNumberOfMorphTargets);
+    [[nodiscard]] const BoundingBox &getBounds() const;
+    void setBounds(const BoundingBox &newBounds);
     [[nodiscard]] constexpr DrawableType getType() const override {
         return DrawableType::DRAWABLE_PRIMITIVE;
     }
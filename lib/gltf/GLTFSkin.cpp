@@ -2,3 +2,88 @@
 // Created by Christian aan de Wiel on 30/01/2021.
 //
 
+#include "GLTFSkin.hpp"
+
+#include <algorithm>
+#include <glm/gtc/quaternion.hpp>
+
+namespace pvk::gltf {
+    DualQuaternion DualQuaternion::fromMatrix(const glm::mat4 &matrix) {
+        const auto rotation = glm::normalize(glm::quat_cast(glm::mat3(
+                glm::normalize(glm::vec3(matrix[0])),
+                glm::normalize(glm::vec3(matrix[1])),
+                glm::normalize(glm::vec3(matrix[2]))
+        )));
+        const auto dual = 0.5F * glm::quat(0.0F, glm::vec3(matrix[3])) * rotation;
+
+        return {
+                glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w),
+                glm::vec4(dual.x, dual.y, dual.z, dual.w)
+        };
+    }
+
+    glm::vec3 DualQuaternion::transformPoint(const glm::vec3 &point) const {
+        const auto realVector = glm::vec3(this->real);
+        const auto dualVector = glm::vec3(this->dual);
+        const auto rotated = point + 2.0F * glm::cross(realVector, glm::cross(realVector, point) + this->real.w * point);
+        const auto translation = 2.0F * (this->real.w * dualVector - this->dual.w * realVector +
+                                         glm::cross(realVector, dualVector));
+
+        return rotated + translation;
+    }
+
+    void Skin::resolveJoints(std::vector<uint32_t> newJointHierarchyIndices) {
+        this->jointHierarchyIndices = std::move(newJointHierarchyIndices);
+        this->jointMatrices.assign(this->jointHierarchyIndices.size(), glm::mat4(1.0F));
+        this->jointBounds.assign(this->jointHierarchyIndices.size(), {});
+        this->setSkinningMode(this->skinningMode);
+
+        if (this->inverseBindMatrices.empty()) {
+            // Inverse bind matrices are optional, without them every joint is bound with the identity.
+            this->inverseBindMatrices.assign(this->jointHierarchyIndices.size(), glm::mat4(1.0F));
+        }
+    }
+
+    void Skin::setSkinningMode(SkinningMode newSkinningMode) {
+        this->skinningMode = newSkinningMode;
+        // Only the palette of the previous mode is up to date.
+        this->hasChanged = true;
+
+        if (this->skinningMode == SkinningMode::DUAL_QUATERNION) {
+            this->jointDualQuaternions.resize(this->jointHierarchyIndices.size());
+        } else {
+            this->jointDualQuaternions.clear();
+        }
+    }
+
+    bool Skin::hasJointChanged(const Hierarchy &hierarchy) const {
+        return std::any_of(
+                this->jointHierarchyIndices.begin(),
+                this->jointHierarchyIndices.end(),
+                [&hierarchy](uint32_t jointHierarchyIndex) {
+                    return hierarchy.hasChanged(jointHierarchyIndex);
+                }
+        );
+    }
+
+    void Skin::updateJointMatrices(const Hierarchy &hierarchy) {
+        this->bounds = {};
+
+        const bool isDualQuaternion = this->skinningMode == SkinningMode::DUAL_QUATERNION;
+
+        for (size_t i = 0; i < this->jointHierarchyIndices.size(); i++) {
+            const auto jointMatrix =
+                    hierarchy.getWorldMatrix(this->jointHierarchyIndices[i]) * this->inverseBindMatrices[i];
+
+            if (isDualQuaternion) {
+                this->jointDualQuaternions[i] = DualQuaternion::fromMatrix(jointMatrix);
+            } else {
+                this->jointMatrices[i] = jointMatrix;
+            }
+
+            if (!this->jointBounds[i].isEmpty()) {
+                this->bounds.extend(this->jointBounds[i].transform(jointMatrix));
+            }
+        }
+    }
+}  // namespace pvk::gltf
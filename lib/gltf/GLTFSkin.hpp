@@ -5,14 +5,91 @@
 #ifndef PVK_GLTFSKIN_HPP
 #define PVK_GLTFSKIN_HPP
 
+#include <cstddef>
 #include <glm/glm.hpp>
+#include "GLTFBoundingBox.hpp"
+#include "GLTFHierarchy.hpp"
 #include "GLTFNode.hpp"
 
 namespace pvk::gltf {
+    enum class SkinningMode {
+        LINEAR, DUAL_QUATERNION
+    };
+
+    /**
+     * Rigid joint transform as a unit dual quaternion, 32 bytes instead of the 64 of a matrix. Quaternions are
+     * stored as (x, y, z, w) so the layout matches two vec4 in a shader. Scale can not be represented and is
+     * dropped.
+     */
+    struct DualQuaternion {
+        glm::vec4 real{0.0F, 0.0F, 0.0F, 1.0F};
+        glm::vec4 dual{0.0F};
+
+        static DualQuaternion fromMatrix(const glm::mat4 &matrix);
+
+        [[nodiscard]] glm::vec3 transformPoint(const glm::vec3 &point) const;
+    };
+
+    /**
+     * Node uniform of pipelines in SkinningMode::DUAL_QUATERNION, has to match the BufferObject block of
+     * base_dq.vert. The palette takes half the space of the matrix palette in Node::bufferObject.
+     */
+    struct DualQuaternionBufferObject {
+        static constexpr size_t MAX_JOINTS = 256;
+
+        glm::mat4 model{1.0F};
+        glm::mat4 localMatrix{1.0F};
+        DualQuaternion jointDualQuaternions[MAX_JOINTS];
+        float jointCount = 0.0F;
+    };
+
+    // std140 places vec4 jointDualQuaternions[512] right after the matrices and jointCount right after the array.
+    static_assert(sizeof(DualQuaternion) == 2 * sizeof(glm::vec4));
+    static_assert(offsetof(DualQuaternionBufferObject, jointDualQuaternions) == 128);
+    static_assert(offsetof(DualQuaternionBufferObject, jointCount) == 128 + 512 * sizeof(glm::vec4));
+
     struct Skin {
         uint32_t skinIndex = 0;
         std::vector<glm::mat4> inverseBindMatrices;
         std::vector<uint32_t> jointsIndices;
+
+        // Hierarchy slots of the joints, resolved once the nodes of the object are known.
+        std::vector<uint32_t> jointHierarchyIndices;
+
+        // Joint palette in object space, only updated in SkinningMode::LINEAR. It is sized once, so updating it
+        // every frame does not allocate.
+        std::vector<glm::mat4> jointMatrices;
+
+        // Same palette as dual quaternions, only filled in SkinningMode::DUAL_QUATERNION.
+        std::vector<DualQuaternion> jointDualQuaternions;
+
+        SkinningMode skinningMode = SkinningMode::LINEAR;
+
+        // Bind pose bounds of the vertices each joint influences, empty for joints without vertices.
+        std::vector<BoundingBox> jointBounds;
+
+        // Object space bounds of the skinned vertices in the current pose, the union of the joint bounds
+        // transformed by the palette. Conservative, since every vertex lies inside the box of each of its joints.
+        BoundingBox bounds;
+
+        // Whether any joint moved during the last gltf::Object::updateTransforms().
+        bool hasChanged = true;
+
+        /**
+         * Stores the hierarchy slots of the joints and allocates the palette.
+         * @param newJointHierarchyIndices Hierarchy slot for every entry in jointsIndices.
+         */
+        void resolveJoints(std::vector<uint32_t> newJointHierarchyIndices);
+
+        [[nodiscard]] bool hasJointChanged(const Hierarchy &hierarchy) const;
+
+        void setSkinningMode(SkinningMode newSkinningMode);
+
+        /**
+         * Rebuilds the bounds and the palette of the skinning mode from the cached world matrices of the
+         * hierarchy, the palette of the other mode is left as it is.
+         */
+        void updateJointMatrices(const Hierarchy &hierarchy);
     };
 }
 
@@ -7,6 +7,7 @@
 #include <boost/container/flat_map.hpp>
 
 #include "GLTFLoaderAnimation.hpp"
+#include "../GLTFAnimationCompression.hpp"
 
 namespace {
     std::vector<float> loadAnimationInputs(
@@ -34,51 +35,39 @@ namespace {
         return inputs;
     }
 
-    std::vector<glm::vec4> loadAnimationOutputs(
+    std::vector<float> loadAnimationOutputs(
             const tinygltf::Model &model,
-            const tinygltf::AnimationSampler &sampler
+            const tinygltf::AnimationSampler &sampler,
+            uint32_t &numberOfComponents
     ) {
         const auto &accessor = model.accessors[sampler.output];
         const auto &bufferView = model.bufferViews[accessor.bufferView];
         const auto &buffer = model.buffers[bufferView.buffer];
         const void *bufferPointer = &buffer.data[accessor.byteOffset + bufferView.byteOffset];
 
-        std::vector<glm::vec4> outputs;
-        outputs.reserve(accessor.count);
-
         switch (accessor.type) {
             case TINYGLTF_TYPE_VEC3: {
-                const auto outputsSpan = std::span<const glm::vec3>(
-                        static_cast<const glm::vec3 *>(bufferPointer),
-                        bufferView.byteLength
-                );
-
-                for (const auto &output : outputsSpan) {
-                    outputs.emplace_back(glm::vec4(output, 0.0F));
-                }
-
+                numberOfComponents = 3;
                 break;
             }
             case TINYGLTF_TYPE_VEC4: {
-                const auto outputsSpan = std::span<const glm::vec4>(
-                        static_cast<const glm::vec4 *>(bufferPointer),
-                        bufferView.byteLength
-                );
-
-                for (const auto &output : outputsSpan) {
-                    outputs.emplace_back(output);
-                }
-
+                numberOfComponents = 4;
                 break;
             }
             case TINYGLTF_TYPE_SCALAR: {
+                numberOfComponents = 1;
                 break;
             }
             default:
                 throw std::runtime_error("Unsupported animation output type");
         }
 
-        return outputs;
+        const auto outputsSpan = std::span<const float>(
+                static_cast<const float *>(bufferPointer),
+                accessor.count * numberOfComponents
+        );
+
+        return {outputsSpan.begin(), outputsSpan.end()};
     }
 
     pvk::gltf::Sampler::InterpolationType getInterpolationType(
@@ -99,6 +88,54 @@ namespace {
         throw std::runtime_error("Unsupported animation interpolation type");
     }
 
+    /**
+     * glTF stores an in-tangent, value and out-tangent per keyframe. Regroup them per interval so evaluating one
+     * point on the spline only reads a single segment.
+     */
+    std::vector<pvk::gltf::CubicSegment> getCubicSegments(const pvk::gltf::Sampler &sampler) {
+        const auto numberOfComponents = sampler.numberOfComponents;
+        const auto numberOfKeyframes = sampler.inputs.size();
+
+        const auto getElement = [&](size_t keyframe, size_t element) {
+            glm::vec4 result(0.0F);
+            const auto *values = &sampler.outputs[(keyframe * 3 + element) * numberOfComponents];
+
+            for (uint32_t component = 0; component < numberOfComponents; component++) {
+                result[static_cast<glm::length_t>(component)] = values[component];
+            }
+
+            return result;
+        };
+
+        constexpr size_t inTangentElement = 0;
+        constexpr size_t valueElement = 1;
+        constexpr size_t outTangentElement = 2;
+
+        std::vector<pvk::gltf::CubicSegment> segments;
+
+        if (numberOfKeyframes == 1) {
+            const auto value = getElement(0, valueElement);
+            segments.push_back({value, glm::vec4(0.0F), glm::vec4(0.0F), value});
+
+            return segments;
+        }
+
+        segments.reserve(numberOfKeyframes - 1);
+
+        for (size_t i = 0; i + 1 < numberOfKeyframes; i++) {
+            const auto duration = sampler.inputs[i + 1] - sampler.inputs[i];
+
+            segments.push_back({
+                    getElement(i, valueElement),
+                    getElement(i, outTangentElement) * duration,
+                    getElement(i + 1, inTangentElement) * duration,
+                    getElement(i + 1, valueElement)
+            });
+        }
+
+        return segments;
+    }
+
     pvk::gltf::Sampler getAnimationSampler(
             const tinygltf::Model &model,
             const tinygltf::AnimationSampler &sampler
@@ -106,42 +143,115 @@ namespace {
         pvk::gltf::Sampler _sampler;
 
         _sampler.inputs = loadAnimationInputs(model, sampler);
-        _sampler.outputs = loadAnimationOutputs(model, sampler);
+        _sampler.outputs = loadAnimationOutputs(model, sampler, _sampler.numberOfComponents);
         _sampler.interpolationType = getInterpolationType(sampler);
 
+        const size_t numberOfElementsPerKeyframe =
+                _sampler.interpolationType == pvk::gltf::Sampler::CUBICSPLINE ? 3 : 1;
+
+        // Only morph weights are animated with scalars, every keyframe holds one weight per morph target.
+        const bool isMorphWeights = model.accessors[sampler.output].type == TINYGLTF_TYPE_SCALAR;
+
+        if (isMorphWeights && !_sampler.inputs.empty()) {
+            _sampler.numberOfComponents = static_cast<uint32_t>(
+                    _sampler.outputs.size() / (_sampler.inputs.size() * numberOfElementsPerKeyframe)
+            );
+        }
+        const auto numberOfExpectedOutputs =
+                _sampler.inputs.size() * numberOfElementsPerKeyframe * _sampler.numberOfComponents;
+
+        if (_sampler.inputs.empty() || _sampler.outputs.size() < numberOfExpectedOutputs) {
+            throw std::runtime_error("Animation sampler has fewer outputs than inputs");
+        }
+
+        if (_sampler.interpolationType == pvk::gltf::Sampler::CUBICSPLINE && !isMorphWeights) {
+            _sampler.segments = getCubicSegments(_sampler);
+            _sampler.outputs.clear();
+            _sampler.outputs.shrink_to_fit();
+        }
+
         return _sampler;
     }
 
     pvk::gltf::Channel getAnimationChannel(
             const tinygltf::AnimationChannel &channel,
-            const boost::container::flat_map<uint32_t, std::shared_ptr<pvk::gltf::Node>> &nodeLookup
+            const boost::container::flat_map<uint32_t, std::shared_ptr<pvk::gltf::Node>> &nodeLookup,
+            const pvk::gltf::Hierarchy &hierarchy,
+            const std::vector<pvk::gltf::Sampler> &samplers
     ) {
         pvk::gltf::Channel _channel;
+        uint32_t numberOfComponents = 3;
+        _channel.node = nodeLookup.at(channel.target_node)->getHierarchyIndex();
 
         if (channel.target_path == "rotation") {
             _channel.pathType = pvk::gltf::Channel::PathType::ROTATION;
+            numberOfComponents = 4;
         } else if (channel.target_path == "translation") {
             _channel.pathType = pvk::gltf::Channel::PathType::TRANSLATION;
         } else if (channel.target_path == "scale") {
             _channel.pathType = pvk::gltf::Channel::PathType::SCALE;
+        } else if (channel.target_path == "weights") {
+            _channel.pathType = pvk::gltf::Channel::PathType::WEIGHTS;
+            numberOfComponents = static_cast<uint32_t>(hierarchy.getMorphWeights(_channel.node).size());
         } else {
-            // @TODO: Implement weights later.
+            throw std::runtime_error("Unsupported animation channel path");
         }
 
         _channel.samplerIndex = channel.sampler;
-        _channel.node = nodeLookup.at(channel.target_node);
+
+        if (samplers.at(_channel.samplerIndex).numberOfComponents != numberOfComponents) {
+            throw std::runtime_error("Animation sampler output does not match channel path");
+        }
 
         return _channel;
     }
+
+    void compressSamplers(pvk::gltf::Animation &animation, const pvk::gltf::AnimationCompression &compression) {
+        std::vector<bool> isCompressed(animation.samplers.size(), false);
+
+        for (const auto &channel : animation.channels) {
+            if (isCompressed[channel.samplerIndex]) {
+                // Sampler is shared with another channel.
+                continue;
+            }
+
+            auto &sampler = animation.samplers[channel.samplerIndex];
+
+            switch (channel.pathType) {
+                case pvk::gltf::Channel::TRANSLATION:
+                    pvk::gltf::compression::reduceKeyframes(sampler, compression.translationTolerance);
+                    break;
+                case pvk::gltf::Channel::ROTATION:
+                    pvk::gltf::compression::reduceKeyframes(sampler, compression.rotationTolerance);
+                    break;
+                case pvk::gltf::Channel::SCALE:
+                    pvk::gltf::compression::reduceKeyframes(sampler, compression.scaleTolerance);
+                    break;
+                case pvk::gltf::Channel::WEIGHTS:
+                    // Morph weights are small compared to transforms and are kept as they are.
+                    isCompressed[channel.samplerIndex] = true;
+                    continue;
+            }
+
+            if (compression.isQuantized) {
+                pvk::gltf::compression::quantize(sampler);
+            }
+
+            isCompressed[channel.samplerIndex] = true;
+        }
+    }
 }  // namespace
 
 namespace pvk::gltf::loader::animation {
     std::unique_ptr<Animation> getAnimation(
             const tinygltf::Model &model,
             const tinygltf::Animation &animation,
-            const boost::container::flat_map<uint32_t, std::shared_ptr<Node>> &nodeLookup
+            const boost::container::flat_map<uint32_t, std::shared_ptr<Node>> &nodeLookup,
+            const std::shared_ptr<Hierarchy> &hierarchy,
+            const AnimationCompression &compression
     ) {
         auto _animation = std::make_unique<gltf::Animation>();
+        _animation->hierarchy = hierarchy;
         _animation->samplers.reserve(animation.samplers.size());
         _animation->channels.reserve(animation.channels.size());
 
@@ -150,9 +260,17 @@ namespace pvk::gltf::loader::animation {
         }
 
         for (const auto &channel : animation.channels) {
-            _animation->channels.emplace_back(getAnimationChannel(channel, nodeLookup));
+            _animation->channels.emplace_back(
+                    getAnimationChannel(channel, nodeLookup, *hierarchy, _animation->samplers)
+            );
         }
 
+        if (compression.isEnabled) {
+            compressSamplers(*_animation, compression);
+        }
+
+        _animation->prepare();
+
         _animation->currentTime = 0.0F;
         _animation->startTime = 0.0F;
         _animation->endTime = -1.0F;
@@ -13,7 +13,9 @@ namespace pvk::gltf::loader::animation {
     std::unique_ptr<Animation> getAnimation(
             const tinygltf::Model &model,
             const tinygltf::Animation &animation,
-            const boost::container::flat_map<uint32_t, std::shared_ptr<Node>> &nodeLookup
+            const boost::container::flat_map<uint32_t, std::shared_ptr<Node>> &nodeLookup,
+            const std::shared_ptr<Hierarchy> &hierarchy,
+            const AnimationCompression &compression
     );
 }  // namespace pvk::gltf::loader::animation
 
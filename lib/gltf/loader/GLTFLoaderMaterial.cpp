@@ -40,6 +40,7 @@ namespace pvk::gltf::loader::material {
         _material->materialFactor = {glm::make_vec4(material.pbrMetallicRoughness.baseColorFactor.data()),
                                      static_cast<float>(material.pbrMetallicRoughness.metallicFactor),
                                      static_cast<float>(material.pbrMetallicRoughness.roughnessFactor)};
+        _material->isTransparent = material.alphaMode == "BLEND";
 
         return _material;
     }
@@ -0,0 +1,166 @@
+//
+//  GLTFLoaderMeshlet.cpp
+//  PVK
+//
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <span>
+
+#include "GLTFLoaderMeshlet.hpp"
+
+namespace {
+    constexpr float MINIMUM_NORMAL_LENGTH = 1e-8F;
+
+    // Cones wider than roughly 84 degrees are practically never back-facing as a whole.
+    constexpr float MINIMUM_CONE_DOT = 0.1F;
+
+    void computeBoundingSphere(
+            const std::vector<pvk::Vertex> &vertices,
+            std::span<const uint32_t> indices,
+            pvk::gltf::Meshlet &meshlet
+    ) {
+        glm::vec3 minimum(std::numeric_limits<float>::max());
+        glm::vec3 maximum(std::numeric_limits<float>::lowest());
+
+        for (const auto index : indices) {
+            minimum = glm::min(minimum, vertices[index].pos);
+            maximum = glm::max(maximum, vertices[index].pos);
+        }
+
+        meshlet.center = (minimum + maximum) * 0.5F;
+        meshlet.radius = 0.0F;
+
+        for (const auto index : indices) {
+            meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[index].pos));
+        }
+    }
+
+    void computeNormalCone(
+            const std::vector<pvk::Vertex> &vertices,
+            std::span<const uint32_t> indices,
+            pvk::gltf::Meshlet &meshlet
+    ) {
+        std::array<glm::vec3, pvk::gltf::MESHLET_MAX_TRIANGLES> normals{};
+        size_t numberOfNormals = 0;
+        glm::vec3 normalSum(0.0F);
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const auto &a = vertices[indices[i]].pos;
+            const auto &b = vertices[indices[i + 1]].pos;
+            const auto &c = vertices[indices[i + 2]].pos;
+
+            auto normal = glm::cross(b - a, c - a);
+            const auto length = glm::length(normal);
+
+            if (length < MINIMUM_NORMAL_LENGTH) {
+                // Degenerate triangle, it does not contribute to the cone.
+                continue;
+            }
+
+            normal /= length;
+            normals[numberOfNormals++] = normal;
+            normalSum += normal;
+        }
+
+        const auto axisLength = glm::length(normalSum);
+
+        if (numberOfNormals == 0 || axisLength < MINIMUM_NORMAL_LENGTH) {
+            return;
+        }
+
+        const auto axis = normalSum / axisLength;
+        auto minimumDot = 1.0F;
+
+        for (size_t i = 0; i < numberOfNormals; i++) {
+            minimumDot = std::min(minimumDot, glm::dot(normals[i], axis));
+        }
+
+        if (minimumDot < MINIMUM_CONE_DOT) {
+            return;
+        }
+
+        // Store the sine of the cone's half angle, which is what the culling test compares against.
+        meshlet.coneAxis = axis;
+        meshlet.coneCutoff = std::sqrt(1.0F - minimumDot * minimumDot);
+    }
+}  // namespace
+
+namespace pvk::gltf::loader::meshlet {
+    std::vector<Meshlet> buildMeshlets(
+            const std::vector<Vertex> &vertices,
+            const std::vector<uint32_t> &indices,
+            const Primitive &primitive
+    ) {
+        std::vector<Meshlet> meshlets;
+
+        if (primitive.getIndexCount() < 3) {
+            return meshlets;
+        }
+
+        const auto startVertex = primitive.getStartVertex();
+        const auto startIndex = primitive.getStartIndex();
+        const auto endIndex = startIndex + primitive.getIndexCount();
+
+        // Holds for every vertex of the primitive the meshlet it was last added to.
+        std::vector<uint32_t> vertexMeshlet(primitive.getVertexCount(), std::numeric_limits<uint32_t>::max());
+
+        meshlets.reserve(primitive.getIndexCount() / (3 * MESHLET_MAX_TRIANGLES) + 1);
+
+        Meshlet meshlet{};
+        meshlet.startIndex = startIndex;
+
+        const auto countNewVertices = [&](uint32_t triangleStart) {
+            const auto currentMeshlet = static_cast<uint32_t>(meshlets.size());
+            uint32_t numberOfNewVertices = 0;
+
+            for (uint32_t i = 0; i < 3; i++) {
+                const auto index = indices[triangleStart + i];
+                const bool isDuplicate = (i > 0 && indices[triangleStart] == index) ||
+                                         (i > 1 && indices[triangleStart + 1] == index);
+
+                if (!isDuplicate && vertexMeshlet[index - startVertex] != currentMeshlet) {
+                    numberOfNewVertices++;
+                }
+            }
+
+            return numberOfNewVertices;
+        };
+
+        const auto finishMeshlet = [&]() {
+            const auto meshletIndices = std::span<const uint32_t>(&indices[meshlet.startIndex], meshlet.indexCount);
+            computeBoundingSphere(vertices, meshletIndices, meshlet);
+            computeNormalCone(vertices, meshletIndices, meshlet);
+
+            meshlets.emplace_back(meshlet);
+
+            meshlet = Meshlet{};
+            meshlet.startIndex = meshlets.back().startIndex + meshlets.back().indexCount;
+        };
+
+        for (auto i = startIndex; i + 2 < endIndex; i += 3) {
+            auto numberOfNewVertices = countNewVertices(i);
+
+            if (meshlet.vertexCount + numberOfNewVertices > MESHLET_MAX_VERTICES ||
+                meshlet.indexCount / 3 + 1 > MESHLET_MAX_TRIANGLES) {
+                finishMeshlet();
+                numberOfNewVertices = countNewVertices(i);
+            }
+
+            for (uint32_t j = 0; j < 3; j++) {
+                vertexMeshlet[indices[i + j] - startVertex] = static_cast<uint32_t>(meshlets.size());
+            }
+
+            meshlet.vertexCount += numberOfNewVertices;
+            meshlet.indexCount += 3;
+        }
+
+        if (meshlet.indexCount > 0) {
+            finishMeshlet();
+        }
+
+        return meshlets;
+    }
+}  // namespace pvk::gltf::loader::meshlet
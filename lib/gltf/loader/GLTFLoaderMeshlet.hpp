@@ -0,0 +1,32 @@
+//
+//  GLTFLoaderMeshlet.hpp
+//  PVK
+//
+
+#ifndef PVK_GLTFLOADERMESHLET_HPP
+#define PVK_GLTFLOADERMESHLET_HPP
+
+#include <vector>
+
+#include "../GLTFMeshlet.hpp"
+#include "../GLTFPrimitive.hpp"
+#include "../../mesh/vertex.hpp"
+
+namespace pvk::gltf::loader::meshlet {
+    /**
+     * Splits the triangles of a primitive into meshlets of at most MESHLET_MAX_VERTICES vertices and
+     * MESHLET_MAX_TRIANGLES triangles. Triangles are consumed in index buffer order, so every meshlet maps onto
+     * a contiguous range of the index buffer and no reordering of the indices is needed.
+     * @param vertices All vertices of the object.
+     * @param indices All indices of the object, already offset to the start vertex of their primitive.
+     * @param primitive Primitive to split into meshlets.
+     * @return Meshlets including bounding sphere and normal cone.
+     */
+    std::vector<Meshlet> buildMeshlets(
+            const std::vector<Vertex> &vertices,
+            const std::vector<uint32_t> &indices,
+            const Primitive &primitive
+    );
+}  // namespace pvk::gltf::loader::meshlet
+
+#endif //PVK_GLTFLOADERMESHLET_HPP
@@ -4,7 +4,14 @@
 
 #include "GLTFLoaderNode.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
 namespace {
+    constexpr char EXTENSION_MESH_GPU_INSTANCING[] = "EXT_mesh_gpu_instancing";
+
     glm::vec3 getTranslation(const tinygltf::Node &node) {
         constexpr uint8_t numberOfElementInTranslationVector = 3;
 
@@ -15,16 +22,16 @@ namespace {
         return glm::vec3(0.0F);
     }
 
-    glm::mat4 getRotation(const tinygltf::Node &node) {
+    glm::quat getRotation(const tinygltf::Node &node) {
         constexpr uint8_t numberOfElementInRotationVector = 4;
 
         if (node.rotation.size() == numberOfElementInRotationVector) {
             glm::quat quaternion = glm::make_quat(node.rotation.data());
 
-            return glm::mat4(quaternion);
+            return quaternion;
         }
 
-        return glm::mat4(1.0F);
+        return {1.0F, 0.0F, 0.0F, 0.0F};
     }
 
     glm::vec3 getScale(const tinygltf::Node &node) {
@@ -37,14 +44,10 @@ namespace {
         return glm::vec3(1.0F);
     }
 
-    glm::mat4 getOrientationMatrix(const tinygltf::Node &node) {
+    bool hasOrientationMatrix(const tinygltf::Node &node) {
         constexpr uint8_t numberOfElementInOrientationMatrix = 16;
 
-        if (node.matrix.size() == numberOfElementInOrientationMatrix) {
-            return glm::make_mat4x4(node.matrix.data());
-        }
-
-        return glm::mat4(1.0F);
+        return node.matrix.size() == numberOfElementInOrientationMatrix;
     }
 
     std::shared_ptr<pvk::gltf::Skin>
@@ -78,14 +81,126 @@ namespace {
         return result;
     }
 
+    /**
+     * Initial morph weights of a node, the weights of the node itself take precedence over those of its mesh.
+     */
+    std::vector<float> getMorphWeights(const tinygltf::Node &node, const tinygltf::Mesh &mesh, size_t numberOfTargets) {
+        if (node.weights.size() == numberOfTargets) {
+            return {node.weights.begin(), node.weights.end()};
+        }
+
+        if (mesh.weights.size() == numberOfTargets) {
+            return {mesh.weights.begin(), mesh.weights.end()};
+        }
+
+        return std::vector<float>(numberOfTargets, 0.0F);
+    }
+
+    /**
+     * Reads a float accessor of the given type, elements are returned tightly packed.
+     */
+    std::vector<float> readFloatAccessor(const tinygltf::Model &model, int accessorIndex, int type) {
+        const auto &accessor = model.accessors[accessorIndex];
+
+        if (accessor.type != type || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT ||
+            accessor.bufferView < 0) {
+            throw std::runtime_error("Instance attributes must be float accessors.");
+        }
+
+        const auto &bufferView = model.bufferViews[accessor.bufferView];
+        const auto numberOfComponents = static_cast<size_t>(tinygltf::GetNumComponentsInType(type));
+        const auto elementSize = numberOfComponents * sizeof(float);
+        const auto byteStride = std::max<size_t>(static_cast<size_t>(std::max(accessor.ByteStride(bufferView), 0)),
+                                                 elementSize);
+        const auto *data = &model.buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset];
+
+        std::vector<float> values(accessor.count * numberOfComponents);
+
+        for (size_t i = 0; i < accessor.count; i++) {
+            std::memcpy(&values[i * numberOfComponents], data + i * byteStride, elementSize);
+        }
+
+        return values;
+    }
+
+    /**
+     * Instance transforms of EXT_mesh_gpu_instancing. Only float attributes are supported, normalized integer
+     * rotations and scales are rejected.
+     */
+    std::vector<glm::mat4> getInstanceMatrices(const tinygltf::Model &model, const tinygltf::Node &node) {
+        const auto extension = node.extensions.find(EXTENSION_MESH_GPU_INSTANCING);
+
+        if (extension == node.extensions.end() || !extension->second.Has("attributes")) {
+            return {};
+        }
+
+        const auto &attributes = extension->second.Get("attributes");
+        const auto readAttribute = [&](const char *name, int type) -> std::vector<float> {
+            if (!attributes.Has(name)) {
+                return {};
+            }
+
+            return readFloatAccessor(model, attributes.Get(name).GetNumberAsInt(), type);
+        };
+
+        const auto translations = readAttribute("TRANSLATION", TINYGLTF_TYPE_VEC3);
+        const auto rotations = readAttribute("ROTATION", TINYGLTF_TYPE_VEC4);
+        const auto scales = readAttribute("SCALE", TINYGLTF_TYPE_VEC3);
+        const auto numberOfInstances = std::max({translations.size() / 3, rotations.size() / 4, scales.size() / 3});
+
+        if ((!translations.empty() && translations.size() != numberOfInstances * 3) ||
+            (!rotations.empty() && rotations.size() != numberOfInstances * 4) ||
+            (!scales.empty() && scales.size() != numberOfInstances * 3)) {
+            throw std::runtime_error("Instance attributes must have the same count.");
+        }
+
+        std::vector<glm::mat4> instanceMatrices(numberOfInstances, glm::mat4(1.0F));
+
+        for (size_t i = 0; i < numberOfInstances; i++) {
+            auto &matrix = instanceMatrices[i];
+
+            if (!translations.empty()) {
+                matrix = glm::translate(matrix, glm::make_vec3(&translations[i * 3]));
+            }
+
+            if (!rotations.empty()) {
+                // glTF stores quaternions as (x, y, z, w).
+                const auto *rotation = &rotations[i * 4];
+                matrix *= glm::mat4_cast(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]));
+            }
+
+            if (!scales.empty()) {
+                matrix = glm::scale(matrix, glm::make_vec3(&scales[i * 3]));
+            }
+        }
+
+        return instanceMatrices;
+    }
+
     std::shared_ptr<pvk::gltf::Node>
-    initializeNode(uint32_t nodeIndex, const std::shared_ptr<pvk::gltf::Node> &parent, const tinygltf::Node &node) {
+    initializeNode(uint32_t nodeIndex,
+                   const std::shared_ptr<pvk::gltf::Node> &parent,
+                   const tinygltf::Node &node,
+                   const std::shared_ptr<pvk::gltf::Hierarchy> &hierarchy) {
         auto resultNode = std::make_shared<pvk::gltf::Node>();
         resultNode->parent = parent;
         resultNode->skinIndex = node.skin;
         resultNode->nodeIndex = nodeIndex;
         resultNode->name = node.name;
 
+        // Parents are added before their children, which keeps the hierarchy in topological order.
+        const auto parentIndex = parent ? static_cast<int32_t>(parent->getHierarchyIndex())
+                                        : pvk::gltf::Hierarchy::NO_PARENT;
+        resultNode->setHierarchy(hierarchy, hierarchy->addNode(parentIndex));
+
+        if (hasOrientationMatrix(node)) {
+            resultNode->setMatrix(glm::make_mat4x4(node.matrix.data()));
+        } else {
+            resultNode->setTranslation(getTranslation(node));
+            resultNode->setRotation(getRotation(node));
+            resultNode->setScale(getScale(node));
+        }
+
         return resultNode;
     }
 
@@ -98,7 +213,7 @@ namespace {
             const std::shared_ptr<pvk::gltf::Node> &parent = nullptr
     ) {
         const auto &node = model->nodes[nodeIndex];
-        auto resultNode = initializeNode(nodeIndex, parent, node);
+        auto resultNode = initializeNode(nodeIndex, parent, node, object.hierarchy);
 
         // First load all children recursively
         resultNode->children.reserve(node.children.size());
@@ -109,11 +224,6 @@ namespace {
             );
         }
 
-        resultNode->translation = getTranslation(node);
-        resultNode->rotation = getRotation(node);
-        resultNode->scale = getScale(node);
-        resultNode->matrix = getOrientationMatrix(node);
-
         // Filter out all lights and cameras
         if (node.mesh == -1) {
             return resultNode;
@@ -122,12 +232,23 @@ namespace {
         auto &mesh = model->meshes[node.mesh];
 
         resultNode->mesh = std::make_unique<pvk::Mesh>();
+        resultNode->meshIndex = node.mesh;
+        resultNode->instanceMatrices = getInstanceMatrices(*model, node);
         resultNode->primitives.reserve(mesh.primitives.size());
 
         for (const auto &primitive : primitiveLookup[node.mesh]) {
             resultNode->primitives.emplace_back(primitive);
         }
 
+        // All primitives of a mesh have the same morph targets.
+        const auto numberOfMorphTargets = mesh.primitives.empty() ? 0 : mesh.primitives[0].targets.size();
+
+        if (numberOfMorphTargets > 0) {
+            object.hierarchy->addMorphWeights(
+                    resultNode->getHierarchyIndex(), getMorphWeights(node, mesh, numberOfMorphTargets)
+            );
+        }
+
         object.skinLookup[resultNode->skinIndex] = getSkin(*model, node);
 
         return resultNode;
@@ -5,6 +5,9 @@
 #include "GLTFLoaderVertex.hpp"
 #include "GLTFLoaderNode.hpp"
 
+#include <algorithm>
+#include <span>
+
 namespace {
     template<typename T>
     constexpr uint8_t getComponentType() {
@@ -172,6 +175,90 @@ namespace {
 
         return loadBuffer<glm::vec4>(model, primitive, FIELD_VERTEX_WEIGHTS_0, index);
     }
+
+    uint32_t readSparseIndex(const unsigned char *data, int componentType, size_t index) {
+        switch (componentType) {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+                return data[index];
+            }
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+                uint16_t result = 0;
+                std::memcpy(&result, data + index * sizeof(uint16_t), sizeof(uint16_t));
+                return result;
+            }
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+                uint32_t result = 0;
+                std::memcpy(&result, data + index * sizeof(uint32_t), sizeof(uint32_t));
+                return result;
+            }
+            default: {
+                throw std::runtime_error("Unsupported sparse accessor index type.");
+            }
+        }
+    }
+
+    /**
+     * Reads a float vec3 accessor into destination, sparse values are written on top of the dense values or on
+     * top of zeros when the accessor has no buffer view.
+     */
+    void loadVec3Accessor(const tinygltf::Model &model, int accessorIndex, std::span<glm::vec3> destination) {
+        const auto &accessor = model.accessors[accessorIndex];
+
+        if (accessor.type != TINYGLTF_TYPE_VEC3 || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
+            throw std::runtime_error("Morph target attributes must be float vec3.");
+        }
+
+        if (accessor.count > destination.size()) {
+            throw std::runtime_error("Morph target has more vertices than its primitive.");
+        }
+
+        if (accessor.bufferView > -1) {
+            const auto &bufferView = model.bufferViews[accessor.bufferView];
+            const auto byteStride = std::max<size_t>(
+                    static_cast<size_t>(std::max(accessor.ByteStride(bufferView), 0)), sizeof(glm::vec3)
+            );
+            const auto *data = &model.buffers[bufferView.buffer].data[accessor.byteOffset + bufferView.byteOffset];
+
+            for (size_t i = 0; i < accessor.count; i++) {
+                std::memcpy(&destination[i], data + i * byteStride, sizeof(glm::vec3));
+            }
+        }
+
+        if (!accessor.sparse.isSparse) {
+            return;
+        }
+
+        const auto &sparse = accessor.sparse;
+        const auto &indexView = model.bufferViews[sparse.indices.bufferView];
+        const auto &valueView = model.bufferViews[sparse.values.bufferView];
+        const auto *indexData = &model.buffers[indexView.buffer].data[indexView.byteOffset + sparse.indices.byteOffset];
+        const auto *valueData = &model.buffers[valueView.buffer].data[valueView.byteOffset + sparse.values.byteOffset];
+
+        for (size_t i = 0; i < static_cast<size_t>(sparse.count); i++) {
+            const auto index = readSparseIndex(indexData, sparse.indices.componentType, i);
+
+            if (index >= destination.size()) {
+                throw std::runtime_error("Sparse accessor index out of range.");
+            }
+
+            std::memcpy(&destination[index], valueData + i * sizeof(glm::vec3), sizeof(glm::vec3));
+        }
+    }
+
+    bool getAccessorBounds(const tinygltf::Model &model, int accessorIndex, glm::vec3 &minimum, glm::vec3 &maximum) {
+        const auto &accessor = model.accessors[accessorIndex];
+
+        if (accessor.minValues.size() != 3 || accessor.maxValues.size() != 3) {
+            return false;
+        }
+
+        for (glm::length_t i = 0; i < 3; i++) {
+            minimum[i] = static_cast<float>(accessor.minValues[i]);
+            maximum[i] = static_cast<float>(accessor.maxValues[i]);
+        }
+
+        return true;
+    }
 }  // namespace
 
 namespace pvk::gltf::loader::vertex {
@@ -193,4 +280,62 @@ namespace pvk::gltf::loader::vertex {
 
         return vertex;
     }
+
+    void loadMorphTargets(
+            const tinygltf::Model &model,
+            const tinygltf::Primitive &primitive,
+            size_t vertexCount,
+            std::vector<MorphDelta> &morphDeltas
+    ) {
+        std::vector<glm::vec3> positions(vertexCount);
+        std::vector<glm::vec3> normals(vertexCount);
+
+        morphDeltas.reserve(morphDeltas.size() + primitive.targets.size() * vertexCount);
+
+        for (const auto &target : primitive.targets) {
+            std::fill(positions.begin(), positions.end(), glm::vec3(0.0F));
+            std::fill(normals.begin(), normals.end(), glm::vec3(0.0F));
+
+            if (const auto it = target.find(FIELD_VERTEX_POSITION); it != target.end()) {
+                loadVec3Accessor(model, it->second, positions);
+            }
+
+            if (const auto it = target.find(FIELD_VERTEX_NORMAL); it != target.end()) {
+                loadVec3Accessor(model, it->second, normals);
+            }
+
+            for (size_t i = 0; i < vertexCount; i++) {
+                morphDeltas.push_back({positions[i], normals[i]});
+            }
+        }
+    }
+
+    BoundingBox getPositionBounds(const tinygltf::Model &model, const tinygltf::Primitive &primitive) {
+        BoundingBox bounds;
+        const auto it = primitive.attributes.find(FIELD_VERTEX_POSITION);
+
+        if (it == primitive.attributes.end() || !getAccessorBounds(model, it->second, bounds.minimum, bounds.maximum)) {
+            return {};
+        }
+
+        for (const auto &target : primitive.targets) {
+            const auto targetIt = target.find(FIELD_VERTEX_POSITION);
+            glm::vec3 minimumDelta;
+            glm::vec3 maximumDelta;
+
+            if (targetIt == target.end()) {
+                continue;
+            }
+
+            if (!getAccessorBounds(model, targetIt->second, minimumDelta, maximumDelta)) {
+                // Reach of this target is unknown, the caller falls back to the vertices.
+                return {};
+            }
+
+            bounds.minimum += glm::min(minimumDelta, glm::vec3(0.0F));
+            bounds.maximum += glm::max(maximumDelta, glm::vec3(0.0F));
+        }
+
+        return bounds;
+    }
 }  // namespace pvk::gltf::loader::vertex
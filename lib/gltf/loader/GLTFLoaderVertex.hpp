@@ -16,6 +16,8 @@
 #include <tiny_gltf/tiny_gltf.h>
 #include <glm/glm.hpp>
 #include "GLTFLoaderNode.hpp"
+#include "../GLTFBoundingBox.hpp"
+#include "../GLTFMorphTarget.hpp"
 
 namespace pvk::gltf::loader::vertex {
     Vertex
@@ -24,6 +26,24 @@ namespace pvk::gltf::loader::vertex {
             const tinygltf::Primitive &primitive,
             uint32_t index
     );
+
+    /**
+     * Appends the position and normal deltas of all morph targets of a primitive, target after target. Sparse
+     * accessors are expanded, attributes missing from a target are stored as zero.
+     */
+    void loadMorphTargets(
+            const tinygltf::Model &model,
+            const tinygltf::Primitive &primitive,
+            size_t vertexCount,
+            std::vector<MorphDelta> &morphDeltas
+    );
+
+    /**
+     * Reads the bounds of a primitive from the min and max of its POSITION accessor. Morph targets grow the box
+     * by the min and max of their position deltas, which is conservative for weights between zero and one.
+     * @return Empty box when the accessor has no min and max.
+     */
+    BoundingBox getPositionBounds(const tinygltf::Model &model, const tinygltf::Primitive &primitive);
 }  // namespace pvk::gltf::loader::vertex
 
 #endif //PVK_GLTFLOADERVERTEX_HPP
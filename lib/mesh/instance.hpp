@@ -0,0 +1,56 @@
+//
+//  instance.hpp
+//  PVK
+//
+
+#ifndef PVK_INSTANCE_HPP
+#define PVK_INSTANCE_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+namespace pvk {
+    /**
+     * Per-instance vertex data, bound to binding 1 of pipelines whose definition sets "instanced".
+     */
+    struct Instance {
+        static constexpr uint32_t BINDING = 1;
+        static constexpr uint32_t FIRST_LOCATION = 7;
+
+        glm::mat4 transform{1.0F};
+
+        // Animation state of instances drawn from baked animations.
+        uint32_t clip = 0;
+        float timeOffset = 0.0F;
+
+        static std::vector<vk::VertexInputBindingDescription> getBindingDescription() {
+            return {{BINDING, sizeof(Instance), vk::VertexInputRate::eInstance}};
+        }
+
+        static std::vector<vk::VertexInputAttributeDescription> getAttributeDescriptions() {
+            std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+
+            // A mat4 attribute occupies one location per column.
+            for (uint32_t i = 0; i < 4; i++) {
+                attributeDescriptions.emplace_back(
+                        FIRST_LOCATION + i,
+                        BINDING,
+                        vk::Format::eR32G32B32A32Sfloat,
+                        static_cast<uint32_t>(offsetof(Instance, transform) + sizeof(glm::vec4) * i)
+                );
+            }
+
+            attributeDescriptions.emplace_back(
+                    FIRST_LOCATION + 4, BINDING, vk::Format::eR32Uint, offsetof(Instance, clip)
+            );
+            attributeDescriptions.emplace_back(
+                    FIRST_LOCATION + 5, BINDING, vk::Format::eR32Sfloat, offsetof(Instance, timeOffset)
+            );
+
+            return attributeDescriptions;
+        }
+    };
+}  // namespace pvk
+
+#endif //PVK_INSTANCE_HPP
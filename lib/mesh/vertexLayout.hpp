@@ -0,0 +1,58 @@
+//
+//  vertexLayout.hpp
+//  PVK
+//
+
+#ifndef PVK_VERTEXLAYOUT_HPP
+#define PVK_VERTEXLAYOUT_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include "vertex.hpp"
+
+namespace pvk {
+    /**
+     * Tells a vertex pulling shader where the attributes of a vertex format are, pushed per draw to pipelines whose
+     * definition sets "vertexPulling". The stride and offsets count 4-byte words, attributes the format does not
+     * have are ABSENT and read as zero.
+     */
+    struct VertexLayout {
+        static constexpr uint32_t ABSENT = ~0U;
+
+        uint32_t stride = 0;
+        uint32_t position = ABSENT;
+        uint32_t color = ABSENT;
+        uint32_t normal = ABSENT;
+        uint32_t UV0 = ABSENT;
+        uint32_t UV1 = ABSENT;
+        uint32_t joint = ABSENT;
+        uint32_t weight = ABSENT;
+
+        bool operator==(const VertexLayout &other) const = default;
+
+        /**
+         * @return Layout of pvk::Vertex, which all loaders produce.
+         */
+        static VertexLayout fromVertex() {
+            constexpr auto word = static_cast<uint32_t>(sizeof(float));
+
+            return {
+                    static_cast<uint32_t>(sizeof(Vertex)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, pos)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, color)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, normal)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, UV0)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, UV1)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, joint)) / word,
+                    static_cast<uint32_t>(offsetof(Vertex, weight)) / word,
+            };
+        }
+    };
+
+    // Has to match the push constants of shaders/pulled.vert.
+    static_assert(sizeof(VertexLayout) == 8 * sizeof(uint32_t));
+    static_assert(sizeof(Vertex) % sizeof(float) == 0);
+}  // namespace pvk
+
+#endif //PVK_VERTEXLAYOUT_HPP
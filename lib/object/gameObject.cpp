@@ -10,7 +10,8 @@ namespace pvk::object {
             std::vector<Vertex> &vertices,
             std::vector<uint32_t> &indices
     ) : m_vertices(std::move(vertices)), m_indices(std::move(indices)) {
-        auto vertexBuffer = buffer::vertex::create(this->m_vertices);
+        // Pipelines which pull their vertices read them as a storage buffer.
+        auto vertexBuffer = buffer::vertex::create(this->m_vertices, vk::BufferUsageFlagBits::eStorageBuffer);
         this->m_vertexBuffer = std::move(vertexBuffer.first);
         this->m_vertexBufferMemory = std::move(vertexBuffer.second);
 
@@ -19,6 +20,15 @@ namespace pvk::object {
         this->m_indexBufferMemory = std::move(indexBuffer.second);
     }
 
+    Mesh::Mesh(
+            std::vector<Vertex> &vertices,
+            std::vector<uint32_t> &indices,
+            vk::Queue &graphicsQueue,
+            GeometryArena &geometryArena
+    ) : m_vertices(std::move(vertices)), m_indices(std::move(indices)) {
+        this->m_geometryAllocation = geometryArena.allocate(graphicsQueue, this->m_vertices, this->m_indices);
+    }
+
     const std::vector<Vertex> &Mesh::getVertices() const {
         return this->m_vertices;
     }
@@ -28,6 +38,10 @@ namespace pvk::object {
     }
 
     const vk::Buffer &Mesh::getVertexBuffer() const {
+        if (this->m_geometryAllocation.isValid()) {
+            return this->m_geometryAllocation.getArena().getVertexBuffer();
+        }
+
         return this->m_vertexBuffer.get();
     }
 
@@ -36,6 +50,10 @@ namespace pvk::object {
     }
 
     const vk::Buffer &Mesh::getIndexBuffer() const {
+        if (this->m_geometryAllocation.isValid()) {
+            return this->m_geometryAllocation.getArena().getIndexBuffer();
+        }
+
         return this->m_indexBuffer.get();
     }
 
@@ -43,6 +61,18 @@ namespace pvk::object {
         return this->m_indexBufferMemory.get();
     }
 
+    uint32_t Mesh::getFirstIndex() const {
+        return this->m_geometryAllocation.getFirstIndex();
+    }
+
+    int32_t Mesh::getVertexOffset() const {
+        return static_cast<int32_t>(this->m_geometryAllocation.getFirstVertex());
+    }
+
+    VertexLayout Mesh::getVertexLayout() const {
+        return VertexLayout::fromVertex();
+    }
+
     GameObject::GameObject(
             std::unique_ptr<Mesh> mesh,
             std::unique_ptr<Transform> transform
@@ -8,13 +8,23 @@
 #include <vector>
 #include <vulkan/vulkan.hpp>
 
+#include "../buffer/geometryArena.hpp"
 #include "../mesh/vertex.hpp"
+#include "../mesh/vertexLayout.hpp"
 
 namespace pvk::object {
     class Mesh {
     public:
         Mesh(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices);
 
+        /**
+         * Places the mesh in a geometry arena instead of buffers of its own.
+         */
+        Mesh(std::vector<Vertex> &vertices,
+             std::vector<uint32_t> &indices,
+             vk::Queue &graphicsQueue,
+             GeometryArena &geometryArena);
+
         Mesh(const Mesh &other) = delete;
 
         Mesh(Mesh &&other) = default;
@@ -37,6 +47,12 @@ namespace pvk::object {
 
         [[nodiscard]] const vk::DeviceMemory &getIndexBufferMemory() const;
 
+        [[nodiscard]] uint32_t getFirstIndex() const;
+
+        [[nodiscard]] int32_t getVertexOffset() const;
+
+        [[nodiscard]] VertexLayout getVertexLayout() const;
+
     private:
         std::vector<Vertex> m_vertices;
         std::vector<uint32_t> m_indices;
@@ -44,6 +60,7 @@ namespace pvk::object {
         vk::UniqueDeviceMemory m_vertexBufferMemory;
         vk::UniqueBuffer m_indexBuffer;
         vk::UniqueDeviceMemory m_indexBufferMemory;
+        GeometryArena::Allocation m_geometryAllocation;
     };
 
     class Transform {
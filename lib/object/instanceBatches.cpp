@@ -0,0 +1,106 @@
+//
+//  instanceBatches.cpp
+//  PVK
+//
+
+#include "instanceBatches.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include "../buffer/buffer.hpp"
+#include "../context/context.hpp"
+
+namespace {
+    bool isInstanceable(const pvk::gltf::Node &node) {
+        if (!node.mesh || node.meshIndex < 0 || node.skinIndex > -1 || node.primitives.empty()) {
+            return false;
+        }
+
+        return std::none_of(node.primitives.begin(), node.primitives.end(), [](const auto &primitive) {
+            return primitive->getNumberOfMorphTargets() > 0;
+        });
+    }
+}  // namespace
+
+namespace pvk::object {
+    InstanceBatches::InstanceBatches(const gltf::Object &newObject) : object(newObject) {
+        // Ordered by mesh index, so batches come out in the same order on every load.
+        std::map<int32_t, std::vector<const gltf::Node *>> nodesByMesh;
+
+        for (const auto &[nodeIndex, node] : this->object.getNodes()) {
+            if (isInstanceable(*node)) {
+                nodesByMesh[node->meshIndex].push_back(node.get());
+            }
+        }
+
+        for (const auto &[meshIndex, nodes] : nodesByMesh) {
+            Batch batch{nodes.front(), static_cast<uint32_t>(this->instanceNodes.size()), 0};
+
+            for (const auto *node : nodes) {
+                if (node->instanceMatrices.empty()) {
+                    this->instanceNodes.push_back(node);
+                    this->instanceMatrices.emplace_back(1.0F);
+                }
+
+                for (const auto &instanceMatrix : node->instanceMatrices) {
+                    this->instanceNodes.push_back(node);
+                    this->instanceMatrices.push_back(instanceMatrix);
+                }
+
+                this->batchedNodes.insert(node);
+            }
+
+            batch.numberOfInstances = static_cast<uint32_t>(this->instanceNodes.size()) - batch.firstInstance;
+            this->batches.push_back(batch);
+        }
+
+        this->instances.resize(this->instanceNodes.size());
+
+        const auto numberOfSwapChainImages = Context::getNumberOfSwapChainImages();
+
+        this->instanceBuffers.resize(numberOfSwapChainImages);
+        this->instanceBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedInstances.resize(numberOfSwapChainImages);
+
+        for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+            this->mappedInstances[i] = static_cast<Instance *>(buffer::createMapped(
+                    sizeof(Instance) * std::max<size_t>(this->instances.size(), 1),
+                    // Also read by the GPU culling pass.
+                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+                    this->instanceBuffers[i],
+                    this->instanceBufferMemories[i]
+            ));
+        }
+    }
+
+    InstanceBatches::~InstanceBatches() {
+        for (auto &memory : this->instanceBufferMemories) {
+            Context::getLogicalDevice().unmapMemory(memory.get());
+        }
+    }
+
+    void InstanceBatches::update(uint32_t swapChainIndex) {
+        for (size_t i = 0; i < this->instances.size(); i++) {
+            this->instances[i].transform = this->instanceNodes[i]->getGlobalMatrix() * this->instanceMatrices[i];
+        }
+
+        std::copy(this->instances.begin(), this->instances.end(), this->mappedInstances.at(swapChainIndex));
+    }
+
+    std::span<const InstanceBatches::Batch> InstanceBatches::getBatches() const {
+        return this->batches;
+    }
+
+    std::span<const Instance> InstanceBatches::getInstances() const {
+        return this->instances;
+    }
+
+    vk::Buffer InstanceBatches::getInstanceBuffer(uint32_t swapChainIndex) const {
+        return this->instanceBuffers.at(swapChainIndex).get();
+    }
+
+    bool InstanceBatches::isBatched(const gltf::Node &node) const {
+        return this->batchedNodes.contains(&node);
+    }
+}  // namespace pvk::object
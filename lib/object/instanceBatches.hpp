@@ -0,0 +1,79 @@
+//
+//  instanceBatches.hpp
+//  PVK
+//
+
+#ifndef PVK_INSTANCEBATCHES_HPP
+#define PVK_INSTANCEBATCHES_HPP
+
+#include <span>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "../gltf/GLTFObject.hpp"
+#include "../mesh/instance.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::object {
+    /**
+     * Groups the nodes of an object which reference the same glTF mesh into one instanced draw per primitive.
+     * Every node contributes its world matrix, or one world matrix per instance when it uses
+     * EXT_mesh_gpu_instancing, so a forest of identical meshes is a single draw.
+     *
+     * Skinned and morphed nodes are left out, their vertices differ per node. Batched nodes should not be drawn
+     * individually as well, see isBatched().
+     */
+    class InstanceBatches : util::NoCopy {
+    public:
+        struct Batch {
+            // First node of the batch, its descriptor sets are bound for the whole batch.
+            const gltf::Node *node = nullptr;
+            uint32_t firstInstance = 0;
+            uint32_t numberOfInstances = 0;
+        };
+
+        explicit InstanceBatches(const gltf::Object &newObject);
+
+        ~InstanceBatches();
+
+        InstanceBatches(InstanceBatches &&other) = delete;
+
+        InstanceBatches &operator=(InstanceBatches &&other) = delete;
+
+        /**
+         * Writes the instance transforms of a swap chain image, must be called after the node transforms of the
+         * frame have been updated.
+         */
+        void update(uint32_t swapChainIndex);
+
+        [[nodiscard]] std::span<const Batch> getBatches() const;
+
+        /**
+         * @return Instances as of the last update(), the instances of a batch are adjacent.
+         */
+        [[nodiscard]] std::span<const Instance> getInstances() const;
+
+        [[nodiscard]] vk::Buffer getInstanceBuffer(uint32_t swapChainIndex) const;
+
+        [[nodiscard]] bool isBatched(const gltf::Node &node) const;
+
+    private:
+        const gltf::Object &object;
+
+        std::vector<Batch> batches;
+        std::vector<Instance> instances;
+        std::unordered_set<const gltf::Node *> batchedNodes;
+
+        // Node and transform relative to that node of every instance.
+        std::vector<const gltf::Node *> instanceNodes;
+        std::vector<glm::mat4> instanceMatrices;
+
+        std::vector<vk::UniqueBuffer> instanceBuffers;
+        std::vector<vk::UniqueDeviceMemory> instanceBufferMemories;
+        std::vector<Instance *> mappedInstances;
+    };
+}  // namespace pvk::object
+
+#endif //PVK_INSTANCEBATCHES_HPP
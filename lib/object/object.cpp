@@ -7,17 +7,63 @@
 
 #include "object.hpp"
 
+namespace
+{
+/**
+ * World space bounds of the primitives of a node, covering all EXT_mesh_gpu_instancing instances of the node.
+ */
+pvk::gltf::BoundingBox getWorldBounds(const pvk::gltf::Node &node)
+{
+    pvk::gltf::BoundingBox bounds;
+
+    for (const auto &primitive : node.primitives)
+    {
+        if (primitive->getBounds().isEmpty())
+        {
+            continue;
+        }
+
+        if (node.instanceMatrices.empty())
+        {
+            bounds.extend(primitive->getBounds().transform(node.getGlobalMatrix()));
+            continue;
+        }
+
+        for (const auto &instanceMatrix : node.instanceMatrices)
+        {
+            bounds.extend(primitive->getBounds().transform(node.getGlobalMatrix() * instanceMatrix));
+        }
+    }
+
+    return bounds;
+}
+} // namespace
+
 namespace pvk
 {
 Object::Object() = default;
 
 Object::~Object() = default;
 
-std::unique_ptr<Object> Object::createFromGLTF(vk::Queue &&graphicsQueue, const std::string &filename)
+std::unique_ptr<Object> Object::createFromGLTF(vk::Queue &&graphicsQueue,
+                                               const std::string &filename,
+                                               const gltf::AnimationCompression &animationCompression,
+                                               GeometryArena *geometryArena)
 {
     auto object = std::unique_ptr<Object>(new Object());
 
-    object->gltfObject = pvk::GLTFLoader::loadObject(graphicsQueue, filename);
+    object->gltfObject = pvk::GLTFLoader::loadObject(graphicsQueue, filename, animationCompression, geometryArena);
+
+    // Skinned primitives are covered by the bounds of their skin, which follow the pose.
+    for (const auto &[nodeIndex, node] : object->gltfObject->getNodes())
+    {
+        if (node->skinIndex < 0 && !node->primitives.empty())
+        {
+            object->staticNodeBounds[node.get()] = getWorldBounds(*node);
+        }
+    }
+
+    object->updateBoundingSphere();
 
     return object;
 }
@@ -44,4 +90,109 @@ gltf::Animation &Object::getAnimation(uint32_t animationIndex)
 {
     return *this->gltfObject->animations[animationIndex];
 }
+
+void Object::playAnimation(uint32_t animationIndex)
+{
+    if (animationIndex >= this->gltfObject->animations.size())
+    {
+        throw std::runtime_error("Animation index out of range.");
+    }
+
+    this->activeAnimation = animationIndex;
+}
+
+gltf::AnimationMixer &Object::getAnimationMixer()
+{
+    if (!this->animationMixer)
+    {
+        this->animationMixer = std::make_unique<gltf::AnimationMixer>(this->gltfObject->hierarchy);
+    }
+
+    return *this->animationMixer;
+}
+
+void Object::setAnimationUpdateInterval(uint32_t interval, uint32_t phase)
+{
+    if (interval == 0)
+    {
+        throw std::runtime_error("Animation update interval must be at least 1.");
+    }
+
+    this->animationUpdateInterval = interval;
+    this->animationUpdatePhase = phase % interval;
+}
+
+uint32_t Object::getAnimationUpdateInterval() const
+{
+    return this->animationUpdateInterval;
+}
+
+const glm::vec3 &Object::getBoundingCenter() const
+{
+    return this->boundingCenter;
+}
+
+float Object::getBoundingRadius() const
+{
+    return this->boundingRadius;
+}
+
+void Object::update(float deltaTime)
+{
+    const auto frame = this->animationFrame++;
+    this->skippedDeltaTime += deltaTime;
+
+    if ((frame + this->animationUpdatePhase) % this->animationUpdateInterval != 0)
+    {
+        // The last palette is reused, so there is nothing to upload either.
+        this->gltfObject->clearChangedNodes();
+        return;
+    }
+
+    deltaTime = this->skippedDeltaTime;
+    this->skippedDeltaTime = 0.0F;
+
+    if (this->animationMixer)
+    {
+        this->animationMixer->update(deltaTime);
+    }
+    else if (this->activeAnimation)
+    {
+        this->getAnimation(*this->activeAnimation).update(deltaTime);
+    }
+
+    this->gltfObject->updateTransforms();
+    this->gltfObject->updateJoints();
+    this->updateBoundingSphere();
+}
+
+void Object::updateBoundingSphere()
+{
+    for (const auto *node : this->gltfObject->getChangedNodes())
+    {
+        const auto it = this->staticNodeBounds.find(node);
+
+        if (it != this->staticNodeBounds.end())
+        {
+            it->second = getWorldBounds(*node);
+        }
+    }
+
+    gltf::BoundingBox bounds;
+
+    for (const auto &[node, nodeBounds] : this->staticNodeBounds)
+    {
+        bounds.extend(nodeBounds);
+    }
+
+    bounds.extend(this->gltfObject->getSkinnedBounds());
+
+    if (bounds.isEmpty())
+    {
+        return;
+    }
+
+    this->boundingCenter = bounds.getCenter();
+    this->boundingRadius = glm::length(bounds.getExtent());
+}
 } // namespace pvk
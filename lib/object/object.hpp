@@ -10,6 +10,8 @@
 
 
 #include <future>
+#include <map>
+#include <optional>
 #include <glm/glm.hpp>
 #include <string>
 #include <vulkan/vulkan.hpp>
@@ -21,7 +23,14 @@ namespace pvk
 class Object
 {
 public:
-    static auto createFromGLTF(vk::Queue &&graphicsQueue, const std::string &filename) -> std::unique_ptr<Object>;
+    /**
+     * @param geometryArena Arena shared with other static objects, skinned and morphed objects keep buffers of
+     *                      their own.
+     */
+    static auto createFromGLTF(vk::Queue &&graphicsQueue,
+                               const std::string &filename,
+                               const gltf::AnimationCompression &animationCompression = {},
+                               GeometryArena *geometryArena = nullptr) -> std::unique_ptr<Object>;
 
     ~Object();
 
@@ -29,6 +38,38 @@ public:
 
     [[nodiscard]] auto getAnimation(uint32_t animationIndex) -> gltf::Animation &;
 
+    /**
+     * Plays a single animation during update(), ignored once a mixer has been created.
+     */
+    void playAnimation(uint32_t animationIndex);
+
+    /**
+     * Mixer used during update() instead of a single animation, created on first access.
+     */
+    [[nodiscard]] auto getAnimationMixer() -> gltf::AnimationMixer &;
+
+    /**
+     * Per-frame update of the animation, node transforms and joint palettes. Only touches data owned by this
+     * object, so different objects can be updated concurrently.
+     */
+    void update(float deltaTime);
+
+    /**
+     * Runs the animation update only every interval-th call of update(), the skipped time is carried over to
+     * the next update. On skipped frames the last transforms and joint palettes stay in use and no node is
+     * reported as changed. Objects with a different phase are updated on different frames.
+     */
+    void setAnimationUpdateInterval(uint32_t interval, uint32_t phase = 0);
+
+    [[nodiscard]] auto getAnimationUpdateInterval() const -> uint32_t;
+
+    /**
+     * @return Center of a sphere around all vertices, skinned vertices are enclosed in their last updated pose.
+     */
+    [[nodiscard]] auto getBoundingCenter() const -> const glm::vec3 &;
+
+    [[nodiscard]] auto getBoundingRadius() const -> float;
+
     void updateUniformBuffer(void *data, size_t size, uint32_t descriptorSetIndex, uint32_t bindingIndex) const;
 
     template<typename Fn>
@@ -48,6 +89,27 @@ public:
         }
     }
 
+    /**
+     * Same as updateUniformBufferPerNode, but only for the nodes that changed during the last
+     * gltf::Object::updateTransforms().
+     */
+    template<typename Fn>
+    void updateUniformBufferPerChangedNode(
+        Fn &&function,
+        uint32_t descriptorSetIndex,
+        uint32_t bindingIndex) const
+    {
+        for (auto *node : this->gltfObject->getChangedNodes())
+        {
+            auto &uniformBuffersMemory = node->getUniformBuffersMemory(descriptorSetIndex, bindingIndex);
+
+            for (auto &uniformBufferMemory : uniformBuffersMemory)
+            {
+                function(*this->gltfObject, *node, uniformBufferMemory);
+            }
+        }
+    }
+
     template<typename Fn>
     void updateUniformBufferPerPrimitive(
         Fn &&function,
@@ -84,6 +146,22 @@ public:
 
 private:
     Object();
+
+    std::optional<uint32_t> activeAnimation;
+    std::unique_ptr<gltf::AnimationMixer> animationMixer;
+
+    uint32_t animationUpdateInterval = 1;
+    uint32_t animationUpdatePhase = 0;
+    uint32_t animationFrame = 0;
+    float skippedDeltaTime = 0.0F;
+
+    // World space bounds of each node without a skin, refreshed when the node is changed.
+    std::map<const gltf::Node *, gltf::BoundingBox> staticNodeBounds;
+
+    glm::vec3 boundingCenter{0.0F};
+    float boundingRadius = 0.0F;
+
+    void updateBoundingSphere();
 };
 } // namespace pvk
 
@@ -0,0 +1,29 @@
+//
+//  computePipeline.cpp
+//  PVK
+//
+
+#include "computePipeline.hpp"
+
+namespace pvk {
+    ComputePipeline::ComputePipeline(vk::UniquePipeline newVulkanPipeline,
+                                     vk::UniquePipelineLayout newPipelineLayout,
+                                     std::vector<vk::UniqueDescriptorSetLayout> newDescriptorSetLayouts)
+            : vulkanPipeline(std::move(newVulkanPipeline)),
+              pipelineLayout(std::move(newPipelineLayout)),
+              descriptorSetLayouts(std::move(newDescriptorSetLayouts)) {}
+
+    ComputePipeline::~ComputePipeline() = default;
+
+    const vk::UniquePipeline &ComputePipeline::getVulkanPipeline() const {
+        return this->vulkanPipeline;
+    }
+
+    const vk::UniquePipelineLayout &ComputePipeline::getPipelineLayout() const {
+        return this->pipelineLayout;
+    }
+
+    vk::DescriptorSetLayout ComputePipeline::getDescriptorSetLayout(uint32_t descriptorSetIndex) const {
+        return this->descriptorSetLayouts.at(descriptorSetIndex).get();
+    }
+}  // namespace pvk
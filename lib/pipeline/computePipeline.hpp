@@ -0,0 +1,51 @@
+//
+//  computePipeline.hpp
+//  PVK
+//
+
+#ifndef PVK_COMPUTEPIPELINE_HPP
+#define PVK_COMPUTEPIPELINE_HPP
+
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "../util/util.hpp"
+
+namespace pvk {
+    /**
+     * Compute pipeline created from a pipeline definition with a compute shader. Unlike pvk::Pipeline it does not
+     * manage descriptor sets per drawable, passes using it allocate their own sets from getDescriptorSetLayout().
+     */
+    class ComputePipeline : pvk::util::NoCopy {
+    public:
+        ComputePipeline(vk::UniquePipeline newVulkanPipeline,
+                        vk::UniquePipelineLayout newPipelineLayout,
+                        std::vector<vk::UniqueDescriptorSetLayout> newDescriptorSetLayouts);
+
+        ComputePipeline(ComputePipeline &&other) = default;
+
+        ComputePipeline &operator=(ComputePipeline &&other) = default;
+
+        ~ComputePipeline();
+
+        [[nodiscard]] const vk::UniquePipeline &getVulkanPipeline() const;
+
+        [[nodiscard]] const vk::UniquePipelineLayout &getPipelineLayout() const;
+
+        [[nodiscard]] vk::DescriptorSetLayout getDescriptorSetLayout(uint32_t descriptorSetIndex) const;
+
+        /**
+         * @return Number of work groups needed to cover all invocations, rounded up.
+         */
+        [[nodiscard]] static uint32_t getNumberOfWorkGroups(uint32_t numberOfInvocations, uint32_t workGroupSize) {
+            return (numberOfInvocations + workGroupSize - 1) / workGroupSize;
+        }
+
+    private:
+        vk::UniquePipeline vulkanPipeline;
+        vk::UniquePipelineLayout pipelineLayout;
+        std::vector<vk::UniqueDescriptorSetLayout> descriptorSetLayouts;
+    };
+}  // namespace pvk
+
+#endif //PVK_COMPUTEPIPELINE_HPP
@@ -7,8 +7,42 @@
 
 #include "pipeline.hpp"
 
+#include <utility>
+
 namespace pvk
 {
+Pipeline::VertexBufferRegistration::~VertexBufferRegistration()
+{
+    this->release();
+}
+
+Pipeline::VertexBufferRegistration::VertexBufferRegistration(VertexBufferRegistration &&other) noexcept
+    : pipeline(std::exchange(other.pipeline, nullptr)), vertexBuffer(other.vertexBuffer)
+{
+}
+
+Pipeline::VertexBufferRegistration &Pipeline::VertexBufferRegistration::operator=(
+    VertexBufferRegistration &&other) noexcept
+{
+    if (this != &other)
+    {
+        this->release();
+        this->pipeline = std::exchange(other.pipeline, nullptr);
+        this->vertexBuffer = other.vertexBuffer;
+    }
+
+    return *this;
+}
+
+void Pipeline::VertexBufferRegistration::release()
+{
+    if (this->pipeline != nullptr)
+    {
+        this->pipeline->releaseVertexBuffer(this->vertexBuffer);
+        this->pipeline = nullptr;
+    }
+}
+
 Pipeline::~Pipeline()
 {
     // Make sure we destroy the objects and textures before the rest of the pipeline.
@@ -29,6 +63,12 @@ Pipeline::~Pipeline()
 void Pipeline::registerObject(const std::shared_ptr<Object> &object)
 {
     this->objects.emplace_back(object);
+
+    if (this->skinningMode == gltf::SkinningMode::DUAL_QUATERNION)
+    {
+        // The shader of this pipeline reads dual quaternions, so make sure they are built.
+        object->gltfObject->setSkinningMode(this->skinningMode);
+    }
 }
 
 void Pipeline::registerTexture(const std::shared_ptr<Texture> &texture, uint8_t descriptorSetIndex, uint8_t binding)
@@ -45,9 +85,16 @@ void Pipeline::prepare()
 {
     initializeDescriptorPools();
 
+    this->objectVertexBuffers.clear();
+
     for (auto &object : this->objects)
     {
         initializeDescriptorSets(object);
+
+        if (this->isVertexPulling())
+        {
+            this->objectVertexBuffers.emplace_back(this->registerVertexBuffer(object->gltfObject->getVertexBuffer()));
+        }
     }
 
     Context::getLogicalDevice().updateDescriptorSets(getWriteDescriptorSets(), nullptr);
@@ -305,6 +352,132 @@ const vk::UniquePipelineLayout &Pipeline::getPipelineLayout() const
     return pipelineLayout;
 }
 
+vk::DescriptorSetLayout Pipeline::getDescriptorSetLayout(uint32_t descriptorSetIndex) const
+{
+    return this->descriptorSetLayouts.at(descriptorSetIndex).get();
+}
+
+gltf::SkinningMode Pipeline::getSkinningMode() const
+{
+    return this->skinningMode;
+}
+
+void Pipeline::setSkinningMode(gltf::SkinningMode newSkinningMode)
+{
+    this->skinningMode = newSkinningMode;
+}
+
+void Pipeline::setVertexPulling(vk::UniqueDescriptorSetLayout newVertexSetLayout, uint32_t newVertexSetIndex)
+{
+    this->vertexSetLayout = std::move(newVertexSetLayout);
+    this->vertexSetIndex = newVertexSetIndex;
+
+    vk::DescriptorPoolSize poolSize{vk::DescriptorType::eStorageBuffer, MAX_PULLED_VERTEX_BUFFERS};
+
+    this->vertexDescriptorPool = Context::getLogicalDevice().createDescriptorPoolUnique(
+        {vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, MAX_PULLED_VERTEX_BUFFERS, 1, &poolSize});
+}
+
+bool Pipeline::isVertexPulling() const
+{
+    return static_cast<bool>(this->vertexSetLayout);
+}
+
+uint32_t Pipeline::getVertexSetIndex() const
+{
+    return this->vertexSetIndex;
+}
+
+void Pipeline::bindVertices(const vk::CommandBuffer &commandBuffer,
+                            vk::Buffer vertexBuffer,
+                            const VertexLayout &vertexLayout) const
+{
+    if (!this->isVertexPulling())
+    {
+        commandBuffer.bindVertexBuffers(0, vertexBuffer, {0});
+        return;
+    }
+
+    const auto descriptorSet = this->vertexDescriptorSets.find(static_cast<VkBuffer>(vertexBuffer));
+
+    if (descriptorSet == this->vertexDescriptorSets.end())
+    {
+        throw std::runtime_error("The vertex buffer was not registered with the vertex pulling pipeline.");
+    }
+
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
+                                     this->pipelineLayout.get(),
+                                     this->vertexSetIndex,
+                                     descriptorSet->second.descriptorSet,
+                                     nullptr);
+    commandBuffer.pushConstants(
+        this->pipelineLayout.get(), vk::ShaderStageFlagBits::eVertex, 0, sizeof(VertexLayout), &vertexLayout);
+}
+
+Pipeline::VertexBufferRegistration Pipeline::registerVertexBuffer(vk::Buffer vertexBuffer)
+{
+    if (!this->isVertexPulling())
+    {
+        return {};
+    }
+
+    auto descriptorSet = this->vertexDescriptorSets.find(static_cast<VkBuffer>(vertexBuffer));
+
+    if (descriptorSet == this->vertexDescriptorSets.end())
+    {
+        if (this->vertexDescriptorSets.size() >= MAX_PULLED_VERTEX_BUFFERS)
+        {
+            throw std::runtime_error("Too many vertex buffers registered with a vertex pulling pipeline.");
+        }
+
+        const auto layout = this->vertexSetLayout.get();
+        const auto newDescriptorSet =
+            Context::getLogicalDevice().allocateDescriptorSets({this->vertexDescriptorPool.get(), 1, &layout}).front();
+
+        const vk::DescriptorBufferInfo bufferInfo{vertexBuffer, 0, VK_WHOLE_SIZE};
+        const vk::WriteDescriptorSet writeDescriptorSet{
+            newDescriptorSet, 0, 0, 1, vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfo};
+        Context::getLogicalDevice().updateDescriptorSets(writeDescriptorSet, nullptr);
+
+        descriptorSet = this->vertexDescriptorSets
+                            .emplace(static_cast<VkBuffer>(vertexBuffer), VertexDescriptorSet{newDescriptorSet})
+                            .first;
+    }
+
+    descriptorSet->second.numberOfRegistrations++;
+
+    return {this, vertexBuffer};
+}
+
+void Pipeline::releaseVertexBuffer(vk::Buffer vertexBuffer)
+{
+    const auto descriptorSet = this->vertexDescriptorSets.find(static_cast<VkBuffer>(vertexBuffer));
+
+    if (descriptorSet == this->vertexDescriptorSets.end() || --descriptorSet->second.numberOfRegistrations > 0)
+    {
+        return;
+    }
+
+    Context::getLogicalDevice().freeDescriptorSets(this->vertexDescriptorPool.get(),
+                                                   descriptorSet->second.descriptorSet);
+    this->vertexDescriptorSets.erase(descriptorSet);
+}
+
+size_t Pipeline::getNumberOfVertexBuffers() const
+{
+    return this->vertexDescriptorSets.size();
+}
+
+void Pipeline::setPushConstantRanges(std::vector<vk::PushConstantRange> &&newPushConstantRanges)
+{
+    this->pushConstantRanges = std::move(newPushConstantRanges);
+}
+
+const std::vector<vk::PushConstantRange> &Pipeline::getPushConstantRanges() const
+{
+    return this->pushConstantRanges;
+}
+
 void Pipeline::setDescriptorSetVisibilities(std::vector<DescriptorSetVisibility> &&newDescriptorSetVisibilities)
 {
     this->descriptorSetVisibilities = newDescriptorSetVisibilities;
@@ -20,6 +20,7 @@
 #include "../context/context.hpp"
 #include "../object/object.hpp"
 #include "../gltf/GLTFObject.hpp"
+#include "../mesh/vertexLayout.hpp"
 #include "../shader/shader.hpp"
 #include "../pipeline/pipelineBuilder.hpp"
 #include "../camera/camera.hpp"
@@ -28,12 +29,45 @@
 namespace pvk {
     class Pipeline : pvk::util::NoCopy {
     public:
+        /**
+         * Keeps the descriptor set of a vertex buffer alive for a vertex pulling pipeline, held by the owner of a
+         * buffer which is not part of an object registered with the pipeline. The set is freed when the last
+         * registration of the buffer is destroyed, so this has to happen before the buffer itself is destroyed. The
+         * pipeline has to outlive all of its registrations.
+         */
+        class VertexBufferRegistration {
+        public:
+            VertexBufferRegistration() = default;
+
+            ~VertexBufferRegistration();
+
+            VertexBufferRegistration(const VertexBufferRegistration &other) = delete;
+
+            VertexBufferRegistration &operator=(const VertexBufferRegistration &other) = delete;
+
+            VertexBufferRegistration(VertexBufferRegistration &&other) noexcept;
+
+            VertexBufferRegistration &operator=(VertexBufferRegistration &&other) noexcept;
+
+        private:
+            friend class Pipeline;
+
+            VertexBufferRegistration(Pipeline *newPipeline, vk::Buffer newVertexBuffer)
+                    : pipeline(newPipeline), vertexBuffer(newVertexBuffer) {};
+
+            void release();
+
+            Pipeline *pipeline = nullptr;
+            vk::Buffer vertexBuffer;
+        };
+
         Pipeline(vk::UniquePipeline vulkanPipeline, vk::UniquePipelineLayout pipelineLayout)
                 : vulkanPipeline(std::move(vulkanPipeline)), pipelineLayout(std::move(pipelineLayout)) {};
 
-        Pipeline(Pipeline &&other) = default;
+        // Vertex buffer registrations refer to the pipeline.
+        Pipeline(Pipeline &&other) = delete;
 
-        Pipeline &operator=(Pipeline &&other) = default;
+        Pipeline &operator=(Pipeline &&other) = delete;
 
         ~Pipeline();
 
@@ -68,6 +102,49 @@ namespace pvk {
 
         [[nodiscard]] const vk::UniquePipelineLayout &getPipelineLayout() const;
 
+        [[nodiscard]] vk::DescriptorSetLayout getDescriptorSetLayout(uint32_t descriptorSetIndex) const;
+
+        [[nodiscard]] gltf::SkinningMode getSkinningMode() const;
+
+        void setSkinningMode(gltf::SkinningMode newSkinningMode);
+
+        /**
+         * Makes the pipeline pull its vertices: vertex buffers are bound as a storage buffer in the set after the
+         * sets of the definition and the VertexLayout of the draw is pushed as push constants.
+         */
+        void setVertexPulling(vk::UniqueDescriptorSetLayout newVertexSetLayout, uint32_t newVertexSetIndex);
+
+        [[nodiscard]] bool isVertexPulling() const;
+
+        [[nodiscard]] uint32_t getVertexSetIndex() const;
+
+        /**
+         * Binds the vertices of the following draws, as vertex buffer or, when pulling, as storage buffer. Must be
+         * called after the pipeline itself has been bound. Only reads the pipeline, so command buffers can be
+         * recorded with it in parallel.
+         * @throws std::runtime_error When pulling from a vertex buffer which has not been registered.
+         */
+        void bindVertices(const vk::CommandBuffer &commandBuffer,
+                          vk::Buffer vertexBuffer,
+                          const VertexLayout &vertexLayout) const;
+
+        /**
+         * Creates the descriptor set a vertex pulling pipeline binds a vertex buffer with. prepare() does this for
+         * the vertex buffers of all registered objects, other buffers have to be registered by their owner. Must
+         * not be called while command buffers are recorded with the pipeline. Does nothing for pipelines which do
+         * not pull their vertices.
+         * @throws std::runtime_error When MAX_PULLED_VERTEX_BUFFERS buffers are registered already.
+         */
+        [[nodiscard]] VertexBufferRegistration registerVertexBuffer(vk::Buffer vertexBuffer);
+
+        [[nodiscard]] size_t getNumberOfVertexBuffers() const;
+
+        void setPushConstantRanges(std::vector<vk::PushConstantRange> &&newPushConstantRanges);
+
+        [[nodiscard]] const std::vector<vk::PushConstantRange> &getPushConstantRanges() const;
+
+        static constexpr uint32_t MAX_PULLED_VERTEX_BUFFERS = 256;
+
     private:
         vk::UniquePipelineLayout pipelineLayout;
 
@@ -80,6 +157,27 @@ namespace pvk {
         std::unordered_map<uint8_t, std::unordered_map<uint8_t, size_t>> descriptorSetLayoutBindingSizesLookup;
         std::vector<vk::UniqueDescriptorPool> descriptorPools;
 
+        gltf::SkinningMode skinningMode = gltf::SkinningMode::LINEAR;
+
+        std::vector<vk::PushConstantRange> pushConstantRanges;
+
+        struct VertexDescriptorSet {
+            vk::DescriptorSet descriptorSet;
+            uint32_t numberOfRegistrations = 0;
+        };
+
+        vk::UniqueDescriptorSetLayout vertexSetLayout;
+        vk::UniqueDescriptorPool vertexDescriptorPool;
+        uint32_t vertexSetIndex = 0;
+
+        // Only changed outside of recording, keyed on buffers which are kept alive by a registration.
+        std::unordered_map<VkBuffer, VertexDescriptorSet> vertexDescriptorSets;
+        // Registrations of the vertex buffers of the registered objects, which the pipeline keeps alive itself.
+        // Declared last, so they are released while the sets and the pool still exist.
+        std::vector<VertexBufferRegistration> objectVertexBuffers;
+
+        void releaseVertexBuffer(vk::Buffer vertexBuffer);
+
     public:
         void setDescriptorSetVisibilities(std::vector<DescriptorSetVisibility> &&newDescriptorSetVisibilities);
 
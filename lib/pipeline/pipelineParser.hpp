@@ -14,6 +14,9 @@
 
 #include "../context/context.hpp"
 #include "json.hpp"
+#include "../mesh/instance.hpp"
+#include "../mesh/vertexLayout.hpp"
+#include "computePipeline.hpp"
 #include "pipeline.hpp"
 
 using json = nlohmann::json;
@@ -22,12 +25,15 @@ namespace pvk {
     static const std::map<std::string, vk::DescriptorType> descriptorTypeMapping = {
             {"UNIFORM_BUFFER",         vk::DescriptorType::eUniformBuffer},
             {"COMBINED_IMAGE_SAMPLER", vk::DescriptorType::eCombinedImageSampler},
+            {"STORAGE_BUFFER",         vk::DescriptorType::eStorageBuffer},
+            {"STORAGE_IMAGE",          vk::DescriptorType::eStorageImage},
     };
 
     static const std::map<std::string, vk::ShaderStageFlags> shaderStageMapping = {
             {"VERTEX_AND_FRAGMENT", vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment},
             {"FRAGMENT",            vk::ShaderStageFlagBits::eFragment},
             {"VERTEX",              vk::ShaderStageFlagBits::eVertex},
+            {"COMPUTE",             vk::ShaderStageFlagBits::eCompute},
     };
 
     static const std::map<std::string, Pipeline::DescriptorSetVisibility> visibilityMapping = {
@@ -41,6 +47,11 @@ namespace pvk {
             {"FRONT", vk::CullModeFlagBits::eFront},
     };
 
+    static const std::map<std::string, gltf::SkinningMode> skinningModeMapping = {
+            {"LINEAR",          gltf::SkinningMode::LINEAR},
+            {"DUAL_QUATERNION", gltf::SkinningMode::DUAL_QUATERNION},
+    };
+
     struct DescriptorBinding {
         DescriptorBinding(std::string name,
                           uint8_t index,
@@ -66,6 +77,11 @@ namespace pvk {
     constexpr char FIELD_TYPE[] = "type";
     constexpr char FIELD_STAGE[] = "stage";
     constexpr char FIELD_CULLING_MODE[] = "cullingMode";
+    constexpr char FIELD_COMPUTE_SHADER[] = "computeShader";
+    constexpr char FIELD_PUSH_CONSTANT_SIZE[] = "pushConstantSize";
+    constexpr char FIELD_INSTANCED[] = "instanced";
+    constexpr char FIELD_SKINNING_MODE[] = "skinningMode";
+    constexpr char FIELD_VERTEX_PULLING[] = "vertexPulling";
 
     json parseDefinition(const std::string &filePath) {
         std::ifstream input(filePath);
@@ -109,17 +125,11 @@ namespace pvk {
         return result;
     }
 
-    std::unique_ptr<pvk::Pipeline> createPipelineFromDefinition(const std::string &filePath,
-                                                                vk::RenderPass &renderPass,
-                                                                vk::Extent2D &swapChainExtent) {
-        auto jsonContent = parseDefinition(filePath);
-        auto _descriptorSets = parseDescriptorSets(jsonContent);
-
-        // Create native Vulkan descriptor set layouts for all defined descriptor sets
-        std::vector<vk::UniqueDescriptorSetLayout> descriptorSetLayouts{};
-        std::vector<Pipeline::DescriptorSetVisibility> descriptorSetVisibilities;
-        std::vector<std::vector<vk::DescriptorSetLayoutBinding>> descriptorSetLayoutBindingsLookup;
-
+    void createDescriptorSetLayouts(
+            const std::vector<std::unique_ptr<DescriptorSet>> &_descriptorSets,
+            std::vector<vk::UniqueDescriptorSetLayout> &descriptorSetLayouts,
+            std::vector<Pipeline::DescriptorSetVisibility> &descriptorSetVisibilities,
+            std::vector<std::vector<vk::DescriptorSetLayoutBinding>> &descriptorSetLayoutBindingsLookup) {
         for (auto &_descriptorSet : _descriptorSets) {
             // First create all descriptor set layout bindings
             std::vector<vk::DescriptorSetLayoutBinding> descriptorSetLayoutBindings;
@@ -143,17 +153,68 @@ namespace pvk {
                     Context::getLogicalDevice().createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo));
             descriptorSetVisibilities.emplace_back(_descriptorSet->visibility);
         }
+    }
+
+    std::unique_ptr<pvk::Pipeline> createPipelineFromDefinition(const std::string &filePath,
+                                                                vk::RenderPass &renderPass,
+                                                                vk::Extent2D &swapChainExtent) {
+        auto jsonContent = parseDefinition(filePath);
+        auto _descriptorSets = parseDescriptorSets(jsonContent);
+
+        // Create native Vulkan descriptor set layouts for all defined descriptor sets
+        std::vector<vk::UniqueDescriptorSetLayout> descriptorSetLayouts{};
+        std::vector<Pipeline::DescriptorSetVisibility> descriptorSetVisibilities;
+        std::vector<std::vector<vk::DescriptorSetLayoutBinding>> descriptorSetLayoutBindingsLookup;
+        createDescriptorSetLayouts(
+                _descriptorSets, descriptorSetLayouts, descriptorSetVisibilities, descriptorSetLayoutBindingsLookup);
+
+        // Pipelines which pull their vertices read them from a storage buffer in a set after the defined sets
+        const bool isVertexPulling = jsonContent.value(FIELD_VERTEX_PULLING, false);
+        const auto vertexSetIndex = static_cast<uint32_t>(descriptorSetLayouts.size());
+        vk::UniqueDescriptorSetLayout vertexSetLayout;
+        std::vector<vk::PushConstantRange> pushConstantRanges;
+
+        if (isVertexPulling) {
+            const vk::DescriptorSetLayoutBinding vertexBinding{
+                    0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eVertex};
+            vk::DescriptorSetLayoutCreateInfo vertexSetLayoutCreateInfo{};
+            vertexSetLayoutCreateInfo.setBindings(vertexBinding);
+            vertexSetLayout = Context::getLogicalDevice().createDescriptorSetLayoutUnique(vertexSetLayoutCreateInfo);
+
+            pushConstantRanges.emplace_back(vk::ShaderStageFlagBits::eVertex, 0, sizeof(VertexLayout));
+        }
 
         // Create the pipeline layout
         vk::PipelineLayoutCreateInfo pipelineCreateInfo;
         auto rawDescriptorSetLayouts = vk::uniqueToRaw(descriptorSetLayouts);
+
+        if (isVertexPulling) {
+            rawDescriptorSetLayouts.push_back(vertexSetLayout.get());
+        }
+
         pipelineCreateInfo.setSetLayouts(rawDescriptorSetLayouts);
+        pipelineCreateInfo.setPushConstantRanges(pushConstantRanges);
         auto pipelineLayout = Context::getLogicalDevice().createPipelineLayoutUnique(pipelineCreateInfo);
 
         pvk::pipeline::Builder pipelineBuilder{renderPass, std::move(pipelineLayout)};
 
-        auto bindingDescriptions = pvk::Vertex::getBindingDescription();
-        auto attributeDescriptions = pvk::Vertex::getAttributeDescriptions();
+        // Without vertex input state one pipeline draws meshes of any vertex layout
+        std::vector<vk::VertexInputBindingDescription> bindingDescriptions;
+        std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+
+        if (!isVertexPulling) {
+            bindingDescriptions = pvk::Vertex::getBindingDescription();
+            attributeDescriptions = pvk::Vertex::getAttributeDescriptions();
+        }
+
+        if (jsonContent.value(FIELD_INSTANCED, false)) {
+            auto instanceBindingDescriptions = pvk::Instance::getBindingDescription();
+            auto instanceAttributeDescriptions = pvk::Instance::getAttributeDescriptions();
+            bindingDescriptions.insert(
+                    bindingDescriptions.end(), instanceBindingDescriptions.begin(), instanceBindingDescriptions.end());
+            attributeDescriptions.insert(
+                    attributeDescriptions.end(), instanceAttributeDescriptions.begin(), instanceAttributeDescriptions.end());
+        }
         pipelineBuilder.bindingDescriptions = bindingDescriptions;
         pipelineBuilder.attributeDescriptions = attributeDescriptions;
         std::vector<vk::Viewport> viewports = {
@@ -210,10 +271,75 @@ namespace pvk {
         pipeline->setDescriptorSetLayouts(std::move(descriptorSetLayouts));
         pipeline->setDescriptorSetLayoutBindingsLookup(std::move(descriptorSetLayoutBindingsLookup));
         pipeline->setDescriptorSetVisibilities(std::move(descriptorSetVisibilities));
+        pipeline->setPushConstantRanges(std::move(pushConstantRanges));
+
+        if (jsonContent.find(FIELD_SKINNING_MODE) != jsonContent.end()) {
+            pipeline->setSkinningMode(skinningModeMapping.at(jsonContent[FIELD_SKINNING_MODE].get<std::string>()));
+        }
+
+        if (isVertexPulling) {
+            pipeline->setVertexPulling(std::move(vertexSetLayout), vertexSetIndex);
+        }
 
         return pipeline;
     }
 
+    std::unique_ptr<pvk::ComputePipeline> createComputePipelineFromDefinition(const std::string &filePath) {
+        auto jsonContent = parseDefinition(filePath);
+        auto _descriptorSets = parseDescriptorSets(jsonContent);
+
+        if (jsonContent.find(FIELD_COMPUTE_SHADER) == jsonContent.end()) {
+            std::ostringstream exceptionMessage;
+            exceptionMessage << "Index " << FIELD_COMPUTE_SHADER << " not found in pipeline definition.";
+
+            throw std::runtime_error(exceptionMessage.str());
+        }
+
+        std::vector<vk::UniqueDescriptorSetLayout> descriptorSetLayouts{};
+        std::vector<Pipeline::DescriptorSetVisibility> descriptorSetVisibilities;
+        std::vector<std::vector<vk::DescriptorSetLayoutBinding>> descriptorSetLayoutBindingsLookup;
+        createDescriptorSetLayouts(
+                _descriptorSets, descriptorSetLayouts, descriptorSetVisibilities, descriptorSetLayoutBindingsLookup);
+
+        // Compute passes pass their per-dispatch parameters as push constants
+        std::vector<vk::PushConstantRange> pushConstantRanges;
+
+        if (jsonContent.find(FIELD_PUSH_CONSTANT_SIZE) != jsonContent.end()) {
+            pushConstantRanges.emplace_back(
+                    vk::ShaderStageFlagBits::eCompute, 0, jsonContent[FIELD_PUSH_CONSTANT_SIZE].get<uint32_t>());
+        }
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        auto rawDescriptorSetLayouts = vk::uniqueToRaw(descriptorSetLayouts);
+        pipelineLayoutCreateInfo.setSetLayouts(rawDescriptorSetLayouts);
+        pipelineLayoutCreateInfo.setPushConstantRanges(pushConstantRanges);
+        auto pipelineLayout = Context::getLogicalDevice().createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+        auto computeShaderContent = pvk::util::readFile(jsonContent[FIELD_COMPUTE_SHADER].get<std::string>());
+
+        vk::UniqueShaderModule computeShader = pvk::Context::getLogicalDevice().createShaderModuleUnique(
+                {vk::ShaderModuleCreateFlags(),
+                 computeShaderContent.size(),
+                 reinterpret_cast<const uint32_t *>(computeShaderContent.data())});
+
+        vk::PipelineShaderStageCreateInfo computeShaderStage;
+        computeShaderStage.setFlags(vk::PipelineShaderStageCreateFlags());
+        computeShaderStage.setStage(vk::ShaderStageFlagBits::eCompute);
+        computeShaderStage.setModule(computeShader.get());
+        computeShaderStage.setPName("main");
+
+        vk::ComputePipelineCreateInfo computePipelineCreateInfo;
+        computePipelineCreateInfo.setStage(computeShaderStage);
+        computePipelineCreateInfo.setLayout(pipelineLayout.get());
+
+        auto vulkanPipeline = Context::getLogicalDevice()
+                .createComputePipelineUnique(Context::getPipelineCache(), computePipelineCreateInfo).value;
+
+        return std::make_unique<ComputePipeline>(
+                std::move(vulkanPipeline), std::move(pipelineLayout), std::move(descriptorSetLayouts)
+        );
+    }
+
 } // namespace pvk
 
 #endif // PVK_PIPELINEPARSER_HPP
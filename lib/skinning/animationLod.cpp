@@ -0,0 +1,67 @@
+//
+//  animationLod.cpp
+//  PVK
+//
+
+#include "animationLod.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace pvk::skinning {
+    void AnimationLodScheduler::setProjection(float verticalFieldOfView, float viewportHeight) {
+        this->projectionScale = viewportHeight / (2.0F * std::tan(verticalFieldOfView * 0.5F));
+    }
+
+    void AnimationLodScheduler::setThresholds(float newFullRateSize, float newHalfRateSize) {
+        if (newHalfRateSize > newFullRateSize) {
+            throw std::runtime_error("Half rate size of the animation LOD must not exceed the full rate size.");
+        }
+
+        this->fullRateSize = newFullRateSize;
+        this->halfRateSize = newHalfRateSize;
+    }
+
+    float AnimationLodScheduler::getProjectedSize(const glm::vec3 &center, float radius,
+                                                  const glm::vec3 &cameraPosition) const {
+        const auto distance = glm::distance(center, cameraPosition);
+
+        if (distance <= radius) {
+            // Camera is inside the sphere.
+            return std::numeric_limits<float>::max();
+        }
+
+        return 2.0F * radius * this->projectionScale / distance;
+    }
+
+    uint32_t AnimationLodScheduler::getUpdateInterval(float projectedSize) const {
+        if (projectedSize >= this->fullRateSize) {
+            return 1;
+        }
+
+        if (projectedSize >= this->halfRateSize) {
+            return 2;
+        }
+
+        return MAXIMUM_UPDATE_INTERVAL;
+    }
+
+    void AnimationLodScheduler::schedule(const std::vector<std::shared_ptr<Object>> &objects,
+                                         const glm::vec3 &cameraPosition) const {
+        if (this->projectionScale <= 0.0F) {
+            return;
+        }
+
+        for (size_t i = 0; i < objects.size(); i++) {
+            auto &object = *objects[i];
+            const auto projectedSize = this->getProjectedSize(
+                    object.getBoundingCenter(), object.getBoundingRadius(), cameraPosition);
+            const auto interval = this->getUpdateInterval(projectedSize);
+
+            if (interval != object.getAnimationUpdateInterval()) {
+                object.setAnimationUpdateInterval(interval, static_cast<uint32_t>(i));
+            }
+        }
+    }
+}  // namespace pvk::skinning
@@ -0,0 +1,52 @@
+//
+//  animationLod.hpp
+//  PVK
+//
+
+#ifndef PVK_ANIMATIONLOD_HPP
+#define PVK_ANIMATIONLOD_HPP
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../object/object.hpp"
+
+namespace pvk::skinning {
+    /**
+     * Lowers the animation update rate of objects which are small on screen. Objects at least fullRateSize
+     * pixels high are animated every frame, those above halfRateSize every 2nd frame and all others every 4th
+     * frame. Objects sharing an interval are spread over the frames by their index, so the load stays even.
+     * Scheduling is disabled until a projection is set.
+     */
+    class AnimationLodScheduler {
+    public:
+        static constexpr uint32_t MAXIMUM_UPDATE_INTERVAL = 4;
+
+        void setProjection(float verticalFieldOfView, float viewportHeight);
+
+        void setThresholds(float newFullRateSize, float newHalfRateSize);
+
+        /**
+         * @return Height in pixels of a sphere seen from the camera position.
+         */
+        [[nodiscard]] float getProjectedSize(const glm::vec3 &center, float radius,
+                                             const glm::vec3 &cameraPosition) const;
+
+        [[nodiscard]] uint32_t getUpdateInterval(float projectedSize) const;
+
+        /**
+         * Assigns an update interval and phase to every object, must be called before the objects are updated.
+         */
+        void schedule(const std::vector<std::shared_ptr<Object>> &objects, const glm::vec3 &cameraPosition) const;
+
+    private:
+        // Viewport height divided by the height of the view volume at distance one.
+        float projectionScale = 0.0F;
+
+        float fullRateSize = 150.0F;
+        float halfRateSize = 50.0F;
+    };
+}  // namespace pvk::skinning
+
+#endif //PVK_ANIMATIONLOD_HPP
@@ -0,0 +1,168 @@
+//
+//  bakedAnimations.cpp
+//  PVK
+//
+
+#include "bakedAnimations.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+
+namespace {
+    constexpr uint32_t FILE_MAGIC = 0x4B414250;  // "PBAK"
+    constexpr uint32_t FILE_VERSION = 1;
+
+    template<typename T>
+    void write(std::ofstream &output, const T *data, size_t count) {
+        output.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(sizeof(T) * count));
+    }
+
+    template<typename T>
+    void read(std::ifstream &input, T *data, size_t count) {
+        input.read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(sizeof(T) * count));
+
+        if (!input) {
+            throw std::runtime_error("Baked animation file is truncated.");
+        }
+    }
+
+    void restoreAnimatedNodes(pvk::gltf::Hierarchy &hierarchy,
+                              const pvk::gltf::Animation &animation,
+                              const pvk::gltf::Pose &pose) {
+        for (const auto &channel : animation.channels) {
+            hierarchy.setTranslation(channel.node, pose.translations[channel.node]);
+            hierarchy.setRotation(channel.node, pose.rotations[channel.node]);
+            hierarchy.setScale(channel.node, pose.scales[channel.node]);
+        }
+    }
+}  // namespace
+
+namespace pvk::skinning {
+    BakedAnimations BakedAnimations::bake(gltf::Object &object, float sampleRate) {
+        if (sampleRate <= 0.0F) {
+            throw std::runtime_error("Sample rate of baked animations must be positive.");
+        }
+
+        const auto skinIterator = std::find_if(
+                object.skinLookup.begin(), object.skinLookup.end(), [](const auto &entry) {
+                    return entry.second != nullptr;
+                }
+        );
+
+        if (skinIterator == object.skinLookup.end()) {
+            throw std::runtime_error("Object has no skin to bake animations for.");
+        }
+
+        const auto &skin = *skinIterator->second;
+        auto &hierarchy = *object.hierarchy;
+
+        // Palettes are baked as matrices, which are only kept up to date in SkinningMode::LINEAR.
+        const auto skinningMode = skin.skinningMode;
+        object.setSkinningMode(gltf::SkinningMode::LINEAR);
+
+        BakedAnimations result;
+        result.sampleRate = sampleRate;
+        result.numberOfJoints = static_cast<uint32_t>(skin.jointMatrices.size());
+
+        gltf::Pose pose;
+        pose.copyFrom(hierarchy);
+
+        for (auto &animation : object.animations) {
+            const auto previousTime = animation->currentTime;
+            const auto duration = animation->endTime - animation->startTime;
+            const auto numberOfFrames = static_cast<uint32_t>(std::ceil(duration * sampleRate)) + 1;
+
+            result.clips.push_back({
+                    static_cast<uint32_t>(result.palettes.size() / std::max<uint32_t>(result.numberOfJoints, 1)),
+                    numberOfFrames,
+                    duration,
+                    0.0F
+            });
+            result.palettes.reserve(result.palettes.size() + static_cast<size_t>(numberOfFrames) * result.numberOfJoints);
+
+            for (uint32_t frame = 0; frame < numberOfFrames; frame++) {
+                const auto time = std::min(static_cast<float>(frame) / sampleRate, duration);
+                animation->seek(animation->startTime + time);
+                object.updateTransforms();
+                object.updateJoints();
+
+                result.palettes.insert(result.palettes.end(), skin.jointMatrices.begin(), skin.jointMatrices.end());
+            }
+
+            // Nodes which the next clip does not animate must be back in their original pose.
+            animation->currentTime = previousTime;
+            restoreAnimatedNodes(hierarchy, *animation, pose);
+        }
+
+        object.setSkinningMode(skinningMode);
+        object.updateTransforms();
+        object.updateJoints();
+
+        return result;
+    }
+
+    BakedAnimations BakedAnimations::load(const std::string &filePath) {
+        std::ifstream input(filePath, std::ios::binary);
+
+        if (!input) {
+            throw std::runtime_error("Could not open baked animation file.");
+        }
+
+        std::array<uint32_t, 2> header{};
+        read(input, header.data(), header.size());
+
+        if (header[0] != FILE_MAGIC || header[1] != FILE_VERSION) {
+            throw std::runtime_error("Unsupported baked animation file.");
+        }
+
+        BakedAnimations result;
+        uint32_t numberOfClips = 0;
+        read(input, &result.sampleRate, 1);
+        read(input, &result.numberOfJoints, 1);
+        read(input, &numberOfClips, 1);
+
+        result.clips.resize(numberOfClips);
+        read(input, result.clips.data(), result.clips.size());
+
+        size_t numberOfPalettes = 0;
+
+        for (const auto &clip : result.clips) {
+            numberOfPalettes = std::max<size_t>(numberOfPalettes, clip.firstFrame + clip.numberOfFrames);
+        }
+
+        result.palettes.resize(numberOfPalettes * result.numberOfJoints);
+        read(input, result.palettes.data(), result.palettes.size());
+
+        return result;
+    }
+
+    void BakedAnimations::save(const std::string &filePath) const {
+        std::ofstream output(filePath, std::ios::binary);
+
+        if (!output) {
+            throw std::runtime_error("Could not create baked animation file.");
+        }
+
+        const std::array<uint32_t, 2> header{FILE_MAGIC, FILE_VERSION};
+        const auto numberOfClips = static_cast<uint32_t>(this->clips.size());
+
+        write(output, header.data(), header.size());
+        write(output, &this->sampleRate, 1);
+        write(output, &this->numberOfJoints, 1);
+        write(output, &numberOfClips, 1);
+        write(output, this->clips.data(), this->clips.size());
+        write(output, this->palettes.data(), this->palettes.size());
+    }
+
+    const glm::mat4 *BakedAnimations::getPalette(uint32_t clip, uint32_t frame) const {
+        const auto &bakedClip = this->clips.at(clip);
+
+        if (frame >= bakedClip.numberOfFrames) {
+            throw std::runtime_error("Frame of baked clip out of range.");
+        }
+
+        return &this->palettes.at((static_cast<size_t>(bakedClip.firstFrame) + frame) * this->numberOfJoints);
+    }
+}  // namespace pvk::skinning
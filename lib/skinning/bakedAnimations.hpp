@@ -0,0 +1,77 @@
+//
+//  bakedAnimations.hpp
+//  PVK
+//
+
+#ifndef PVK_BAKEDANIMATIONS_HPP
+#define PVK_BAKEDANIMATIONS_HPP
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../gltf/GLTFObject.hpp"
+
+namespace pvk::skinning {
+    /**
+     * Range of palettes sampled from one animation, laid out as in the clip buffer of crowd.vert.
+     */
+    struct BakedClip {
+        uint32_t firstFrame = 0;
+        uint32_t numberOfFrames = 0;
+        float duration = 0.0F;
+        float padding = 0.0F;
+    };
+
+    /**
+     * Joint palettes of all animations of an object, sampled at a fixed rate. Frame f of a clip holds the palette
+     * at f / sampleRate seconds, the last frame lies exactly at the end of the clip so playback can interpolate
+     * between any two neighbouring frames. Palettes are stored frame after frame, numberOfJoints matrices each.
+     */
+    class BakedAnimations {
+    public:
+        static constexpr float DEFAULT_SAMPLE_RATE = 30.0F;
+
+        /**
+         * Samples all animations of an object using the palette of its first skin. The pose of the object is
+         * restored afterwards.
+         */
+        static BakedAnimations bake(gltf::Object &object, float sampleRate = DEFAULT_SAMPLE_RATE);
+
+        /**
+         * Loads palettes baked offline with save().
+         */
+        static BakedAnimations load(const std::string &filePath);
+
+        void save(const std::string &filePath) const;
+
+        [[nodiscard]] float getSampleRate() const {
+            return this->sampleRate;
+        }
+
+        [[nodiscard]] uint32_t getNumberOfJoints() const {
+            return this->numberOfJoints;
+        }
+
+        [[nodiscard]] const std::vector<BakedClip> &getClips() const {
+            return this->clips;
+        }
+
+        [[nodiscard]] const std::vector<glm::mat4> &getPalettes() const {
+            return this->palettes;
+        }
+
+        /**
+         * @return First joint matrix of a frame of a clip.
+         */
+        [[nodiscard]] const glm::mat4 *getPalette(uint32_t clip, uint32_t frame) const;
+
+    private:
+        float sampleRate = DEFAULT_SAMPLE_RATE;
+        uint32_t numberOfJoints = 0;
+        std::vector<BakedClip> clips;
+        std::vector<glm::mat4> palettes;
+    };
+}  // namespace pvk::skinning
+
+#endif //PVK_BAKEDANIMATIONS_HPP
@@ -0,0 +1,229 @@
+//
+//  crowd.cpp
+//  PVK
+//
+
+#include "crowd.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "../buffer/buffer.hpp"
+#include "../context/context.hpp"
+
+namespace {
+    constexpr uint32_t NUMBER_OF_STORAGE_BUFFERS = 2;
+    constexpr uint32_t BINDING_FRAME = 0;
+    constexpr uint32_t BINDING_PALETTES = 1;
+    constexpr uint32_t BINDING_CLIPS = 2;
+}  // namespace
+
+namespace pvk::skinning {
+    Crowd::Crowd(const Pipeline &newPipeline,
+                 const gltf::Object &newObject,
+                 const BakedAnimations &bakedAnimations,
+                 uint32_t newMaximumNumberOfInstances)
+            : pipeline(newPipeline),
+              object(newObject),
+              maximumNumberOfInstances(std::max<uint32_t>(newMaximumNumberOfInstances, 1)) {
+        if (this->object.indices.empty()) {
+            throw std::runtime_error("Crowds can only be drawn from indexed geometry.");
+        }
+
+        if (bakedAnimations.getClips().empty() || bakedAnimations.getPalettes().empty()) {
+            throw std::runtime_error("Crowds need at least one baked clip.");
+        }
+
+        for (const auto &[nodeIndex, node] : this->object.getNodes()) {
+            if (!node->mesh || node->skinIndex < 0) {
+                continue;
+            }
+
+            for (const auto &primitive : node->primitives) {
+                this->commands.emplace_back(
+                        primitive->getIndexCount(), 0, primitive->getFirstIndex(), primitive->getVertexOffset(), 0
+                );
+            }
+        }
+
+        this->frame.sampleRate = bakedAnimations.getSampleRate();
+        this->frame.numberOfJoints = bakedAnimations.getNumberOfJoints();
+        this->instances.reserve(this->maximumNumberOfInstances);
+
+        // Baked palettes never change, so they live in device local memory.
+        buffer::createDeviceLocal(
+                bakedAnimations.getPalettes().data(),
+                sizeof(glm::mat4) * bakedAnimations.getPalettes().size(),
+                vk::BufferUsageFlagBits::eStorageBuffer,
+                this->paletteBuffer,
+                this->paletteBufferMemory
+        );
+        buffer::createDeviceLocal(
+                bakedAnimations.getClips().data(),
+                sizeof(BakedClip) * bakedAnimations.getClips().size(),
+                vk::BufferUsageFlagBits::eStorageBuffer,
+                this->clipBuffer,
+                this->clipBufferMemory
+        );
+
+        const auto numberOfSwapChainImages = Context::getNumberOfSwapChainImages();
+
+        this->frameBuffers.resize(numberOfSwapChainImages);
+        this->frameBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedFrames.resize(numberOfSwapChainImages);
+        this->instanceBuffers.resize(numberOfSwapChainImages);
+        this->instanceBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedInstances.resize(numberOfSwapChainImages);
+        this->indirectBuffers.resize(numberOfSwapChainImages);
+        this->indirectBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedCommands.resize(numberOfSwapChainImages);
+        // Forces an upload of the (empty) instances on the first update of every swap chain image.
+        this->instanceVersionPerImage.assign(numberOfSwapChainImages, this->instanceVersion - 1);
+
+        for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+            this->mappedFrames[i] = static_cast<Frame *>(buffer::createMapped(
+                    sizeof(Frame),
+                    vk::BufferUsageFlagBits::eUniformBuffer,
+                    this->frameBuffers[i],
+                    this->frameBufferMemories[i]
+            ));
+            *this->mappedFrames[i] = this->frame;
+
+            this->mappedInstances[i] = static_cast<Instance *>(buffer::createMapped(
+                    sizeof(Instance) * this->maximumNumberOfInstances,
+                    vk::BufferUsageFlagBits::eVertexBuffer,
+                    this->instanceBuffers[i],
+                    this->instanceBufferMemories[i]
+            ));
+
+            this->mappedCommands[i] = static_cast<vk::DrawIndexedIndirectCommand *>(buffer::createMapped(
+                    sizeof(vk::DrawIndexedIndirectCommand) * std::max<size_t>(this->commands.size(), 1),
+                    vk::BufferUsageFlagBits::eIndirectBuffer,
+                    this->indirectBuffers[i],
+                    this->indirectBufferMemories[i]
+            ));
+            std::copy(this->commands.begin(), this->commands.end(), this->mappedCommands[i]);
+        }
+
+        this->createDescriptorSets();
+    }
+
+    Crowd::~Crowd() {
+        for (auto *memories : {&this->frameBufferMemories, &this->instanceBufferMemories,
+                               &this->indirectBufferMemories}) {
+            for (auto &memory : *memories) {
+                Context::getLogicalDevice().unmapMemory(memory.get());
+            }
+        }
+    }
+
+    void Crowd::createDescriptorSets() {
+        const auto numberOfSwapChainImages = static_cast<uint32_t>(Context::getNumberOfSwapChainImages());
+
+        std::vector<vk::DescriptorPoolSize> poolSizes{
+                {vk::DescriptorType::eUniformBuffer, numberOfSwapChainImages},
+                {vk::DescriptorType::eStorageBuffer, NUMBER_OF_STORAGE_BUFFERS * numberOfSwapChainImages},
+        };
+
+        this->descriptorPool = Context::getLogicalDevice().createDescriptorPoolUnique(
+                {{}, numberOfSwapChainImages, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()}
+        );
+
+        std::vector<vk::DescriptorSetLayout> layouts(numberOfSwapChainImages, this->pipeline.getDescriptorSetLayout(0));
+        this->descriptorSets = Context::getLogicalDevice().allocateDescriptorSets(
+                {this->descriptorPool.get(), numberOfSwapChainImages, layouts.data()}
+        );
+
+        for (uint32_t i = 0; i < numberOfSwapChainImages; i++) {
+            const vk::DescriptorBufferInfo frameBufferInfo{this->frameBuffers[i].get(), 0, sizeof(Frame)};
+            const vk::DescriptorBufferInfo paletteBufferInfo{this->paletteBuffer.get(), 0, VK_WHOLE_SIZE};
+            const vk::DescriptorBufferInfo clipBufferInfo{this->clipBuffer.get(), 0, VK_WHOLE_SIZE};
+
+            const std::array<vk::WriteDescriptorSet, 3> writeDescriptorSets{
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_FRAME, 0, 1,
+                                           vk::DescriptorType::eUniformBuffer, nullptr, &frameBufferInfo},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_PALETTES, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &paletteBufferInfo},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_CLIPS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &clipBufferInfo},
+            };
+
+            Context::getLogicalDevice().updateDescriptorSets(writeDescriptorSets, nullptr);
+        }
+    }
+
+    uint32_t Crowd::addInstance(const Instance &instance) {
+        if (this->instances.size() >= this->maximumNumberOfInstances) {
+            throw std::runtime_error("Maximum number of crowd instances reached.");
+        }
+
+        this->instances.emplace_back(instance);
+        this->instanceVersion++;
+
+        return static_cast<uint32_t>(this->instances.size() - 1);
+    }
+
+    void Crowd::setInstance(uint32_t index, const Instance &instance) {
+        this->instances.at(index) = instance;
+        this->instanceVersion++;
+    }
+
+    void Crowd::clear() {
+        this->instances.clear();
+        this->instanceVersion++;
+    }
+
+    void Crowd::update(const glm::mat4 &viewProjection, float time, uint32_t swapChainIndex) {
+        this->frame.viewProjection = viewProjection;
+        this->frame.time = time;
+        *this->mappedFrames.at(swapChainIndex) = this->frame;
+
+        auto &uploadedVersion = this->instanceVersionPerImage[swapChainIndex];
+
+        if (uploadedVersion == this->instanceVersion) {
+            return;
+        }
+
+        std::copy(this->instances.begin(), this->instances.end(), this->mappedInstances[swapChainIndex]);
+
+        for (size_t i = 0; i < this->commands.size(); i++) {
+            this->mappedCommands[swapChainIndex][i].instanceCount = this->getNumberOfInstances();
+        }
+
+        uploadedVersion = this->instanceVersion;
+    }
+
+    void Crowd::record(const vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex) const {
+        if (this->commands.empty()) {
+            return;
+        }
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, this->pipeline.getVulkanPipeline().get());
+        commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eGraphics,
+                this->pipeline.getPipelineLayout().get(),
+                0,
+                this->descriptorSets.at(swapChainIndex),
+                nullptr
+        );
+
+        const std::array<vk::Buffer, 2> vertexBuffers{
+                this->object.getVertexBuffer(), this->instanceBuffers.at(swapChainIndex).get()
+        };
+        const std::array<vk::DeviceSize, 2> offsets{0, 0};
+        commandBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
+        commandBuffer.bindIndexBuffer(this->object.getIndexBuffer(), 0, vk::IndexType::eUint32);
+
+        const auto indirectBuffer = this->indirectBuffers.at(swapChainIndex).get();
+        const auto numberOfCommands = static_cast<uint32_t>(this->commands.size());
+        constexpr auto stride = static_cast<uint32_t>(sizeof(vk::DrawIndexedIndirectCommand));
+
+        if (Context::getEnabledFeatures().multiDrawIndirect == VK_TRUE) {
+            commandBuffer.drawIndexedIndirect(indirectBuffer, 0, numberOfCommands, stride);
+        } else {
+            for (uint32_t i = 0; i < numberOfCommands; i++) {
+                commandBuffer.drawIndexedIndirect(indirectBuffer, static_cast<vk::DeviceSize>(i) * stride, 1, stride);
+            }
+        }
+    }
+}  // namespace pvk::skinning
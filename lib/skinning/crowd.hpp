@@ -0,0 +1,114 @@
+//
+//  crowd.hpp
+//  PVK
+//
+
+#ifndef PVK_CROWD_HPP
+#define PVK_CROWD_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.hpp>
+
+#include "bakedAnimations.hpp"
+#include "../gltf/GLTFObject.hpp"
+#include "../mesh/instance.hpp"
+#include "../pipeline/pipeline.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::skinning {
+    /**
+     * Draws many copies of a skinned object with instancing. Every instance only carries a transform, a clip and
+     * a time offset; crowd.vert looks up and interpolates the baked palettes itself. Per frame the CPU only
+     * writes the frame time, instance data is uploaded again only after it changed, so the CPU cost of a frame
+     * does not depend on the number of instances.
+     *
+     * The pipeline has to be created from a definition with "instanced" set and a single descriptor set with the
+     * frame uniform buffer, the palette storage buffer and the clip storage buffer, see crowd.json.
+     */
+    class Crowd : util::NoCopy {
+    public:
+        /**
+         * Uniform buffer of crowd.vert.
+         */
+        struct Frame {
+            glm::mat4 viewProjection{1.0F};
+            float time = 0.0F;
+            float sampleRate = 0.0F;
+            uint32_t numberOfJoints = 0;
+            float padding = 0.0F;
+        };
+
+        Crowd(const Pipeline &newPipeline,
+              const gltf::Object &newObject,
+              const BakedAnimations &bakedAnimations,
+              uint32_t newMaximumNumberOfInstances);
+
+        ~Crowd();
+
+        Crowd(Crowd &&other) = delete;
+
+        Crowd &operator=(Crowd &&other) = delete;
+
+        /**
+         * @return Index of the new instance.
+         */
+        uint32_t addInstance(const Instance &instance);
+
+        void setInstance(uint32_t index, const Instance &instance);
+
+        void clear();
+
+        [[nodiscard]] uint32_t getNumberOfInstances() const {
+            return static_cast<uint32_t>(this->instances.size());
+        }
+
+        /**
+         * Writes the frame data of a swap chain image, and the instances when they changed since the last time
+         * this swap chain image was updated.
+         * @param time Time in seconds, every instance plays its clip at time + its time offset.
+         */
+        void update(const glm::mat4 &viewProjection, float time, uint32_t swapChainIndex);
+
+        /**
+         * Records the instanced draws, the amount of instances is read from an indirect buffer so the command
+         * buffer stays valid when instances are added or removed.
+         */
+        void record(const vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex) const;
+
+    private:
+        void createDescriptorSets();
+
+        const Pipeline &pipeline;
+        const gltf::Object &object;
+        const uint32_t maximumNumberOfInstances;
+
+        Frame frame;
+        std::vector<Instance> instances;
+        uint32_t instanceVersion = 0;
+        std::vector<uint32_t> instanceVersionPerImage;
+        std::vector<vk::DrawIndexedIndirectCommand> commands;
+
+        vk::UniqueBuffer paletteBuffer;
+        vk::UniqueDeviceMemory paletteBufferMemory;
+        vk::UniqueBuffer clipBuffer;
+        vk::UniqueDeviceMemory clipBufferMemory;
+
+        std::vector<vk::UniqueBuffer> frameBuffers;
+        std::vector<vk::UniqueDeviceMemory> frameBufferMemories;
+        std::vector<Frame *> mappedFrames;
+
+        std::vector<vk::UniqueBuffer> instanceBuffers;
+        std::vector<vk::UniqueDeviceMemory> instanceBufferMemories;
+        std::vector<Instance *> mappedInstances;
+
+        std::vector<vk::UniqueBuffer> indirectBuffers;
+        std::vector<vk::UniqueDeviceMemory> indirectBufferMemories;
+        std::vector<vk::DrawIndexedIndirectCommand *> mappedCommands;
+
+        vk::UniqueDescriptorPool descriptorPool;
+        std::vector<vk::DescriptorSet> descriptorSets;
+    };
+}  // namespace pvk::skinning
+
+#endif //PVK_CROWD_HPP
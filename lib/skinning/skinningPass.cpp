@@ -0,0 +1,303 @@
+//
+//  skinningPass.cpp
+//  PVK
+//
+
+#include "skinningPass.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "../buffer/buffer.hpp"
+#include "../context/context.hpp"
+
+namespace {
+    constexpr uint32_t NUMBER_OF_BINDINGS = 5;
+    constexpr uint32_t BINDING_BIND_POSE_VERTICES = 0;
+    constexpr uint32_t BINDING_JOINT_PALETTE = 1;
+    constexpr uint32_t BINDING_SKINNED_VERTICES = 2;
+    constexpr uint32_t BINDING_MORPH_DELTAS = 3;
+    constexpr uint32_t BINDING_MORPH_TARGET_LISTS = 4;
+
+    // Targets with a smaller absolute weight do not visibly move any vertex.
+    constexpr float MINIMUM_MORPH_WEIGHT = 1e-4F;
+
+    // skinning.comp addresses vertices as an array of floats with this stride.
+    static_assert(sizeof(pvk::Vertex) == 21 * sizeof(float), "Vertex layout does not match skinning.comp");
+}  // namespace
+
+namespace pvk::skinning {
+    SkinningPass::SkinningPass(const ComputePipeline &newPipeline, const gltf::Object &newObject)
+            : pipeline(newPipeline), object(newObject) {
+        // Every skin gets one slot in the palette buffer, shared by all nodes using it.
+        boost::container::flat_map<const gltf::Skin *, uint32_t> firstJointBySkin;
+
+        for (const auto &[nodeIndex, node] : this->object.getNodes()) {
+            const bool hasMorphTargets = std::any_of(
+                    node->primitives.begin(), node->primitives.end(), [](const auto &primitive) {
+                        return primitive->getNumberOfMorphTargets() > 0;
+                    }
+            );
+
+            if (!node->mesh || (node->skinIndex < 0 && !hasMorphTargets)) {
+                continue;
+            }
+
+            auto firstJoint = NO_SKIN;
+
+            if (node->skinIndex > -1) {
+                const auto *skin = this->object.skinLookup.at(node->skinIndex).get();
+
+                if (skin->skinningMode != gltf::SkinningMode::LINEAR) {
+                    throw std::runtime_error("The skinning pass requires skins in linear skinning mode.");
+                }
+                auto [it, isInserted] = firstJointBySkin.try_emplace(skin, this->numberOfJoints);
+
+                if (isInserted) {
+                    this->skinSlots.push_back({skin, this->numberOfJoints});
+                    this->numberOfJoints += static_cast<uint32_t>(skin->jointMatrices.size());
+                }
+
+                firstJoint = it->second;
+            }
+
+            for (const auto &primitive : node->primitives) {
+                this->dispatches.push_back({
+                        primitive->getStartVertex(),
+                        primitive->getVertexCount(),
+                        firstJoint,
+                        static_cast<uint32_t>(this->dispatches.size())
+                });
+                this->morphSources.push_back({
+                        primitive->getNumberOfMorphTargets() > 0,
+                        node->getHierarchyIndex(),
+                        primitive->getFirstMorphDelta()
+                });
+            }
+        }
+
+        // Storage buffers can not be empty, so there is always room for at least one element.
+        if (this->object.morphDeltas.empty()) {
+            const gltf::MorphDelta emptyDelta{};
+            buffer::createDeviceLocal(&emptyDelta, sizeof(gltf::MorphDelta), vk::BufferUsageFlagBits::eStorageBuffer,
+                                      this->morphDeltaBuffer, this->morphDeltaBufferMemory);
+        } else {
+            buffer::createDeviceLocal(this->object.morphDeltas.data(),
+                                      sizeof(gltf::MorphDelta) * this->object.morphDeltas.size(),
+                                      vk::BufferUsageFlagBits::eStorageBuffer,
+                                      this->morphDeltaBuffer,
+                                      this->morphDeltaBufferMemory);
+        }
+
+        const auto numberOfSwapChainImages = Context::getNumberOfSwapChainImages();
+        const auto paletteSize = sizeof(glm::mat4) * std::max<uint32_t>(this->numberOfJoints, 1);
+        const auto morphTargetListSize = sizeof(MorphTargetList) * std::max<size_t>(this->dispatches.size(), 1);
+
+        this->paletteBuffers.resize(numberOfSwapChainImages);
+        this->paletteBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedPalettes.resize(numberOfSwapChainImages);
+        this->morphTargetListBuffers.resize(numberOfSwapChainImages);
+        this->morphTargetListBufferMemories.resize(numberOfSwapChainImages);
+        this->mappedMorphTargetLists.resize(numberOfSwapChainImages);
+        this->skinnedVertexBuffers.reserve(numberOfSwapChainImages);
+        this->skinnedVertexBufferMemories.reserve(numberOfSwapChainImages);
+
+        for (size_t i = 0; i < numberOfSwapChainImages; i++) {
+            buffer::create(
+                    paletteSize,
+                    vk::BufferUsageFlagBits::eStorageBuffer,
+                    vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+                    this->paletteBuffers[i],
+                    this->paletteBufferMemories[i]
+            );
+
+            this->mappedPalettes[i] = static_cast<glm::mat4 *>(
+                    Context::getLogicalDevice().mapMemory(this->paletteBufferMemories[i].get(), 0, paletteSize)
+            );
+
+            this->mappedMorphTargetLists[i] = static_cast<MorphTargetList *>(buffer::createMapped(
+                    morphTargetListSize,
+                    vk::BufferUsageFlagBits::eStorageBuffer,
+                    this->morphTargetListBuffers[i],
+                    this->morphTargetListBufferMemories[i]
+            ));
+
+            // Attributes which are not skinned are never written by the pass, so they are uploaded once here. The
+            // skinned vertices can be copied out, to read them back on the CPU.
+            auto [vertexBuffer, vertexBufferMemory] = buffer::vertex::create(
+                    this->object.vertices,
+                    vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc
+            );
+            this->skinnedVertexBuffers.emplace_back(std::move(vertexBuffer));
+            this->skinnedVertexBufferMemories.emplace_back(std::move(vertexBufferMemory));
+
+            this->update(static_cast<uint32_t>(i));
+        }
+
+        this->createDescriptorSets();
+    }
+
+    SkinningPass::~SkinningPass() {
+        for (auto &memory : this->paletteBufferMemories) {
+            Context::getLogicalDevice().unmapMemory(memory.get());
+        }
+
+        for (auto &memory : this->morphTargetListBufferMemories) {
+            Context::getLogicalDevice().unmapMemory(memory.get());
+        }
+    }
+
+    void SkinningPass::createDescriptorSets() {
+        const auto numberOfSwapChainImages = static_cast<uint32_t>(Context::getNumberOfSwapChainImages());
+
+        std::vector<vk::DescriptorPoolSize> poolSizes{
+                {vk::DescriptorType::eStorageBuffer, NUMBER_OF_BINDINGS * numberOfSwapChainImages},
+        };
+
+        this->descriptorPool = Context::getLogicalDevice().createDescriptorPoolUnique(
+                {{}, numberOfSwapChainImages, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()}
+        );
+
+        std::vector<vk::DescriptorSetLayout> layouts(numberOfSwapChainImages, this->pipeline.getDescriptorSetLayout(0));
+        this->descriptorSets = Context::getLogicalDevice().allocateDescriptorSets(
+                {this->descriptorPool.get(), numberOfSwapChainImages, layouts.data()}
+        );
+
+        for (uint32_t i = 0; i < numberOfSwapChainImages; i++) {
+            const std::array<vk::DescriptorBufferInfo, NUMBER_OF_BINDINGS> bufferInfos{
+                    vk::DescriptorBufferInfo{this->object.vertexBuffer.get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->paletteBuffers[i].get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->skinnedVertexBuffers[i].get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->morphDeltaBuffer.get(), 0, VK_WHOLE_SIZE},
+                    vk::DescriptorBufferInfo{this->morphTargetListBuffers[i].get(), 0, VK_WHOLE_SIZE},
+            };
+
+            const std::array<vk::WriteDescriptorSet, NUMBER_OF_BINDINGS> writeDescriptorSets{
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_BIND_POSE_VERTICES, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[0]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_JOINT_PALETTE, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[1]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_SKINNED_VERTICES, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[2]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_MORPH_DELTAS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[3]},
+                    vk::WriteDescriptorSet{this->descriptorSets[i], BINDING_MORPH_TARGET_LISTS, 0, 1,
+                                           vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfos[4]},
+            };
+
+            Context::getLogicalDevice().updateDescriptorSets(writeDescriptorSets, nullptr);
+        }
+    }
+
+    void SkinningPass::update(uint32_t swapChainIndex) {
+        auto *palette = this->mappedPalettes.at(swapChainIndex);
+
+        for (const auto &skinSlot : this->skinSlots) {
+            std::copy(skinSlot.skin->jointMatrices.begin(),
+                      skinSlot.skin->jointMatrices.end(),
+                      palette + skinSlot.firstJoint);
+        }
+
+        auto *morphTargetLists = this->mappedMorphTargetLists.at(swapChainIndex);
+
+        for (size_t i = 0; i < this->morphSources.size(); i++) {
+            const auto &morphSource = this->morphSources[i];
+            MorphTargetList morphTargetList;
+            morphTargetList.firstMorphDelta = morphSource.firstMorphDelta;
+
+            if (morphSource.hasMorphTargets) {
+                selectActiveMorphTargets(
+                        this->object.hierarchy->getMorphWeights(morphSource.hierarchyIndex), morphTargetList
+                );
+            }
+
+            morphTargetLists[i] = morphTargetList;
+        }
+    }
+
+    void SkinningPass::selectActiveMorphTargets(std::span<const float> weights, MorphTargetList &morphTargetList) {
+        auto &count = morphTargetList.numberOfActiveTargets;
+
+        for (uint32_t target = 0; target < weights.size(); target++) {
+            const auto weight = weights[target];
+
+            if (std::abs(weight) < MINIMUM_MORPH_WEIGHT) {
+                continue;
+            }
+
+            if (count == gltf::MAX_ACTIVE_MORPH_TARGETS &&
+                std::abs(weight) <= std::abs(morphTargetList.weights[count - 1])) {
+                continue;
+            }
+
+            // Insertion into the list, which is kept sorted by descending absolute weight.
+            auto position = std::min(count, gltf::MAX_ACTIVE_MORPH_TARGETS - 1);
+
+            while (position > 0 && std::abs(morphTargetList.weights[position - 1]) < std::abs(weight)) {
+                morphTargetList.targets[position] = morphTargetList.targets[position - 1];
+                morphTargetList.weights[position] = morphTargetList.weights[position - 1];
+                position--;
+            }
+
+            morphTargetList.targets[position] = target;
+            morphTargetList.weights[position] = weight;
+            count = std::min(count + 1, gltf::MAX_ACTIVE_MORPH_TARGETS);
+        }
+    }
+
+    void SkinningPass::record(const vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex) const {
+        if (this->dispatches.empty()) {
+            return;
+        }
+
+        const auto pipelineLayout = this->pipeline.getPipelineLayout().get();
+
+        // The previous frame which used this swap chain image may still be reading the vertices.
+        commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eVertexInput,
+                vk::PipelineStageFlagBits::eComputeShader,
+                {},
+                nullptr,
+                nullptr,
+                nullptr
+        );
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, this->pipeline.getVulkanPipeline().get());
+        commandBuffer.bindDescriptorSets(
+                vk::PipelineBindPoint::eCompute, pipelineLayout, 0, this->descriptorSets.at(swapChainIndex), nullptr
+        );
+
+        for (const auto &dispatch : this->dispatches) {
+            commandBuffer.pushConstants(
+                    pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, sizeof(Dispatch), &dispatch
+            );
+            commandBuffer.dispatch(
+                    ComputePipeline::getNumberOfWorkGroups(dispatch.numberOfVertices, WORK_GROUP_SIZE), 1, 1
+            );
+        }
+
+        vk::BufferMemoryBarrier barrier{
+                vk::AccessFlagBits::eShaderWrite,
+                vk::AccessFlagBits::eVertexAttributeRead,
+                VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED,
+                this->skinnedVertexBuffers.at(swapChainIndex).get(),
+                0,
+                VK_WHOLE_SIZE
+        };
+
+        commandBuffer.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eVertexInput,
+                {},
+                nullptr,
+                barrier,
+                nullptr
+        );
+    }
+
+    vk::Buffer SkinningPass::getVertexBuffer(uint32_t swapChainIndex) const {
+        return this->skinnedVertexBuffers.at(swapChainIndex).get();
+    }
+}  // namespace pvk::skinning
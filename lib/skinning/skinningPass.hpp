@@ -0,0 +1,138 @@
+//
+//  skinningPass.hpp
+//  PVK
+//
+
+#ifndef PVK_SKINNINGPASS_HPP
+#define PVK_SKINNINGPASS_HPP
+
+#include <array>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <boost/container/flat_map.hpp>
+
+#include "../gltf/GLTFObject.hpp"
+#include "../pipeline/computePipeline.hpp"
+#include "../util/util.hpp"
+
+namespace pvk::skinning {
+    /**
+     * Skins the vertices of an object once per frame in a compute shader. The pass reads the bind pose vertex
+     * buffer of the object and a joint palette and writes a vertex buffer per swap chain image, in which the
+     * positions and normals of all skinned primitives are replaced by their skinned counterparts. Every draw of
+     * the object in that frame (depth pre-pass, shadow views, the main pass) binds this buffer as a static mesh.
+     * Skinned vertices are in object space, so skinned nodes are drawn with an identity local matrix.
+     *
+     * Morph targets are applied before skinning. Per primitive only the gltf::MAX_ACTIVE_MORPH_TARGETS targets
+     * with the largest weights are evaluated, so the CPU cost per frame does not depend on the number of
+     * vertices. Nodes with morph targets but without a skin are morphed in their local space.
+     *
+     * A mesh is skinned in place within its vertex range, so it can only be instanced by a single skinned node.
+     * Skins have to stay in gltf::SkinningMode::LINEAR, since only then their matrix palette is kept up to date.
+     */
+    class SkinningPass : util::NoCopy {
+    public:
+        // Has to match local_size_x in skinning.comp.
+        static constexpr uint32_t WORK_GROUP_SIZE = 64;
+
+        // First joint of a dispatch for a node without a skin, has to match NO_SKIN in skinning.comp.
+        static constexpr uint32_t NO_SKIN = 0xFFFFFFFF;
+
+        /**
+         * Push constants of a single dispatch, has to match the push constant block in skinning.comp.
+         */
+        struct Dispatch {
+            uint32_t firstVertex = 0;
+            uint32_t numberOfVertices = 0;
+            uint32_t firstJoint = 0;
+            uint32_t dispatchIndex = 0;
+        };
+
+        /**
+         * Morph targets evaluated by a single dispatch, has to match MorphTargetList in skinning.comp.
+         */
+        struct MorphTargetList {
+            uint32_t numberOfActiveTargets = 0;
+            uint32_t firstMorphDelta = 0;
+            std::array<uint32_t, 2> padding{};
+            std::array<uint32_t, gltf::MAX_ACTIVE_MORPH_TARGETS> targets{};
+            std::array<float, gltf::MAX_ACTIVE_MORPH_TARGETS> weights{};
+        };
+
+        SkinningPass(const ComputePipeline &newPipeline, const gltf::Object &newObject);
+
+        ~SkinningPass();
+
+        SkinningPass(SkinningPass &&other) = delete;
+
+        SkinningPass &operator=(SkinningPass &&other) = delete;
+
+        /**
+         * Copies the joint palettes of all skins and the active morph targets of all primitives into the buffers
+         * of the given swap chain image. Must be called after gltf::Object::updateJoints().
+         */
+        void update(uint32_t swapChainIndex);
+
+        /**
+         * Records the skinning dispatches and the barrier which makes the result visible to vertex input. Has to
+         * be recorded outside of a render pass.
+         */
+        void record(const vk::CommandBuffer &commandBuffer, uint32_t swapChainIndex) const;
+
+        /**
+         * @return Vertex buffer with the skinned vertices, laid out like the vertex buffer of the object.
+         */
+        [[nodiscard]] vk::Buffer getVertexBuffer(uint32_t swapChainIndex) const;
+
+        [[nodiscard]] uint32_t getNumberOfJoints() const {
+            return this->numberOfJoints;
+        }
+
+        /**
+         * Selects the targets with the largest absolute weight, ignoring targets without any influence.
+         */
+        static void selectActiveMorphTargets(std::span<const float> weights, MorphTargetList &morphTargetList);
+
+    private:
+        struct SkinSlot {
+            const gltf::Skin *skin = nullptr;
+            uint32_t firstJoint = 0;
+        };
+
+        struct MorphSource {
+            bool hasMorphTargets = false;
+            uint32_t hierarchyIndex = 0;
+            uint32_t firstMorphDelta = 0;
+        };
+
+        void createDescriptorSets();
+
+        const ComputePipeline &pipeline;
+        const gltf::Object &object;
+
+        std::vector<SkinSlot> skinSlots;
+        std::vector<Dispatch> dispatches;
+        std::vector<MorphSource> morphSources;
+        uint32_t numberOfJoints = 0;
+
+        std::vector<vk::UniqueBuffer> paletteBuffers;
+        std::vector<vk::UniqueDeviceMemory> paletteBufferMemories;
+        std::vector<glm::mat4 *> mappedPalettes;
+
+        vk::UniqueBuffer morphDeltaBuffer;
+        vk::UniqueDeviceMemory morphDeltaBufferMemory;
+
+        std::vector<vk::UniqueBuffer> morphTargetListBuffers;
+        std::vector<vk::UniqueDeviceMemory> morphTargetListBufferMemories;
+        std::vector<MorphTargetList *> mappedMorphTargetLists;
+
+        std::vector<vk::UniqueBuffer> skinnedVertexBuffers;
+        std::vector<vk::UniqueDeviceMemory> skinnedVertexBufferMemories;
+
+        vk::UniqueDescriptorPool descriptorPool;
+        std::vector<vk::DescriptorSet> descriptorSets;
+    };
+}  // namespace pvk::skinning
+
+#endif //PVK_SKINNINGPASS_HPP
@@ -0,0 +1,104 @@
+//
+//  freeList.cpp
+//  PVK
+//
+
+#include "freeList.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace pvk::util {
+    FreeList::FreeList(uint32_t newCapacity) : capacity(newCapacity), numberOfFreeElements(newCapacity) {
+        if (this->capacity > 0) {
+            this->freeRanges.emplace(0, this->capacity);
+        }
+    }
+
+    std::optional<uint32_t> FreeList::allocate(uint32_t size) {
+        if (size == 0) {
+            return std::nullopt;
+        }
+
+        for (auto it = this->freeRanges.begin(); it != this->freeRanges.end(); ++it) {
+            const auto [offset, rangeSize] = *it;
+
+            if (rangeSize < size) {
+                continue;
+            }
+
+            this->freeRanges.erase(it);
+
+            if (rangeSize > size) {
+                this->freeRanges.emplace(offset + size, rangeSize - size);
+            }
+
+            this->numberOfFreeElements -= size;
+
+            return offset;
+        }
+
+        return std::nullopt;
+    }
+
+    void FreeList::free(uint32_t offset, uint32_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        if (offset > this->capacity || size > this->capacity - offset) {
+            throw std::runtime_error("Freed range lies outside of the free list.");
+        }
+
+        auto next = this->freeRanges.lower_bound(offset);
+
+        if ((next != this->freeRanges.end() && next->first < offset + size) ||
+            (next != this->freeRanges.begin() && std::prev(next)->first + std::prev(next)->second > offset)) {
+            throw std::runtime_error("Freed range overlaps a free range.");
+        }
+
+        auto mergedOffset = offset;
+        auto mergedSize = size;
+
+        if (next != this->freeRanges.begin()) {
+            const auto previous = std::prev(next);
+
+            if (previous->first + previous->second == offset) {
+                mergedOffset = previous->first;
+                mergedSize += previous->second;
+                this->freeRanges.erase(previous);
+            }
+        }
+
+        if (next != this->freeRanges.end() && next->first == offset + size) {
+            mergedSize += next->second;
+            this->freeRanges.erase(next);
+        }
+
+        this->freeRanges.emplace(mergedOffset, mergedSize);
+        this->numberOfFreeElements += size;
+    }
+
+    uint32_t FreeList::getCapacity() const {
+        return this->capacity;
+    }
+
+    uint32_t FreeList::getNumberOfFreeElements() const {
+        return this->numberOfFreeElements;
+    }
+
+    uint32_t FreeList::getLargestFreeRange() const {
+        uint32_t largestFreeRange = 0;
+
+        for (const auto &[offset, size] : this->freeRanges) {
+            largestFreeRange = std::max(largestFreeRange, size);
+        }
+
+        return largestFreeRange;
+    }
+
+    size_t FreeList::getNumberOfFreeRanges() const {
+        return this->freeRanges.size();
+    }
+}  // namespace pvk::util
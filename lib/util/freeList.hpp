@@ -0,0 +1,50 @@
+//
+//  freeList.hpp
+//  PVK
+//
+
+#ifndef PVK_FREELIST_HPP
+#define PVK_FREELIST_HPP
+
+#include <cstdint>
+#include <map>
+#include <optional>
+
+namespace pvk::util {
+    /**
+     * Sub-allocates ranges of elements from a fixed capacity. Free ranges are kept sorted by offset, allocation
+     * takes the first range that fits and freed ranges are merged with their free neighbours, so the capacity
+     * can be reused in full once everything has been freed.
+     */
+    class FreeList {
+    public:
+        explicit FreeList(uint32_t newCapacity);
+
+        /**
+         * @return Offset of the allocated range, or nothing when no free range is large enough.
+         */
+        [[nodiscard]] std::optional<uint32_t> allocate(uint32_t size);
+
+        /**
+         * Returns a range to the free list, it must have been returned by allocate() and not have been freed yet.
+         */
+        void free(uint32_t offset, uint32_t size);
+
+        [[nodiscard]] uint32_t getCapacity() const;
+
+        [[nodiscard]] uint32_t getNumberOfFreeElements() const;
+
+        [[nodiscard]] uint32_t getLargestFreeRange() const;
+
+        [[nodiscard]] size_t getNumberOfFreeRanges() const;
+
+    private:
+        uint32_t capacity;
+        uint32_t numberOfFreeElements;
+
+        // Size of every free range by its offset.
+        std::map<uint32_t, uint32_t> freeRanges;
+    };
+}  // namespace pvk::util
+
+#endif //PVK_FREELIST_HPP
@@ -0,0 +1,160 @@
+//
+//  threadPool.cpp
+//  PVK
+//
+
+#include "threadPool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    thread_local const pvk::util::ThreadPool *currentPool = nullptr;
+    thread_local uint32_t currentThreadIndex = 0;
+
+    uint32_t getDefaultNumberOfWorkers() {
+        const auto numberOfCores = std::thread::hardware_concurrency();
+
+        return numberOfCores > 1 ? numberOfCores - 1 : 0;
+    }
+}  // namespace
+
+namespace pvk::util {
+    ThreadPool::ThreadPool(uint32_t numberOfWorkers) {
+        this->workers.reserve(numberOfWorkers);
+
+        for (uint32_t i = 0; i < numberOfWorkers; i++) {
+            this->workers.emplace_back(&ThreadPool::work, this, i + 1);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->isStopping = true;
+        }
+
+        this->wakeCondition.notify_all();
+
+        for (auto &worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t _count, size_t _batchSize, const Task &_task) {
+        if (_count == 0) {
+            return;
+        }
+
+        _batchSize = std::max<size_t>(_batchSize, 1);
+
+        if (currentPool == this || this->workers.empty() || _count <= _batchSize) {
+            // Nested or trivially small range, there is nothing to gain from waking up the workers.
+            _task(0, _count, currentThreadIndex);
+            return;
+        }
+
+        std::lock_guard<std::mutex> submitLock(this->submitMutex);
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->task = &_task;
+            this->count = _count;
+            this->batchSize = _batchSize;
+            this->numberOfBatches = (_count + _batchSize - 1) / _batchSize;
+            this->nextIndex = 0;
+            this->numberOfCompletedBatches = 0;
+            this->hasFailed = false;
+            this->generation++;
+        }
+
+        this->wakeCondition.notify_all();
+
+        currentPool = this;
+        this->runBatches(0);
+        currentPool = nullptr;
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->doneCondition.wait(lock, [this] {
+            return this->numberOfCompletedBatches == this->numberOfBatches && this->numberOfActiveWorkers == 0;
+        });
+
+        // Workers which did not wake up in time must not pick up a task which is about to go out of scope.
+        this->task = nullptr;
+
+        if (this->exception) {
+            std::rethrow_exception(std::exchange(this->exception, nullptr));
+        }
+    }
+
+    uint32_t ThreadPool::getNumberOfThreads() const {
+        return static_cast<uint32_t>(this->workers.size()) + 1;
+    }
+
+    ThreadPool &ThreadPool::getInstance() {
+        static ThreadPool instance{getDefaultNumberOfWorkers()};
+
+        return instance;
+    }
+
+    void ThreadPool::work(uint32_t threadIndex) {
+        currentPool = this;
+        currentThreadIndex = threadIndex;
+        uint64_t lastGeneration = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->wakeCondition.wait(lock, [this, lastGeneration] {
+                    return this->isStopping || (this->task != nullptr && this->generation != lastGeneration);
+                });
+
+                if (this->isStopping) {
+                    return;
+                }
+
+                lastGeneration = this->generation;
+                this->numberOfActiveWorkers++;
+            }
+
+            this->runBatches(threadIndex);
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->numberOfActiveWorkers--;
+            }
+
+            this->doneCondition.notify_one();
+        }
+    }
+
+    void ThreadPool::runBatches(uint32_t threadIndex) {
+        while (true) {
+            const auto begin = this->nextIndex.fetch_add(this->batchSize);
+
+            if (begin >= this->count) {
+                return;
+            }
+
+            // Remaining batches still have to be counted as completed, otherwise parallelFor() never returns.
+            if (!this->hasFailed) {
+                try {
+                    (*this->task)(begin, std::min(begin + this->batchSize, this->count), threadIndex);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+
+                    if (!this->exception) {
+                        this->exception = std::current_exception();
+                    }
+
+                    this->hasFailed = true;
+                }
+            }
+
+            if (this->numberOfCompletedBatches.fetch_add(1) + 1 == this->numberOfBatches) {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->doneCondition.notify_one();
+            }
+        }
+    }
+}  // namespace pvk::util
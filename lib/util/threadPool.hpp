@@ -0,0 +1,78 @@
+//
+//  threadPool.hpp
+//  PVK
+//
+
+#ifndef PVK_THREADPOOL_HPP
+#define PVK_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util.hpp"
+
+namespace pvk::util {
+    /**
+     * Fixed set of worker threads used for per-frame work (culling, animation, command recording).
+     * The thread calling parallelFor() takes part in the work as thread index 0, workers use 1..N.
+     */
+    class ThreadPool : NoCopy {
+    public:
+        using Task = std::function<void(size_t begin, size_t end, uint32_t threadIndex)>;
+
+        explicit ThreadPool(uint32_t numberOfWorkers);
+
+        ~ThreadPool();
+
+        ThreadPool(ThreadPool &&other) = delete;
+
+        ThreadPool &operator=(ThreadPool &&other) = delete;
+
+        /**
+         * Splits [0, count) into batches of batchSize and runs task on all threads, blocks until done.
+         * Calling this from inside a task runs the nested range serially on the calling thread.
+         * @throws Rethrows the first exception thrown by the task on the calling thread, once all threads have
+         *         stopped. Batches which were not started yet are skipped after an exception.
+         */
+        void parallelFor(size_t count, size_t batchSize, const Task &task);
+
+        /**
+         * @return Number of threads that can execute a task, including the calling thread.
+         */
+        [[nodiscard]] uint32_t getNumberOfThreads() const;
+
+        static ThreadPool &getInstance();
+
+    private:
+        void work(uint32_t threadIndex);
+
+        void runBatches(uint32_t threadIndex);
+
+        std::vector<std::thread> workers;
+
+        std::mutex submitMutex;
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+
+        const Task *task = nullptr;
+        size_t count = 0;
+        size_t batchSize = 1;
+        size_t numberOfBatches = 0;
+        std::atomic<size_t> nextIndex{0};
+        std::atomic<size_t> numberOfCompletedBatches{0};
+        std::atomic<bool> hasFailed{false};
+        // First exception thrown by the task, guarded by mutex.
+        std::exception_ptr exception;
+        uint32_t numberOfActiveWorkers = 0;
+        uint64_t generation = 0;
+        bool isStopping = false;
+    };
+}  // namespace pvk::util
+
+#endif //PVK_THREADPOOL_HPP
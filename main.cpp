@@ -9,17 +9,42 @@ public:
     ~App() = default;
 
 private:
+    // Declared first, so the objects placed in it are destroyed before the arena.
+    std::unique_ptr<pvk::GeometryArena> _sceneArena;
     std::unique_ptr<pvk::object::GameObject> _testObject;
     std::unique_ptr<pvk::Pipeline> _pipeline;
     std::unique_ptr<pvk::Pipeline> _pipelineSimple;
     std::unique_ptr<pvk::Pipeline> _skyboxPipeline;
+    std::unique_ptr<pvk::ComputePipeline> _skinningPipeline;
+    std::unique_ptr<pvk::skinning::SkinningPass> _foxSkinning;
+    std::unique_ptr<pvk::Pipeline> _crowdPipeline;
+    std::unique_ptr<pvk::Pipeline> _dualQuaternionPipeline;
+    std::unique_ptr<pvk::skinning::Crowd> _crowd;
+    std::unique_ptr<pvk::Pipeline> _instancedPipeline;
+    std::unique_ptr<pvk::ComputePipeline> _occlusionCullingPipeline;
+    std::unique_ptr<pvk::ComputePipeline> _depthPyramidPipeline;
+    std::unique_ptr<pvk::object::InstanceBatches> _treeBatches;
+    std::unique_ptr<pvk::culling::DepthPyramid> _depthPyramid;
+    std::unique_ptr<pvk::culling::GpuCuller> _treeCuller;
+    std::unique_ptr<pvk::culling::MeshletCuller> _meshletCuller;
+    float _crowdTime = 0.0F;
+
+    static constexpr uint32_t SCENE_ARENA_VERTICES = 1 << 20;
+    static constexpr uint32_t SCENE_ARENA_INDICES = 1 << 22;
+    static constexpr uint32_t CROWD_SIZE = 32;
+    static constexpr float CROWD_SPACING = 2.0F;
 
     std::shared_ptr<pvk::Object> _fox;
+    std::shared_ptr<pvk::Object> _dualQuaternionFox;
+    std::shared_ptr<pvk::Object> _trees;
+    std::shared_ptr<pvk::Object> _scenery;
     std::vector<std::unique_ptr<pvk::gltf::Animation>> _runningAnimation;
     std::shared_ptr<pvk::Object> _skyboxObject;
 
     std::shared_ptr<pvk::Texture> _skyboxTexture;
 
+    pvk::RenderQueue _renderQueue;
+
     struct {
         glm::mat4 view;
         glm::mat4 projection;
@@ -47,6 +72,18 @@ private:
                 "/Users/christian/PVK-Engine/definitions/skybox.json", renderPass.get(), swapChainExtent);
         _pipelineSimple = pvk::createPipelineFromDefinition(
                 "/Users/christian/PVK-Engine/definitions/simple.json", renderPass.get(), swapChainExtent);
+        _skinningPipeline = pvk::createComputePipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/skinning.json");
+        _crowdPipeline = pvk::createPipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/crowd.json", renderPass.get(), swapChainExtent);
+        _dualQuaternionPipeline = pvk::createPipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/pbr_dual_quaternion.json", renderPass.get(), swapChainExtent);
+        _instancedPipeline = pvk::createPipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/pbr_instanced.json", renderPass.get(), swapChainExtent);
+        _occlusionCullingPipeline = pvk::createComputePipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/occlusion_culling.json");
+        _depthPyramidPipeline = pvk::createComputePipelineFromDefinition(
+                "/Users/christian/PVK-Engine/definitions/depth_pyramid.json");
 
         _pipeline->setUniformBufferSize(0, 0, sizeof(uniformBufferObject));
         _pipeline->setUniformBufferSize(0, 1, sizeof(bufferObject));
@@ -55,6 +92,17 @@ private:
         _skyboxPipeline->setUniformBufferSize(0, 0, sizeof(uniformBufferObject));
         _skyboxPipeline->setUniformBufferSize(0, 1, sizeof(bufferObject));
 
+        _dualQuaternionPipeline->setUniformBufferSize(0, 0, sizeof(uniformBufferObject));
+        _dualQuaternionPipeline->setUniformBufferSize(0, 1, sizeof(pvk::gltf::DualQuaternionBufferObject));
+        _dualQuaternionPipeline->setUniformBufferSize(1, 0, sizeof(materialStructure));
+
+        _instancedPipeline->setUniformBufferSize(0, 0, sizeof(uniformBufferObject));
+        _instancedPipeline->setUniformBufferSize(0, 1, sizeof(bufferObject));
+        _instancedPipeline->setUniformBufferSize(1, 0, sizeof(materialStructure));
+
+        // Static geometry shares the buffers of one arena, so it is drawn without rebinding vertex and index buffers.
+        _sceneArena = std::make_unique<pvk::GeometryArena>(SCENE_ARENA_VERTICES, SCENE_ARENA_INDICES);
+
         // Load model
         auto t1 = std::chrono::high_resolution_clock::now();
         _fox = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), "/Users/christian/walk.glb");
@@ -64,15 +112,65 @@ private:
         std::cout << "Loading model took " << duration << "ms" << std::endl;
 
         auto temp = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), "/Users/christian/walk.glb");
-        auto mesh = std::make_unique<pvk::object::Mesh>(temp->gltfObject->vertices, temp->gltfObject->indices);
+        auto graphicsQueue = pvk::Context::getGraphicsQueue();
+        auto mesh = std::make_unique<pvk::object::Mesh>(
+                temp->gltfObject->vertices, temp->gltfObject->indices, graphicsQueue, *_sceneArena);
         auto transform = std::make_unique<pvk::object::Transform>();
         _testObject = std::make_unique<pvk::object::GameObject>(std::move(mesh), std::move(transform));
 
         _pipeline->registerObject(_fox);
+        _fox->playAnimation(0);
+        registerObject(_fox);
+        _foxSkinning = std::make_unique<pvk::skinning::SkinningPass>(*_skinningPipeline, *_fox->gltfObject);
+
+        // Second fox skinned in the vertex shader with dual quaternions, registering it switches its skins over.
+        _dualQuaternionFox = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), "/Users/christian/walk.glb");
+        _dualQuaternionPipeline->registerObject(_dualQuaternionFox);
+        _dualQuaternionFox->playAnimation(0);
+        registerObject(_dualQuaternionFox);
+
+        // Crowd of foxes, each walking at its own phase.
+        const auto bakedAnimations = pvk::skinning::BakedAnimations::bake(*_fox->gltfObject);
+        _crowd = std::make_unique<pvk::skinning::Crowd>(
+                *_crowdPipeline, *_fox->gltfObject, bakedAnimations, CROWD_SIZE * CROWD_SIZE);
+
+        for (uint32_t x = 0; x < CROWD_SIZE; x++) {
+            for (uint32_t z = 0; z < CROWD_SIZE; z++) {
+                pvk::Instance instance;
+                instance.transform = glm::translate(
+                        glm::mat4(1.0F), glm::vec3(static_cast<float>(x), 0.0F, static_cast<float>(z)) * CROWD_SPACING);
+                instance.timeOffset = 0.37F * static_cast<float>(x * CROWD_SIZE + z);
+                _crowd->addInstance(instance);
+            }
+        }
+
+        // Instanced trees, culled on the GPU against the frustum and the depth of the early pass.
+        _trees = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(),
+                                             "/Users/christian/PVK-Engine/test/data/instanced.gltf",
+                                             {},
+                                             _sceneArena.get());
+        _trees->gltfObject->updateTransforms();
+        _instancedPipeline->registerObject(_trees);
+        _treeBatches = std::make_unique<pvk::object::InstanceBatches>(*_trees->gltfObject);
+        _depthPyramid = std::make_unique<pvk::culling::DepthPyramid>(
+                *_depthPyramidPipeline, depthImageView.get(), swapChainExtent);
+        _treeCuller = std::make_unique<pvk::culling::GpuCuller>(
+                *_occlusionCullingPipeline, *_trees->gltfObject, *_treeBatches, *_depthPyramid);
+
+        // Static scenery, its meshlets are culled against the frustum and their normal cones every frame.
+        _scenery = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(),
+                                               "/Users/christian/PVK-Engine/test/data/cube.glb",
+                                               {},
+                                               _sceneArena.get());
+        _scenery->gltfObject->updateTransforms();
+        _pipeline->registerObject(_scenery);
+        _meshletCuller = std::make_unique<pvk::culling::MeshletCuller>(*_scenery->gltfObject);
 
         // Load skybox
         _skyboxObject = pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(),
-                                                    "/Users/christian/Downloads/data/models/cube.gltf");
+                                                    "/Users/christian/Downloads/data/models/cube.gltf",
+                                                    {},
+                                                    _sceneArena.get());
         _skyboxTexture = pvk::ktx::load(pvk::Context::getGraphicsQueue(),
                                         "/Users/christian/Downloads/data/textures/cubemap_space.ktx");
         _skyboxPipeline->registerTexture(_skyboxTexture, 0, 2);
@@ -81,12 +179,15 @@ private:
         // Finalize pipeline and prepare for rendering
         _pipeline->prepare();
         _skyboxPipeline->prepare();
+        _dualQuaternionPipeline->prepare();
+        _instancedPipeline->prepare();
 
         uniformBufferObject.view = camera->getViewMatrix();
         uniformBufferObject.projection =
                 glm::perspective(glm::radians(30.0F), swapChainExtent.width / (float) swapChainExtent.height, 0.1F,
                                  1000.0F);
         uniformBufferObject.projection[1][1] *= -1;
+        animationLodScheduler.setProjection(glm::radians(30.0F), static_cast<float>(swapChainExtent.height));
         uniformBufferObject.lightPosition = glm::vec3(10.0F, 10.0F, 10.0F);
 
         auto setMaterial = [](pvk::gltf::Object &object, pvk::gltf::Primitive &primitive,
@@ -96,6 +197,61 @@ private:
         };
 
         _fox->updateUniformBufferPerPrimitive(setMaterial, 1, 0);
+        _dualQuaternionFox->updateUniformBufferPerPrimitive(setMaterial, 1, 0);
+        _trees->updateUniformBufferPerPrimitive(setMaterial, 1, 0);
+        _scenery->updateUniformBufferPerPrimitive(setMaterial, 1, 0);
+
+        // Static nodes are only uploaded once, afterwards only changed nodes are uploaded in update().
+        _fox->updateUniformBufferPerNode(setPreSkinnedNodeBufferObject, 0, 1);
+        _skyboxObject->updateUniformBufferPerNode(setNodeBufferObject, 0, 1);
+        _dualQuaternionFox->updateUniformBufferPerNode(getNodeBufferObjectSetter(*_dualQuaternionPipeline), 0, 1);
+        _trees->updateUniformBufferPerNode(setNodeBufferObject, 0, 1);
+        _scenery->updateUniformBufferPerNode(setNodeBufferObject, 0, 1);
+    }
+
+    using NodeBufferObjectSetter = void (*)(pvk::gltf::Object &, pvk::gltf::Node &, vk::UniqueDeviceMemory &);
+
+    // The node uniform has the layout of the vertex shader of the skinning mode the pipeline was defined with.
+    static NodeBufferObjectSetter getNodeBufferObjectSetter(const pvk::Pipeline &pipeline) {
+        if (pipeline.getSkinningMode() == pvk::gltf::SkinningMode::DUAL_QUATERNION) {
+            return setDualQuaternionNodeBufferObject;
+        }
+
+        return setNodeBufferObject;
+    }
+
+    static void setNodeBufferObject(pvk::gltf::Object &object, pvk::gltf::Node &node, vk::UniqueDeviceMemory &memory) {
+        node.bufferObject.jointCount = 0.0F;
+
+        if (node.skinIndex > -1) {
+            const auto &jointMatrices = object.getJointMatrices(node);
+            const auto numberOfJoints = std::min(jointMatrices.size(), std::size(node.bufferObject.inverseBindMatrices));
+
+            std::copy_n(jointMatrices.begin(), numberOfJoints, node.bufferObject.inverseBindMatrices);
+            node.bufferObject.jointCount = static_cast<float>(numberOfJoints);
+        }
+
+        node.bufferObject.model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0F));
+        node.bufferObject.localMatrix = node.getGlobalMatrix();
+        pvk::buffer::update(memory, sizeof(node.bufferObject), &node.bufferObject);
+    }
+
+    static void setDualQuaternionNodeBufferObject(pvk::gltf::Object &object, pvk::gltf::Node &node,
+                                                  vk::UniqueDeviceMemory &memory) {
+        pvk::gltf::DualQuaternionBufferObject dualQuaternionBufferObject;
+        object.fillDualQuaternionBufferObject(node, dualQuaternionBufferObject);
+        dualQuaternionBufferObject.localMatrix = node.getGlobalMatrix();
+        pvk::buffer::update(memory, sizeof(dualQuaternionBufferObject), &dualQuaternionBufferObject);
+    }
+
+    // The fox is skinned by _foxSkinning, so it is drawn without joints.
+    static void setPreSkinnedNodeBufferObject(pvk::gltf::Object &object, pvk::gltf::Node &node,
+                                              vk::UniqueDeviceMemory &memory) {
+        node.bufferObject.jointCount = 0.0F;
+        node.bufferObject.model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0F));
+        // Skinned vertices are already in object space.
+        node.bufferObject.localMatrix = node.skinIndex > -1 ? glm::mat4(1.0F) : node.getGlobalMatrix();
+        pvk::buffer::update(memory, sizeof(node.bufferObject), &node.bufferObject);
     }
 
     void update() override {
@@ -105,43 +261,74 @@ private:
 
         _fox->updateUniformBuffer(&uniformBufferObject, sizeof(uniformBufferObject), 0, 0);
         _skyboxObject->updateUniformBuffer(&uniformBufferObject, sizeof(uniformBufferObject), 0, 0);
+        _dualQuaternionFox->updateUniformBuffer(&uniformBufferObject, sizeof(uniformBufferObject), 0, 0);
+        _trees->updateUniformBuffer(&uniformBufferObject, sizeof(uniformBufferObject), 0, 0);
+        _treeBatches->update(currentImageIndex);
+        _scenery->updateUniformBuffer(&uniformBufferObject, sizeof(uniformBufferObject), 0, 0);
+        const auto viewProjection = uniformBufferObject.projection * uniformBufferObject.view;
+        _meshletCuller->cull(pvk::culling::Frustum::fromMatrix(viewProjection), camera->position, currentImageIndex);
 
-        const auto updateInverseBindMatrices = [](pvk::gltf::Object &object,
-                                                  pvk::gltf::Node &node,
-                                                  vk::UniqueDeviceMemory &memory) {
-            auto &inverseBindMatrices = object.inverseBindMatrices;
+//        _runningAnimation[0]->update(this->deltaTime);
+        // Animation, transforms and joints of registered objects have already been updated by the engine.
+        _fox->updateUniformBufferPerChangedNode(setPreSkinnedNodeBufferObject, 0, 1);
+        _foxSkinning->update(currentImageIndex);
+        _dualQuaternionFox->updateUniformBufferPerChangedNode(
+                getNodeBufferObjectSetter(*_dualQuaternionPipeline), 0, 1);
 
-            for (size_t i = 0; i < inverseBindMatrices.size(); i++) {
-                node.bufferObject.inverseBindMatrices[i] = inverseBindMatrices[i];
-            }
+        _crowdTime += this->deltaTime;
+        _crowd->update(uniformBufferObject.projection * uniformBufferObject.view, _crowdTime, currentImageIndex);
+        _skyboxObject->gltfObject->updateTransforms();
+        _skyboxObject->updateUniformBufferPerChangedNode(setNodeBufferObject, 0, 1);
 
-            node.bufferObject.jointCount = node.skinIndex > -1 ? static_cast<float>(inverseBindMatrices.size()) : 0.0F;
-        };
+        _renderQueue.clear();
 
-        const auto setUniformBufferObject =
-                [](pvk::gltf::Object &object, pvk::gltf::Node &node, vk::UniqueDeviceMemory &memory) {
-                    node.bufferObject.model = glm::scale(glm::mat4(1.0f), glm::vec3(1.0F));
-                    node.bufferObject.localMatrix = node.getGlobalMatrix();
-                    pvk::buffer::update(memory, sizeof(node.bufferObject), &node.bufferObject);
-                };
+        for (const auto &node : _skyboxObject->gltfObject->getNodes()) {
+            _renderQueue.submit(*_skyboxPipeline, *_skyboxObject->gltfObject, *node.second, uniformBufferObject.view);
+        }
 
-        _fox->getAnimation(0).update(this->deltaTime);
-//        _runningAnimation[0]->update(this->deltaTime);
-        _fox->gltfObject->updateJoints();
-        _fox->updateUniformBufferPerNode(updateInverseBindMatrices, 0, 1);
-        _fox->updateUniformBufferPerNode(setUniformBufferObject, 0, 1);
-        _skyboxObject->updateUniformBufferPerNode(setUniformBufferObject, 0, 1);
+        for (const auto &node : _dualQuaternionFox->gltfObject->getNodes()) {
+            _renderQueue.submit(
+                    *_dualQuaternionPipeline, *_dualQuaternionFox->gltfObject, *node.second, uniformBufferObject.view);
+        }
+
+        _renderQueue.sort();
     }
 
     void render(pvk::CommandBuffer *commandBuffer) override {
-        for (const auto &node : _skyboxObject->gltfObject->getNodes()) {
-            commandBuffer->drawNode(*_skyboxPipeline, *_skyboxObject->gltfObject, *node.second);
+        commandBuffer->drawRenderQueue(_renderQueue);
+        commandBuffer->drawObject(*_pipelineSimple, *_testObject);
+        commandBuffer->drawCrowd(*_crowd);
+        commandBuffer->drawGpuCulledLate(*_instancedPipeline, *_treeCuller);
+
+        for (const auto &node : _scenery->gltfObject->getNodes()) {
+            commandBuffer->drawNodeMeshlets(*_pipeline, *_scenery->gltfObject, *node.second, *_meshletCuller);
         }
 
-        commandBuffer->drawObject(*_pipelineSimple, *_testObject);
-//        for (const auto &node : _fox->gltfObject->getNodes()) {
-//            commandBuffer->drawNode(*_pipeline, *_fox->gltfObject, *node.second);
-//        }
+        // Skinned once per frame in compute(), the fox is drawn from the output of the skinning pass.
+        for (const auto &node : _fox->gltfObject->getNodes()) {
+            commandBuffer->drawSkinnedNode(*_pipeline, *_fox->gltfObject, *node.second, *_foxSkinning);
+        }
+    }
+
+    void compute(pvk::CommandBuffer *commandBuffer) override {
+        commandBuffer->dispatchSkinning(*_foxSkinning);
+        // The trees have no model matrix, so the frustum is built from the view projection alone.
+        const auto viewProjection = uniformBufferObject.projection * uniformBufferObject.view;
+        commandBuffer->dispatchCulling(*_treeCuller, pvk::culling::Frustum::fromMatrix(viewProjection));
+    }
+
+    // The trees are occlusion culled in two phases, see pvk::culling::GpuCuller.
+    bool hasEarlyPass() override {
+        return true;
+    }
+
+    void renderEarly(pvk::CommandBuffer *commandBuffer) override {
+        commandBuffer->drawGpuCulled(*_instancedPipeline, *_treeCuller);
+    }
+
+    void computeAfterEarlyPass(pvk::CommandBuffer *commandBuffer) override {
+        commandBuffer->buildDepthPyramid(*_depthPyramid);
+        commandBuffer->dispatchLateCulling(*_treeCuller, uniformBufferObject.projection * uniformBufferObject.view);
     }
 
     void tearDown() override {
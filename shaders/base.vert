@@ -41,8 +41,9 @@ void main() {
         inWeight0.z * model.inverseBindMatrices[int(inJoint0.z)] +
         inWeight0.w * model.inverseBindMatrices[int(inJoint0.w)];
 
-        localPosition = model.model * model.local * skinMat * vec4(inPosition, 1.0);
-        outNormal = normalize(mat3(model.model * model.local * skinMat) * inNormal);
+        // The joint palette is in object space, the transform of the skinned node itself is ignored.
+        localPosition = model.model * skinMat * vec4(inPosition, 1.0);
+        outNormal = normalize(mat3(model.model * skinMat) * inNormal);
     } else {
         localPosition = model.model * model.local * vec4(inPosition, 1.0);
         outNormal = normalize(transpose(inverse(mat3(model.model * model.local))) * inNormal);
@@ -0,0 +1,79 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPosition;
+    vec3 lightPosition;
+} ubo;
+
+// Joints are stored as dual quaternions, real part at 2 * joint and dual part at 2 * joint + 1.
+layout(set = 0, binding = 1) uniform BufferObject {
+    mat4 model;
+    mat4 local;
+    vec4 jointDualQuaternions[512];
+    float jointCount;
+} model;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV0;
+layout(location = 4) in vec2 inUV1;
+layout(location = 5) in ivec4 inJoint0;
+layout(location = 6) in vec4 inWeight0;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV0;
+layout(location = 3) out vec2 outUV1;
+layout(location = 4) out vec3 outLightPosition;
+layout(location = 5) out vec3 outCameraPosition;
+
+vec3 rotate(vec4 real, vec3 v) {
+    return v + 2.0 * cross(real.xyz, cross(real.xyz, v) + real.w * v);
+}
+
+void main() {
+    vec4 localPosition;
+
+    if (model.jointCount > 0.0) {
+        // Mesh is skinned, blend the dual quaternions of the joints
+        vec4 real0 = model.jointDualQuaternions[2 * inJoint0.x];
+        vec4 real = inWeight0.x * real0;
+        vec4 dual = inWeight0.x * model.jointDualQuaternions[2 * inJoint0.x + 1];
+
+        for (int i = 1; i < 4; i++) {
+            vec4 realI = model.jointDualQuaternions[2 * inJoint0[i]];
+            // q and -q are the same rotation, flip to the hemisphere of the first joint to blend the short way.
+            float weight = dot(real0, realI) < 0.0 ? -inWeight0[i] : inWeight0[i];
+            real += weight * realI;
+            dual += weight * model.jointDualQuaternions[2 * inJoint0[i] + 1];
+        }
+
+        float norm = length(real);
+        real /= norm;
+        dual /= norm;
+
+        vec3 translation = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+
+        // The joint palette is in object space, the transform of the skinned node itself is ignored.
+        localPosition = model.model * vec4(rotate(real, inPosition) + translation, 1.0);
+        outNormal = normalize(mat3(model.model) * rotate(real, inNormal));
+    } else {
+        localPosition = model.model * model.local * vec4(inPosition, 1.0);
+        outNormal = normalize(transpose(inverse(mat3(model.model * model.local))) * inNormal);
+    }
+    outPosition = vec3(localPosition);
+
+    outLightPosition = ubo.lightPosition;
+
+    outCameraPosition = ubo.cameraPosition;
+
+    outUV0 = inUV0;
+
+    outUV1 = inUV1;
+
+    gl_Position = ubo.proj * ubo.view * vec4(localPosition.xyz, 1.0);
+}
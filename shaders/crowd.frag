@@ -0,0 +1,18 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV0;
+
+layout(location = 0) out vec4 outColor;
+
+const vec3 LIGHT_DIRECTION = normalize(vec3(1.0, 1.0, 1.0));
+const vec3 BASE_COLOR = vec3(0.8, 0.5, 0.3);
+const float AMBIENT = 0.2;
+
+void main() {
+    float diffuse = max(dot(normalize(inNormal), LIGHT_DIRECTION), 0.0);
+
+    outColor = vec4(BASE_COLOR * (AMBIENT + diffuse), 1.0);
+}
@@ -0,0 +1,70 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform Frame {
+    mat4 viewProjection;
+    float time;
+    float sampleRate;
+    uint numberOfJoints;
+} frame;
+
+layout(std430, set = 0, binding = 1) readonly buffer Palettes {
+    mat4 palettes[];
+};
+
+struct Clip {
+    uint firstFrame;
+    uint numberOfFrames;
+    float duration;
+    float padding;
+};
+
+layout(std430, set = 0, binding = 2) readonly buffer Clips {
+    Clip clips[];
+};
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV0;
+layout(location = 5) in ivec4 inJoint0;
+layout(location = 6) in vec4 inWeight0;
+
+layout(location = 7) in mat4 instanceTransform;
+layout(location = 11) in uint instanceClip;
+layout(location = 12) in float instanceTimeOffset;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV0;
+
+mat4 getJointMatrix(uint firstPalette, uint nextPalette, float alpha, int joint) {
+    return (1.0 - alpha) * palettes[firstPalette + uint(joint)] + alpha * palettes[nextPalette + uint(joint)];
+}
+
+void main() {
+    Clip clip = clips[instanceClip];
+
+    // mod() is always positive, so negative time offsets wrap around as well.
+    float clipTime = mod(frame.time + instanceTimeOffset, max(clip.duration, 0.0001));
+    float framePosition = clipTime * frame.sampleRate;
+    uint firstFrame = min(uint(framePosition), clip.numberOfFrames - 1);
+    uint nextFrame = min(firstFrame + 1, clip.numberOfFrames - 1);
+    float alpha = framePosition - float(firstFrame);
+
+    uint firstPalette = (clip.firstFrame + firstFrame) * frame.numberOfJoints;
+    uint nextPalette = (clip.firstFrame + nextFrame) * frame.numberOfJoints;
+
+    mat4 skinMat =
+    inWeight0.x * getJointMatrix(firstPalette, nextPalette, alpha, inJoint0.x) +
+    inWeight0.y * getJointMatrix(firstPalette, nextPalette, alpha, inJoint0.y) +
+    inWeight0.z * getJointMatrix(firstPalette, nextPalette, alpha, inJoint0.z) +
+    inWeight0.w * getJointMatrix(firstPalette, nextPalette, alpha, inJoint0.w);
+
+    vec4 worldPosition = instanceTransform * skinMat * vec4(inPosition, 1.0);
+
+    outPosition = worldPosition.xyz;
+    outNormal = normalize(mat3(instanceTransform * skinMat) * inNormal);
+    outUV0 = inUV0;
+
+    gl_Position = frame.viewProjection * worldPosition;
+}
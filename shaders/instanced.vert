@@ -0,0 +1,48 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPosition;
+    vec3 lightPosition;
+} ubo;
+
+layout(set = 0, binding = 1) uniform BufferObject {
+    mat4 model;
+    mat4 local;
+    mat4 inverseBindMatrices[256];
+    float jointCount;
+} model;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec2 inUV0;
+layout(location = 4) in vec2 inUV1;
+
+// World matrix of the node times its EXT_mesh_gpu_instancing transform, replaces model.local.
+layout(location = 7) in mat4 instanceTransform;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV0;
+layout(location = 3) out vec2 outUV1;
+layout(location = 4) out vec3 outLightPosition;
+layout(location = 5) out vec3 outCameraPosition;
+
+void main() {
+    vec4 localPosition = model.model * instanceTransform * vec4(inPosition, 1.0);
+    outNormal = normalize(transpose(inverse(mat3(model.model * instanceTransform))) * inNormal);
+    outPosition = vec3(localPosition);
+
+    outLightPosition = ubo.lightPosition;
+
+    outCameraPosition = ubo.cameraPosition;
+
+    outUV0 = inUV0;
+
+    outUV1 = inUV1;
+
+    gl_Position = ubo.proj * ubo.view * vec4(localPosition.xyz, 1.0);
+}
@@ -0,0 +1,106 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    vec3 cameraPosition;
+    vec3 lightPosition;
+} ubo;
+
+layout(set = 0, binding = 1) uniform BufferObject {
+    mat4 model;
+    mat4 local;
+    mat4 inverseBindMatrices[256];
+    float jointCount;
+} model;
+
+// Vertices of any layout are read as words, the pipeline adds this set after the sets of its definition.
+layout(std430, set = 2, binding = 0) readonly buffer Vertices {
+    float vertices[];
+};
+
+const uint ABSENT = 0xFFFFFFFFu;
+
+// Has to match pvk::VertexLayout, offsets count words from the start of a vertex.
+layout(push_constant) uniform VertexLayout {
+    uint stride;
+    uint position;
+    uint color;
+    uint normal;
+    uint UV0;
+    uint UV1;
+    uint joint;
+    uint weight;
+} vertexLayout;
+
+layout(location = 0) out vec3 outPosition;
+layout(location = 1) out vec3 outNormal;
+layout(location = 2) out vec2 outUV0;
+layout(location = 3) out vec2 outUV1;
+layout(location = 4) out vec3 outLightPosition;
+layout(location = 5) out vec3 outCameraPosition;
+
+vec2 readVec2(uint base, uint offset) {
+    if (offset == ABSENT) {
+        return vec2(0.0);
+    }
+
+    return vec2(vertices[base + offset], vertices[base + offset + 1]);
+}
+
+vec3 readVec3(uint base, uint offset) {
+    if (offset == ABSENT) {
+        return vec3(0.0);
+    }
+
+    return vec3(vertices[base + offset], vertices[base + offset + 1], vertices[base + offset + 2]);
+}
+
+vec4 readVec4(uint base, uint offset) {
+    if (offset == ABSENT) {
+        return vec4(0.0);
+    }
+
+    return vec4(vertices[base + offset], vertices[base + offset + 1],
+                vertices[base + offset + 2], vertices[base + offset + 3]);
+}
+
+void main() {
+    // gl_VertexIndex already includes the vertex offset or first vertex of the draw.
+    uint base = uint(gl_VertexIndex) * vertexLayout.stride;
+
+    vec3 inPosition = readVec3(base, vertexLayout.position);
+    vec3 inNormal = readVec3(base, vertexLayout.normal);
+    ivec4 inJoint0 = floatBitsToInt(readVec4(base, vertexLayout.joint));
+    vec4 inWeight0 = readVec4(base, vertexLayout.weight);
+
+    vec4 localPosition;
+
+    if (model.jointCount > 0.0 && vertexLayout.joint != ABSENT) {
+        // Mesh is skinned
+        mat4 skinMat =
+        inWeight0.x * model.inverseBindMatrices[inJoint0.x] +
+        inWeight0.y * model.inverseBindMatrices[inJoint0.y] +
+        inWeight0.z * model.inverseBindMatrices[inJoint0.z] +
+        inWeight0.w * model.inverseBindMatrices[inJoint0.w];
+
+        // The joint palette is in object space, the transform of the skinned node itself is ignored.
+        localPosition = model.model * skinMat * vec4(inPosition, 1.0);
+        outNormal = normalize(mat3(model.model * skinMat) * inNormal);
+    } else {
+        localPosition = model.model * model.local * vec4(inPosition, 1.0);
+        outNormal = normalize(transpose(inverse(mat3(model.model * model.local))) * inNormal);
+    }
+    outPosition = vec3(localPosition);
+
+    outLightPosition = ubo.lightPosition;
+
+    outCameraPosition = ubo.cameraPosition;
+
+    outUV0 = readVec2(base, vertexLayout.UV0);
+
+    outUV1 = readVec2(base, vertexLayout.UV1);
+
+    gl_Position = ubo.proj * ubo.view * vec4(localPosition.xyz, 1.0);
+}
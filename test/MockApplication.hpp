@@ -34,6 +34,21 @@ public:
         return this->graphicsQueue;
     }
 
+    vk::ImageView getDepthImageView() {
+        return this->depthImageView.get();
+    }
+
+    using Application::registerObject;
+
+    void updateObjects(float newDeltaTime) {
+        this->deltaTime = newDeltaTime;
+        Application::updateObjects();
+    }
+
+    void clearObjects() {
+        this->objects.clear();
+    }
+
 private:
     void initialize() override {}
     void update() override {}
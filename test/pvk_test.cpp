@@ -1,11 +1,19 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
 #include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <sstream>
 #include <vector>
 
 #include "../lib/application/application.hpp"
+#include "../lib/culling/sceneBvh.hpp"
 #include "MockApplication.hpp"
 
 #pragma clang diagnostic push
@@ -64,6 +72,23 @@ TEST(PipelineParserTest, parseFullPipeline) {
     application.get();
 }
 
+TEST(PipelineParserTest, parseComputeJson) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/compute.json";
+
+    auto descriptorSets = pvk::parseDescriptorSets(pvk::parseDefinition(filePathStream.str()));
+
+    EXPECT_EQ(descriptorSets.size(), 1);
+
+    auto &bindings = descriptorSets[0]->bindings;
+    EXPECT_EQ(bindings.size(), 3);
+
+    for (const auto &binding : bindings) {
+        EXPECT_EQ(binding->shaderStageFlags, vk::ShaderStageFlagBits::eCompute);
+        EXPECT_EQ(binding->descriptorType, vk::DescriptorType::eStorageBuffer);
+    }
+}
+
 TEST(GLTFTest, parseCubeGLTF) {
     std::ostringstream filePathStream;
     filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
@@ -98,6 +123,42 @@ TEST(GLTFTest, multipleNodeGlobalMatrixIsNotEqualToLocalMatrix) {
     EXPECT_EQ(rootNode.getLocalMatrix() * childNode.getLocalMatrix(), rootNode.getGlobalMatrix());
 }
 
+TEST(GLTFTest, globalMatrixIsUpdatedFromParentTransform) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto &rootNode = *object->getNodes().at(0);
+    const auto &childNode = object->getNodeByIndex(1);
+    const auto previousChildGlobalMatrix = childNode.getGlobalMatrix();
+
+    rootNode.setTranslation(rootNode.getTranslation() + glm::vec3(1.0F, 2.0F, 3.0F));
+    EXPECT_EQ(childNode.getGlobalMatrix(), previousChildGlobalMatrix);
+
+    object->updateTransforms();
+    EXPECT_NE(childNode.getGlobalMatrix(), previousChildGlobalMatrix);
+    EXPECT_EQ(rootNode.getGlobalMatrix() * childNode.getLocalMatrix(), childNode.getGlobalMatrix());
+}
+
+TEST(GLTFTest, onlyDirtyNodesAreReportedAsChanged) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    EXPECT_FALSE(object->getChangedNodes().empty());
+
+    object->updateTransforms();
+    EXPECT_TRUE(object->getChangedNodes().empty());
+
+    auto &childNode = *object->getNodes().at(1);
+    childNode.setScale(glm::vec3(2.0F));
+    object->updateTransforms();
+
+    const auto &changedNodes = object->getChangedNodes();
+    EXPECT_NE(std::find(changedNodes.begin(), changedNodes.end(), &childNode), changedNodes.end());
+    EXPECT_EQ(std::find(changedNodes.begin(), changedNodes.end(), object->getNodes().at(0).get()), changedNodes.end());
+}
+
 TEST(GLTFTest, parseRiggedFigure) {
     std::ostringstream filePathStream;
     filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
@@ -120,6 +181,1265 @@ TEST(GLTFTest, parseRiggedFigure) {
     EXPECT_EQ(animation->endTime, 1.25F);
 }
 
+TEST(GLTFTest, jointPaletteIsUpdatedInPlace) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto &skin = *object->skinLookup[0];
+    const auto *palette = skin.jointMatrices.data();
+
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+
+    EXPECT_TRUE(skin.hasChanged);
+    EXPECT_EQ(skin.jointMatrices.data(), palette);
+    ASSERT_EQ(skin.jointMatrices.size(), skin.jointsIndices.size());
+
+    for (size_t i = 0; i < skin.jointsIndices.size(); i++) {
+        const auto &joint = object->getNodeByIndex(skin.jointsIndices[i]);
+        EXPECT_EQ(skin.jointMatrices[i], joint.getGlobalMatrix() * skin.inverseBindMatrices[i]);
+    }
+
+    // Nothing moved, so the palette is not rebuilt.
+    object->updateTransforms();
+    EXPECT_FALSE(skin.hasChanged);
+}
+
+TEST(GLTFTest, skinBoundsContainSkinnedVertices) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+
+    for (const auto &[nodeIndex, node] : object->getNodes()) {
+        if (node->skinIndex < 0 || node->primitives.empty()) {
+            continue;
+        }
+
+        const auto &bounds = object->getSkinBounds(*node);
+        const auto &jointMatrices = object->getJointMatrices(*node);
+        ASSERT_FALSE(bounds.isEmpty());
+
+        for (const auto &primitive : node->primitives) {
+            for (uint32_t i = 0; i < primitive->getVertexCount(); i++) {
+                const auto &vertex = object->vertices[primitive->getStartVertex() + i];
+                glm::mat4 skinMatrix(0.0F);
+
+                for (glm::length_t j = 0; j < 4; j++) {
+                    skinMatrix += vertex.weight[j] * jointMatrices[vertex.joint[j]];
+                }
+
+                const auto position = glm::vec3(skinMatrix * glm::vec4(vertex.pos, 1.0F));
+
+                for (glm::length_t j = 0; j < 3; j++) {
+                    EXPECT_GE(position[j], bounds.minimum[j] - 1e-4F);
+                    EXPECT_LE(position[j], bounds.maximum[j] + 1e-4F);
+                }
+            }
+        }
+    }
+}
+
+TEST(GLTFTest, dualQuaternionPaletteMatchesJointMatrices) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto &skin = *object->skinLookup[0];
+
+    EXPECT_TRUE(skin.jointDualQuaternions.empty());
+
+    object->setSkinningMode(pvk::gltf::SkinningMode::DUAL_QUATERNION);
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+
+    ASSERT_EQ(skin.jointDualQuaternions.size(), skin.jointsIndices.size());
+
+    const glm::vec3 point(0.3F, -1.2F, 0.7F);
+
+    for (size_t i = 0; i < skin.jointDualQuaternions.size(); i++) {
+        // The matrix palette is not kept up to date in dual quaternion mode.
+        const auto jointMatrix =
+                object->hierarchy->getWorldMatrix(skin.jointHierarchyIndices[i]) * skin.inverseBindMatrices[i];
+        const auto expected = glm::vec3(jointMatrix * glm::vec4(point, 1.0F));
+        const auto actual = skin.jointDualQuaternions[i].transformPoint(point);
+
+        EXPECT_NEAR(glm::length(skin.jointDualQuaternions[i].real), 1.0F, 1e-4F);
+        EXPECT_NEAR(glm::distance(actual, expected), 0.0F, 1e-3F);
+    }
+}
+
+TEST(GLTFTest, dualQuaternionBufferObjectMatchesShaderLayout) {
+    // Layout of the Node block in base_dq.vert: mat4, mat4, vec4[2 * MAX_JOINTS], float.
+    EXPECT_EQ(offsetof(pvk::gltf::DualQuaternionBufferObject, jointCount), 8320);
+
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto &skin = *object->skinLookup[0];
+    const auto &skinnedNode = *std::find_if(object->nodes.begin(), object->nodes.end(), [](const auto &node) {
+        return node->skinIndex >= 0;
+    })->get();
+
+    auto bufferObject = std::make_unique<pvk::gltf::DualQuaternionBufferObject>();
+    EXPECT_THROW(object->fillDualQuaternionBufferObject(skinnedNode, *bufferObject), std::runtime_error);
+
+    object->setSkinningMode(pvk::gltf::SkinningMode::DUAL_QUATERNION);
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+    object->fillDualQuaternionBufferObject(skinnedNode, *bufferObject);
+
+    ASSERT_EQ(bufferObject->jointCount, static_cast<float>(skin.jointDualQuaternions.size()));
+
+    for (size_t i = 0; i < skin.jointDualQuaternions.size(); i++) {
+        EXPECT_EQ(bufferObject->jointDualQuaternions[i].real, skin.jointDualQuaternions[i].real);
+        EXPECT_EQ(bufferObject->jointDualQuaternions[i].dual, skin.jointDualQuaternions[i].dual);
+    }
+}
+
+TEST(GLTFTest, bakedPalettesMatchSampledAnimation) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto &skin = *object->skinLookup[0];
+    const auto restPalette = skin.jointMatrices;
+
+    const auto baked = pvk::skinning::BakedAnimations::bake(*object, 10.0F);
+
+    ASSERT_EQ(baked.getClips().size(), 1);
+    EXPECT_EQ(baked.getNumberOfJoints(), skin.jointMatrices.size());
+    EXPECT_EQ(baked.getClips()[0].numberOfFrames, 14);
+    EXPECT_EQ(skin.jointMatrices, restPalette);
+
+    auto &animation = *object->animations[0];
+    animation.seek(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+
+    const auto *palette = baked.getPalette(0, 5);
+
+    for (size_t i = 0; i < skin.jointMatrices.size(); i++) {
+        EXPECT_EQ(palette[i], skin.jointMatrices[i]);
+    }
+
+    const auto filePath = (std::filesystem::temp_directory_path() / "pvk_baked_animations.bin").string();
+    baked.save(filePath);
+    const auto loaded = pvk::skinning::BakedAnimations::load(filePath);
+    std::filesystem::remove(filePath);
+
+    EXPECT_EQ(loaded.getSampleRate(), baked.getSampleRate());
+    EXPECT_EQ(loaded.getNumberOfJoints(), baked.getNumberOfJoints());
+    EXPECT_EQ(loaded.getClips().size(), baked.getClips().size());
+    EXPECT_EQ(loaded.getPalettes(), baked.getPalettes());
+}
+
+TEST(MeshletCullerTest, culledMeshletsAreRejectedAndAdjacentOnesMerged) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->updateTransforms();
+    auto &primitive = *object->getNodeByIndex(0).primitives[0];
+    ASSERT_EQ(primitive.getIndexCount(), 36);
+
+    // Four meshlets of three triangles: two visible, one facing away from the camera, one outside the frustum.
+    std::vector<pvk::gltf::Meshlet> meshlets(4);
+
+    for (uint32_t i = 0; i < meshlets.size(); i++) {
+        meshlets[i].startIndex = primitive.getStartIndex() + i * 9;
+        meshlets[i].indexCount = 9;
+        meshlets[i].radius = 0.5F;
+    }
+
+    meshlets[1].coneAxis = glm::vec3(0.0F, 0.0F, 1.0F);
+    meshlets[1].coneCutoff = 0.5F;
+    meshlets[2].coneAxis = glm::vec3(0.0F, 0.0F, -1.0F);
+    meshlets[2].coneCutoff = 0.5F;
+    meshlets[3].center = glm::vec3(100.0F, 0.0F, 0.0F);
+    primitive.setMeshlets(std::move(meshlets));
+
+    pvk::culling::MeshletCuller culler(*object);
+    ASSERT_EQ(culler.getNumberOfMeshlets(), 4);
+
+    const auto cameraPosition = glm::vec3(0.0F, 0.0F, 5.0F);
+    const auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F);
+    const auto view = glm::lookAt(cameraPosition, glm::vec3(0.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    culler.cull(pvk::culling::Frustum::fromMatrix(projection * view), cameraPosition, 0);
+
+    EXPECT_EQ(culler.getNumberOfVisibleMeshlets(), 2);
+
+    const auto commands = culler.getCommands(0);
+    ASSERT_EQ(commands.size(), 4);
+    EXPECT_EQ(commands[0].firstIndex, primitive.getFirstIndex());
+    EXPECT_EQ(commands[0].indexCount, 18);
+    EXPECT_EQ(commands[0].instanceCount, 1);
+
+    for (size_t i = 1; i < commands.size(); i++) {
+        EXPECT_EQ(commands[i].indexCount, 0);
+        EXPECT_EQ(commands[i].instanceCount, 0);
+    }
+
+    // Looking the other way culls everything.
+    const auto awayView = glm::lookAt(cameraPosition, glm::vec3(0.0F, 0.0F, 10.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    culler.cull(pvk::culling::Frustum::fromMatrix(projection * awayView), cameraPosition, 0);
+
+    EXPECT_EQ(culler.getNumberOfVisibleMeshlets(), 0);
+    EXPECT_EQ(culler.getCommands(0)[0].indexCount, 0);
+}
+
+TEST(GLTFTest, meshletsCoverPrimitiveIndices) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+
+    for (const auto &[nodeIndex, node] : object->getNodes()) {
+        for (const auto &primitive : node->primitives) {
+            const auto &meshlets = primitive->getMeshlets();
+            EXPECT_FALSE(meshlets.empty());
+
+            auto nextIndex = primitive->getStartIndex();
+
+            for (const auto &meshlet : meshlets) {
+                EXPECT_EQ(meshlet.startIndex, nextIndex);
+                EXPECT_LE(meshlet.vertexCount, pvk::gltf::MESHLET_MAX_VERTICES);
+                EXPECT_LE(meshlet.indexCount, pvk::gltf::MESHLET_MAX_TRIANGLES * 3);
+
+                for (auto i = meshlet.startIndex; i < meshlet.startIndex + meshlet.indexCount; i++) {
+                    const auto &position = object->vertices[object->indices[i]].pos;
+                    EXPECT_LE(glm::distance(position, meshlet.center), meshlet.radius + 1e-4F);
+                }
+
+                nextIndex += meshlet.indexCount;
+            }
+
+            EXPECT_EQ(nextIndex, primitive->getStartIndex() + primitive->getIndexCount());
+        }
+    }
+}
+
+TEST(CullingTest, frustumCullsSpheresOutsideView) {
+    const auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F);
+    const auto view = glm::lookAt(glm::vec3(0.0F), glm::vec3(0.0F, 0.0F, -1.0F), glm::vec3(0.0F, 1.0F, 0.0F));
+    const auto frustum = pvk::culling::Frustum::fromMatrix(projection * view);
+
+    EXPECT_TRUE(frustum.isSphereVisible(glm::vec3(0.0F, 0.0F, -10.0F), 1.0F));
+    EXPECT_FALSE(frustum.isSphereVisible(glm::vec3(0.0F, 0.0F, 10.0F), 1.0F));
+    EXPECT_FALSE(frustum.isSphereVisible(glm::vec3(0.0F, 0.0F, -200.0F), 1.0F));
+    EXPECT_FALSE(frustum.isSphereVisible(glm::vec3(50.0F, 0.0F, -10.0F), 1.0F));
+    EXPECT_TRUE(frustum.isSphereVisible(glm::vec3(0.0F, 0.0F, 0.5F), 1.0F));
+}
+
+TEST(CullingTest, boundingBoxTransformContainsTransformedCorners) {
+    const pvk::gltf::BoundingBox bounds{glm::vec3(-1.0F, -2.0F, -3.0F), glm::vec3(1.0F, 2.0F, 3.0F)};
+    const auto matrix = glm::translate(glm::mat4(1.0F), glm::vec3(5.0F, 0.0F, 0.0F)) *
+                        glm::rotate(glm::mat4(1.0F), glm::radians(90.0F), glm::vec3(0.0F, 0.0F, 1.0F));
+    const auto transformed = bounds.transform(matrix);
+
+    for (glm::length_t i = 0; i < 3; i++) {
+        EXPECT_NEAR(transformed.minimum[i], glm::vec3(3.0F, -1.0F, -3.0F)[i], 1e-5F);
+        EXPECT_NEAR(transformed.maximum[i], glm::vec3(7.0F, 1.0F, 3.0F)[i], 1e-5F);
+    }
+}
+
+TEST(CullingTest, primitivesOutsideFrustumAreCulled) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    const auto &node = object->getNodeByIndex(0);
+    const auto &bounds = node.primitives[0]->getBounds();
+    ASSERT_FALSE(bounds.isEmpty());
+
+    for (const auto &vertex : object->vertices) {
+        for (glm::length_t i = 0; i < 3; i++) {
+            EXPECT_GE(vertex.pos[i], bounds.minimum[i] - 1e-5F);
+            EXPECT_LE(vertex.pos[i], bounds.maximum[i] + 1e-5F);
+        }
+    }
+
+    pvk::culling::PrimitiveCuller culler;
+    culler.addObject(*object);
+    EXPECT_EQ(culler.getNumberOfDraws(), 1);
+
+    const auto center = bounds.transform(node.getGlobalMatrix()).getCenter();
+    const auto eye = center + glm::vec3(0.0F, 0.0F, 10.0F);
+    const auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F);
+    const auto up = glm::vec3(0.0F, 1.0F, 0.0F);
+
+    culler.cull(pvk::culling::Frustum::fromMatrix(projection * glm::lookAt(eye, center, up)));
+    ASSERT_EQ(culler.getVisibleDraws().size(), 1);
+    EXPECT_EQ(culler.getVisibleDraws()[0].primitive, node.primitives[0].get());
+
+    culler.cull(pvk::culling::Frustum::fromMatrix(projection * glm::lookAt(eye, eye * 2.0F - center, up)));
+    EXPECT_TRUE(culler.getVisibleDraws().empty());
+}
+
+TEST(RenderQueueTest, opaqueSortsFrontToBackAndTransparentBackToFront) {
+    const auto nearOpaque = pvk::RenderQueue::makeOpaqueKey(0, 0, 0, 1.0F);
+    const auto farOpaque = pvk::RenderQueue::makeOpaqueKey(0, 0, 0, 10.0F);
+    const auto otherPipeline = pvk::RenderQueue::makeOpaqueKey(1, 0, 0, 0.5F);
+    const auto nearTransparent = pvk::RenderQueue::makeTransparentKey(0, 0, 0, 1.0F);
+    const auto farTransparent = pvk::RenderQueue::makeTransparentKey(0, 0, 0, 10.0F);
+
+    EXPECT_LT(nearOpaque, farOpaque);
+    // State changes outweigh depth for opaque draws.
+    EXPECT_LT(farOpaque, otherPipeline);
+    EXPECT_LT(otherPipeline, farTransparent);
+    EXPECT_LT(farTransparent, nearTransparent);
+    // Behind the camera is clamped to the camera.
+    EXPECT_EQ(pvk::RenderQueue::makeOpaqueKey(0, 0, 0, -5.0F), pvk::RenderQueue::makeOpaqueKey(0, 0, 0, 0.0F));
+    // Materials only decide the order within a power of two range of depths.
+    EXPECT_LT(pvk::RenderQueue::makeOpaqueKey(0, 0, 7, 1.0F), pvk::RenderQueue::makeOpaqueKey(0, 0, 0, 10.0F));
+    EXPECT_LT(pvk::RenderQueue::makeOpaqueKey(0, 0, 0, 1.5F), pvk::RenderQueue::makeOpaqueKey(0, 0, 1, 1.0F));
+}
+
+TEST(RenderQueueTest, recordSkipsBindsOfBoundState) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+    std::ostringstream pipelinePathStream;
+    pipelinePathStream << std::filesystem::current_path().c_str() << "/../definitions/pbr.json";
+
+    auto pipeline = pvk::createPipelineFromDefinition(
+            pipelinePathStream.str(), application->getRenderPass(), application->getSwapChainExtent());
+    auto first = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto second = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    const auto &firstNode = first->getNodeByIndex(0);
+    const auto &secondNode = second->getNodeByIndex(0);
+
+    pvk::RenderQueue renderQueue;
+    renderQueue.submit(*pipeline, *first, firstNode, *firstNode.primitives[0], 1.0F);
+    renderQueue.submit(*pipeline, *second, secondNode, *secondNode.primitives[0], 2.0F);
+    renderQueue.submit(*pipeline, *first, firstNode, *firstNode.primitives[0], 3.0F);
+    renderQueue.sort();
+
+    // Geometry outweighs depth, so both draws of the first object follow each other.
+    const auto packets = renderQueue.getPackets();
+    ASSERT_EQ(packets.size(), 3);
+    EXPECT_EQ(packets[0].object, first.get());
+    EXPECT_EQ(packets[1].object, first.get());
+    EXPECT_EQ(packets[2].object, second.get());
+
+    // A secondary command buffer continuing the render pass, it is recorded but never submitted.
+    vk::CommandBufferAllocateInfo allocInfo = {};
+    allocInfo.commandPool = pvk::Context::getCommandPool();
+    allocInfo.level = vk::CommandBufferLevel::eSecondary;
+    allocInfo.commandBufferCount = 1;
+    auto uniqueCommandBuffer = std::move(pvk::Context::getLogicalDevice().allocateCommandBuffersUnique(allocInfo)[0]);
+    auto commandBuffer = uniqueCommandBuffer.get();
+
+    vk::CommandBufferInheritanceInfo inheritanceInfo = {};
+    inheritanceInfo.renderPass = application->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    vk::CommandBufferBeginInfo beginInfo = {};
+    beginInfo.flags = vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    commandBuffer.begin(beginInfo);
+    renderQueue.record(commandBuffer, 0);
+    commandBuffer.end();
+
+    // The objects are not registered with the pipeline, so only the pipeline, vertex and index buffers are bound.
+    const auto &statistics = renderQueue.getStatistics();
+    EXPECT_EQ(statistics.numberOfDraws, 3);
+    EXPECT_EQ(statistics.numberOfBinds, 5);
+    EXPECT_EQ(statistics.numberOfSkippedBinds, 4);
+}
+
+TEST(AnimationLodTest, distantObjectsAreUpdatedLessOften) {
+    pvk::skinning::AnimationLodScheduler scheduler;
+    scheduler.setProjection(glm::radians(90.0F), 1000.0F);
+
+    EXPECT_NEAR(scheduler.getProjectedSize(glm::vec3(0.0F, 0.0F, -10.0F), 1.0F, glm::vec3(0.0F)), 100.0F, 1e-3F);
+    EXPECT_EQ(scheduler.getUpdateInterval(200.0F), 1);
+    EXPECT_EQ(scheduler.getUpdateInterval(100.0F), 2);
+    EXPECT_EQ(scheduler.getUpdateInterval(10.0F), pvk::skinning::AnimationLodScheduler::MAXIMUM_UPDATE_INTERVAL);
+}
+
+TEST(AnimationLodTest, skippedFramesAreCarriedOver) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto object = pvk::Object::createFromGLTF(application->getGraphicsQueue(), filePathStream.str());
+    object->playAnimation(0);
+    object->setAnimationUpdateInterval(2, 1);
+
+    object->update(0.1F);
+    EXPECT_TRUE(object->gltfObject->getChangedNodes().empty());
+    EXPECT_NEAR(object->getAnimation(0).currentTime, 0.0F, 1e-6F);
+
+    object->update(0.1F);
+    EXPECT_FALSE(object->gltfObject->getChangedNodes().empty());
+    EXPECT_NEAR(object->getAnimation(0).currentTime, 0.2F, 1e-6F);
+}
+
+TEST(AnimationLodTest, onlyChangedObjectsUploadTheirNodes) {
+    std::ostringstream animatedPathStream;
+    animatedPathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+    std::ostringstream staticPathStream;
+    staticPathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+
+    std::shared_ptr<pvk::Object> animated =
+            pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), animatedPathStream.str());
+    std::shared_ptr<pvk::Object> skipping =
+            pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), animatedPathStream.str());
+    std::shared_ptr<pvk::Object> still =
+            pvk::Object::createFromGLTF(pvk::Context::getGraphicsQueue(), staticPathStream.str());
+    animated->playAnimation(0);
+    skipping->playAnimation(0);
+    skipping->setAnimationUpdateInterval(2);
+
+    // Node uniform buffers as a pipeline would create them, without the descriptor sets.
+    const vk::DescriptorSetLayoutBinding nodeBinding{
+            1, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex};
+
+    for (const auto &object : {animated, skipping, still}) {
+        for (const auto &[nodeIndex, node] : object->gltfObject->getNodes()) {
+            for (uint32_t i = 0; i < pvk::Context::getNumberOfSwapChainImages(); i++) {
+                node->addUniformBufferToDescriptorSet(nodeBinding, sizeof(glm::mat4), 0, i);
+            }
+        }
+
+        application->registerObject(object);
+    }
+
+    const auto countUploads = [](const pvk::Object &object) {
+        uint32_t numberOfUploads = 0;
+
+        object.updateUniformBufferPerChangedNode(
+                [&numberOfUploads](pvk::gltf::Object &, pvk::gltf::Node &node, vk::UniqueDeviceMemory &memory) {
+                    auto globalMatrix = node.getGlobalMatrix();
+                    pvk::buffer::update(memory, sizeof(globalMatrix), &globalMatrix);
+                    numberOfUploads++;
+                },
+                0,
+                1);
+
+        return numberOfUploads;
+    };
+
+    // Loading already computed the transforms, so only the nodes moved by the animations are uploaded.
+    application->updateObjects(0.1F);
+    const auto numberOfAnimatedUploads = countUploads(*animated);
+    EXPECT_GT(numberOfAnimatedUploads, 0);
+    EXPECT_EQ(countUploads(*skipping), numberOfAnimatedUploads);
+    EXPECT_EQ(countUploads(*still), 0);
+
+    // The second animated object skips every other frame and keeps its last transforms.
+    application->updateObjects(0.1F);
+    EXPECT_GT(countUploads(*animated), 0);
+    EXPECT_EQ(countUploads(*skipping), 0);
+    EXPECT_EQ(countUploads(*still), 0);
+
+    application->clearObjects();
+}
+
+TEST(GLTFTest, animationPlaybackMatchesSeek) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto playedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto seekedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+
+    // Play past the end so the cursors have to wrap around once.
+    for (int i = 0; i < 40; i++) {
+        playedObject->animations[0]->update(0.05F);
+    }
+
+    seekedObject->animations[0]->seek(playedObject->animations[0]->currentTime);
+
+    for (const auto &[nodeIndex, node] : playedObject->getNodes()) {
+        const auto &seekedNode = seekedObject->getNodeByIndex(nodeIndex);
+
+        for (glm::length_t i = 0; i < 4; i++) {
+            EXPECT_NEAR(node->getRotation()[i], seekedNode.getRotation()[i], 1e-5F);
+        }
+
+        for (glm::length_t i = 0; i < 3; i++) {
+            EXPECT_NEAR(node->getTranslation()[i], seekedNode.getTranslation()[i], 1e-5F);
+        }
+    }
+}
+
+TEST(GLTFTest, mixerWithSingleLayerMatchesAnimation) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto playedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto mixedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+
+    pvk::gltf::AnimationMixer mixer(mixedObject->hierarchy);
+    mixer.addLayer(*mixedObject->animations[0], 1.0F);
+
+    for (int i = 0; i < 10; i++) {
+        playedObject->animations[0]->update(0.05F);
+        mixer.update(0.05F);
+    }
+
+    for (const auto &[nodeIndex, node] : playedObject->getNodes()) {
+        const auto &mixedNode = mixedObject->getNodeByIndex(nodeIndex);
+
+        // q and -q are the same rotation.
+        EXPECT_NEAR(std::abs(glm::dot(node->getRotation(), mixedNode.getRotation())), 1.0F, 1e-5F);
+
+        for (glm::length_t i = 0; i < 3; i++) {
+            EXPECT_NEAR(node->getTranslation()[i], mixedNode.getTranslation()[i], 1e-5F);
+            EXPECT_NEAR(node->getScale()[i], mixedNode.getScale()[i], 1e-5F);
+        }
+    }
+}
+
+TEST(GLTFTest, mixerLeavesNodesToTheLayersAnimatingThem) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    auto playedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto mixedObject = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+
+    // Same clip restricted to a single node, so both layers agree wherever they overlap.
+    auto partialAnimation = *mixedObject->animations[0];
+    const auto partialNode = partialAnimation.channels.front().node;
+    std::erase_if(partialAnimation.channels, [partialNode](const auto &channel) {
+        return channel.node != partialNode;
+    });
+    partialAnimation.prepare();
+
+    pvk::gltf::AnimationMixer mixer(mixedObject->hierarchy);
+    mixer.addLayer(*mixedObject->animations[0], 0.5F);
+    mixer.addLayer(partialAnimation, 0.5F);
+
+    for (int i = 0; i < 10; i++) {
+        playedObject->animations[0]->update(0.05F);
+        mixer.update(0.05F);
+    }
+
+    for (const auto &[nodeIndex, node] : playedObject->getNodes()) {
+        const auto &mixedNode = mixedObject->getNodeByIndex(nodeIndex);
+
+        EXPECT_NEAR(std::abs(glm::dot(node->getRotation(), mixedNode.getRotation())), 1.0F, 1e-5F);
+
+        for (glm::length_t i = 0; i < 3; i++) {
+            EXPECT_NEAR(node->getTranslation()[i], mixedNode.getTranslation()[i], 1e-5F);
+            EXPECT_NEAR(node->getScale()[i], mixedNode.getScale()[i], 1e-5F);
+        }
+    }
+}
+
+TEST(GLTFTest, compressedAnimationMatchesOriginal) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+
+    pvk::gltf::AnimationCompression compression;
+    compression.isEnabled = true;
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    auto compressedObject = pvk::GLTFLoader::loadObject(
+            application->getGraphicsQueue(), filePathStream.str(), compression
+    );
+
+    auto &animation = *object->animations[0];
+    auto &compressedAnimation = *compressedObject->animations[0];
+    EXPECT_EQ(compressedAnimation.channels.size(), animation.channels.size());
+    EXPECT_EQ(compressedAnimation.endTime, animation.endTime);
+
+    for (int i = 0; i < 20; i++) {
+        animation.update(0.05F);
+        compressedAnimation.update(0.05F);
+
+        for (const auto &[nodeIndex, node] : object->getNodes()) {
+            const auto &compressedNode = compressedObject->getNodeByIndex(nodeIndex);
+
+            EXPECT_GT(std::abs(glm::dot(node->getRotation(), compressedNode.getRotation())), 0.999F);
+
+            for (glm::length_t j = 0; j < 3; j++) {
+                EXPECT_NEAR(node->getTranslation()[j], compressedNode.getTranslation()[j], 1e-2F);
+                EXPECT_NEAR(node->getScale()[j], compressedNode.getScale()[j], 1e-2F);
+            }
+        }
+    }
+}
+
+TEST(GLTFTest, smallestThreeRotationRoundTrip) {
+    const auto rotation = glm::normalize(glm::quat(0.3F, -0.5F, 0.7F, 0.1F));
+    const std::array<float, 4> values{rotation.x, rotation.y, rotation.z, rotation.w};
+    std::array<float, 4> decoded{};
+
+    const auto encoded = pvk::gltf::compression::encodeRotation(values.data());
+    pvk::gltf::compression::decodeRotation(encoded.data(), decoded.data());
+
+    const auto dot = values[0] * decoded[0] + values[1] * decoded[1] + values[2] * decoded[2] + values[3] * decoded[3];
+    EXPECT_NEAR(std::abs(dot), 1.0F, 1e-5F);
+}
+
+TEST(GLTFTest, morphTargetsAreImported) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/morph.gltf";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    const auto &node = object->getNodeByIndex(0);
+    const auto &primitive = *node.primitives[0];
+    EXPECT_EQ(primitive.getNumberOfMorphTargets(), 2);
+    EXPECT_EQ(object->morphDeltas.size(), 6);
+
+    // The second target is sparse and only moves the last vertex.
+    const auto firstDelta = primitive.getFirstMorphDelta();
+    EXPECT_EQ(object->morphDeltas[firstDelta].position, glm::vec3(0.0F, 0.0F, 1.0F));
+    EXPECT_EQ(object->morphDeltas[firstDelta + 3].position, glm::vec3(0.0F));
+    EXPECT_EQ(object->morphDeltas[firstDelta + 5].position, glm::vec3(0.0F, 2.0F, 0.0F));
+
+    const auto weights = object->hierarchy->getMorphWeights(node.getHierarchyIndex());
+    ASSERT_EQ(weights.size(), 2);
+    EXPECT_EQ(weights[0], 0.5F);
+    EXPECT_EQ(weights[1], 0.0F);
+}
+
+TEST(GLTFTest, morphWeightsAreAnimated) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/morph.gltf";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->updateTransforms();
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+
+    const auto &node = object->getNodeByIndex(0);
+    const auto weights = object->hierarchy->getMorphWeights(node.getHierarchyIndex());
+    EXPECT_NEAR(weights[0], 0.5F, 1e-6F);
+    EXPECT_NEAR(weights[1], 0.25F, 1e-6F);
+
+    const auto &changedNodes = object->getChangedNodes();
+    EXPECT_NE(std::find(changedNodes.begin(), changedNodes.end(), &node), changedNodes.end());
+}
+
+TEST(SkinningTest, computeSkinningMatchesCpuSkinning) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/joints.glb";
+    std::ostringstream pipelinePathStream;
+    pipelinePathStream << std::filesystem::current_path().c_str() << "/../definitions/skinning.json";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->animations[0]->update(0.5F);
+    object->updateTransforms();
+    object->updateJoints();
+
+    auto pipeline = pvk::createComputePipelineFromDefinition(pipelinePathStream.str());
+    pvk::skinning::SkinningPass skinningPass(*pipeline, *object);
+    skinningPass.update(0);
+
+    // Reads the skinned vertices back through a host visible buffer.
+    const auto size = sizeof(pvk::Vertex) * object->vertices.size();
+    vk::UniqueBuffer readbackBuffer;
+    vk::UniqueDeviceMemory readbackBufferMemory;
+    const auto *skinnedVertices = static_cast<const pvk::Vertex *>(pvk::buffer::createMapped(
+            size, vk::BufferUsageFlagBits::eTransferDst, readbackBuffer, readbackBufferMemory));
+
+    const auto commandBuffers = pvk::util::beginOneTimeCommandBuffer();
+    skinningPass.record(commandBuffers.front(), 0);
+    commandBuffers.front().pipelineBarrier(
+            vk::PipelineStageFlagBits::eComputeShader,
+            vk::PipelineStageFlagBits::eTransfer,
+            {},
+            vk::MemoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eTransferRead},
+            nullptr,
+            nullptr);
+    commandBuffers.front().copyBuffer(
+            skinningPass.getVertexBuffer(0), readbackBuffer.get(), vk::BufferCopy{0, 0, size});
+    pvk::util::endSingleTimeCommands(commandBuffers, application->getGraphicsQueue());
+
+    uint32_t numberOfSkinnedVertices = 0;
+
+    for (const auto &[nodeIndex, node] : object->getNodes()) {
+        if (node->skinIndex < 0) {
+            continue;
+        }
+
+        const auto &jointMatrices = object->getJointMatrices(*node);
+
+        for (const auto &primitive : node->primitives) {
+            for (uint32_t i = 0; i < primitive->getVertexCount(); i++) {
+                const auto vertexIndex = primitive->getStartVertex() + i;
+                const auto &vertex = object->vertices[vertexIndex];
+                const auto &skinnedVertex = skinnedVertices[vertexIndex];
+                glm::mat4 skinMatrix(0.0F);
+
+                for (glm::length_t j = 0; j < 4; j++) {
+                    skinMatrix += vertex.weight[j] * jointMatrices[vertex.joint[j]];
+                }
+
+                const auto position = glm::vec3(skinMatrix * glm::vec4(vertex.pos, 1.0F));
+                const auto normal = glm::normalize(glm::mat3(skinMatrix) * vertex.normal);
+
+                for (glm::length_t j = 0; j < 3; j++) {
+                    EXPECT_NEAR(skinnedVertex.pos[j], position[j], 1e-4F);
+                    EXPECT_NEAR(skinnedVertex.normal[j], normal[j], 1e-4F);
+                }
+
+                // Attributes which are not skinned are passed through.
+                EXPECT_EQ(skinnedVertex.joint, vertex.joint);
+                EXPECT_EQ(skinnedVertex.weight, vertex.weight);
+                numberOfSkinnedVertices++;
+            }
+        }
+    }
+
+    EXPECT_GT(numberOfSkinnedVertices, 0);
+}
+
+TEST(SkinningTest, onlyStrongestMorphTargetsAreActive) {
+    const std::array<float, 10> weights{0.1F, -0.9F, 0.0F, 0.3F, 0.5F, 1e-6F, 0.2F, 0.7F, -0.4F, 0.6F};
+    pvk::skinning::SkinningPass::MorphTargetList morphTargetList;
+
+    pvk::skinning::SkinningPass::selectActiveMorphTargets(weights, morphTargetList);
+    EXPECT_EQ(morphTargetList.numberOfActiveTargets, pvk::gltf::MAX_ACTIVE_MORPH_TARGETS);
+    EXPECT_EQ(morphTargetList.targets[0], 1);
+    EXPECT_EQ(morphTargetList.weights[0], -0.9F);
+
+    for (uint32_t i = 0; i < morphTargetList.numberOfActiveTargets; i++) {
+        EXPECT_NE(morphTargetList.targets[i], 2);
+        EXPECT_NE(morphTargetList.targets[i], 5);
+    }
+}
+
+TEST(SkinningTest, largestMorphWeightsAreKeptWhenMoreTargetsAreActive) {
+    // Twelve active targets, four more than can be evaluated.
+    const std::array<float, 12> weights{0.3F, -0.05F, 0.8F, 0.1F, -0.6F, 0.45F, 0.02F, 0.9F, -0.35F, 0.5F, 0.2F, 0.7F};
+    const std::array<uint32_t, pvk::gltf::MAX_ACTIVE_MORPH_TARGETS> expectedTargets{7, 2, 11, 4, 9, 5, 8, 0};
+    pvk::skinning::SkinningPass::MorphTargetList morphTargetList;
+
+    pvk::skinning::SkinningPass::selectActiveMorphTargets(weights, morphTargetList);
+    ASSERT_EQ(morphTargetList.numberOfActiveTargets, pvk::gltf::MAX_ACTIVE_MORPH_TARGETS);
+
+    // Sorted by descending absolute weight, the four smallest are dropped.
+    for (uint32_t i = 0; i < pvk::gltf::MAX_ACTIVE_MORPH_TARGETS; i++) {
+        EXPECT_EQ(morphTargetList.targets[i], expectedTargets[i]);
+        EXPECT_EQ(morphTargetList.weights[i], weights[expectedTargets[i]]);
+    }
+}
+
+TEST(GLTFTest, nodesSharingAMeshAreBatched) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/instanced.gltf";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    const auto &instancedNode = object->getNodeByIndex(1);
+    ASSERT_EQ(instancedNode.instanceMatrices.size(), 3);
+    EXPECT_EQ(glm::vec3(instancedNode.instanceMatrices[2][3]), glm::vec3(20.0F, 0.0F, 0.0F));
+
+    object->updateTransforms();
+    pvk::object::InstanceBatches instanceBatches(*object);
+    instanceBatches.update(0);
+
+    // One instance for the plain node and one for every EXT_mesh_gpu_instancing instance.
+    ASSERT_EQ(instanceBatches.getBatches().size(), 1);
+    EXPECT_EQ(instanceBatches.getBatches()[0].numberOfInstances, 4);
+    EXPECT_TRUE(instanceBatches.isBatched(object->getNodeByIndex(0)));
+    EXPECT_TRUE(instanceBatches.isBatched(instancedNode));
+
+    const auto instances = instanceBatches.getInstances();
+    EXPECT_EQ(glm::vec3(instances[0].transform[3]), glm::vec3(5.0F, 0.0F, 0.0F));
+    EXPECT_EQ(glm::vec3(instances[3].transform[3]), glm::vec3(20.0F, 0.0F, 0.0F));
+
+    pvk::culling::PrimitiveCuller culler;
+    culler.addObject(*object);
+
+    // The instanced node is only culled when all of its instances are outside the frustum.
+    const auto projection = glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F);
+    const auto center = glm::vec3(20.5F, 0.5F, 0.0F);
+    const auto eye = center + glm::vec3(0.0F, 0.0F, 3.0F);
+    culler.cull(pvk::culling::Frustum::fromMatrix(projection * glm::lookAt(eye, center, glm::vec3(0.0F, 1.0F, 0.0F))));
+    ASSERT_EQ(culler.getVisibleDraws().size(), 1);
+    EXPECT_EQ(culler.getVisibleDraws()[0].node, &instancedNode);
+}
+
+TEST(GpuCullerTest, recordsCoverEveryInstanceOfEveryBatch) {
+    // Has to match DrawRecord in gpu_culling.comp.
+    EXPECT_EQ(sizeof(pvk::culling::GpuCuller::DrawRecord), 64);
+
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/instanced.gltf";
+    std::ostringstream pipelinePathStream;
+    pipelinePathStream << std::filesystem::current_path().c_str() << "/../definitions/gpu_culling.json";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->updateTransforms();
+    pvk::object::InstanceBatches instanceBatches(*object);
+    auto pipeline = pvk::createComputePipelineFromDefinition(pipelinePathStream.str());
+    pvk::culling::GpuCuller culler(*pipeline, *object, instanceBatches);
+
+    const auto records = culler.getRecords();
+    const auto groups = culler.getGroups();
+    const auto &batch = instanceBatches.getBatches()[0];
+    const auto &primitive = *batch.node->primitives[0];
+
+    // A single primitive shared by the four instances of the batch.
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT_EQ(groups[0].node, batch.node);
+    EXPECT_EQ(groups[0].primitive, &primitive);
+    EXPECT_EQ(groups[0].firstCommand, 0);
+    EXPECT_EQ(groups[0].numberOfCommands, batch.numberOfInstances);
+    ASSERT_EQ(records.size(), batch.numberOfInstances);
+
+    for (uint32_t i = 0; i < records.size(); i++) {
+        EXPECT_EQ(records[i].transformIndex, batch.firstInstance + i);
+        EXPECT_EQ(records[i].groupIndex, 0);
+        EXPECT_EQ(records[i].firstCommand, groups[0].firstCommand);
+        EXPECT_EQ(records[i].firstIndex, primitive.getFirstIndex());
+        EXPECT_EQ(records[i].indexCount, 3);
+        EXPECT_LE(records[i].firstIndex + records[i].indexCount, object->indices.size());
+        EXPECT_EQ(records[i].vertexOffset, primitive.getVertexOffset());
+        EXPECT_EQ(records[i].center.w, 0.0F);
+    }
+}
+
+TEST(GpuCullerTest, occlusionCullingSplitsBuffersIntoEarlyAndLateHalves) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/instanced.gltf";
+    const auto definitionsPath = std::string(std::filesystem::current_path().c_str()) + "/../definitions/";
+
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str());
+    object->updateTransforms();
+    pvk::object::InstanceBatches instanceBatches(*object);
+
+    auto cullingPipeline = pvk::createComputePipelineFromDefinition(definitionsPath + "gpu_culling.json");
+    auto occlusionPipeline = pvk::createComputePipelineFromDefinition(definitionsPath + "occlusion_culling.json");
+    auto pyramidPipeline = pvk::createComputePipelineFromDefinition(definitionsPath + "depth_pyramid.json");
+    pvk::culling::DepthPyramid depthPyramid(
+            *pyramidPipeline, application->getDepthImageView(), application->getSwapChainExtent());
+
+    pvk::culling::GpuCuller frustumCuller(*cullingPipeline, *object, instanceBatches);
+    pvk::culling::GpuCuller occlusionCuller(*occlusionPipeline, *object, instanceBatches, depthPyramid);
+
+    EXPECT_FALSE(frustumCuller.isOcclusionCulling());
+    EXPECT_TRUE(occlusionCuller.isOcclusionCulling());
+    EXPECT_EQ(frustumCuller.getIndirectBufferSize(),
+              frustumCuller.getGroups()[0].numberOfCommands * sizeof(vk::DrawIndexedIndirectCommand));
+    EXPECT_EQ(frustumCuller.getCountBufferSize(), frustumCuller.getGroups().size() * sizeof(uint32_t));
+    EXPECT_EQ(occlusionCuller.getIndirectBufferSize(), 2 * frustumCuller.getIndirectBufferSize());
+    EXPECT_EQ(occlusionCuller.getCountBufferSize(), 2 * frustumCuller.getCountBufferSize());
+
+    // Throws before anything is recorded, so no command buffer is needed.
+    auto graphicsPipeline = pvk::createPipelineFromDefinition(
+            definitionsPath + "pbr_instanced.json", application->getRenderPass(), application->getSwapChainExtent());
+    EXPECT_THROW(frustumCuller.recordLateCulling({}, glm::mat4(1.0F), 0), std::runtime_error);
+    EXPECT_THROW(frustumCuller.recordLateDraws({}, *graphicsPipeline, 0), std::runtime_error);
+}
+
+TEST(GeometryArenaTest, freedRangesAreMergedAndReused) {
+    pvk::util::FreeList freeList(100);
+    const auto first = freeList.allocate(10);
+    const auto second = freeList.allocate(20);
+    const auto third = freeList.allocate(30);
+    ASSERT_TRUE(first.has_value() && second.has_value() && third.has_value());
+    EXPECT_EQ(*second, 10);
+    EXPECT_FALSE(freeList.allocate(41).has_value());
+
+    freeList.free(*second, 20);
+    EXPECT_EQ(freeList.allocate(15), 10);
+    freeList.free(10, 15);
+
+    freeList.free(*first, 10);
+    freeList.free(*third, 30);
+    EXPECT_EQ(freeList.getNumberOfFreeRanges(), 1);
+    EXPECT_EQ(freeList.getLargestFreeRange(), 100);
+    EXPECT_THROW(freeList.free(0, 10), std::runtime_error);
+}
+
+TEST(GeometryArenaTest, objectsShareArenaBuffers) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+
+    pvk::GeometryArena geometryArena(1 << 16, 1 << 16);
+    auto first = pvk::GLTFLoader::loadObject(
+            application->getGraphicsQueue(), filePathStream.str(), {}, &geometryArena);
+    auto second = pvk::GLTFLoader::loadObject(
+            application->getGraphicsQueue(), filePathStream.str(), {}, &geometryArena);
+
+    ASSERT_TRUE(first->geometryAllocation.isValid());
+    EXPECT_EQ(first->getVertexBuffer(), second->getVertexBuffer());
+    EXPECT_EQ(first->getIndexBuffer(), second->getIndexBuffer());
+
+    const auto &primitive = *second->getNodeByIndex(0).primitives[0];
+    EXPECT_EQ(primitive.getFirstIndex(), first->indices.size() + primitive.getStartIndex());
+    EXPECT_EQ(primitive.getVertexOffset(), static_cast<int32_t>(first->vertices.size()));
+
+    first.reset();
+    second.reset();
+    EXPECT_EQ(geometryArena.getVertexRanges().getNumberOfFreeElements(), 1 << 16);
+    EXPECT_EQ(geometryArena.getIndexRanges().getLargestFreeRange(), 1 << 16);
+}
+
+TEST(VertexLayoutTest, pulledAttributesMatchTheVertex) {
+    pvk::Vertex vertices[2]{};
+    vertices[1].pos = glm::vec3(1.0F, 2.0F, 3.0F);
+    vertices[1].UV1 = glm::vec2(4.0F, 5.0F);
+    vertices[1].joint = glm::ivec4(6, 7, 8, 9);
+
+    // Reads the vertices the way shaders/pulled.vert does.
+    const auto layout = pvk::VertexLayout::fromVertex();
+    const auto *words = reinterpret_cast<const float *>(vertices);
+    const auto base = layout.stride;
+
+    EXPECT_EQ(layout.stride * sizeof(float), sizeof(pvk::Vertex));
+    EXPECT_EQ(glm::vec3(words[base + layout.position], words[base + layout.position + 1],
+                        words[base + layout.position + 2]), vertices[1].pos);
+    EXPECT_EQ(glm::vec2(words[base + layout.UV1], words[base + layout.UV1 + 1]), vertices[1].UV1);
+    EXPECT_EQ(std::bit_cast<int32_t>(words[base + layout.joint + 3]), 9);
+}
+
+TEST(PipelineParserTest, vertexPullingPipelineBindsVerticesAsSet) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../definitions/pbr_pulled.json";
+
+    auto pipeline = pvk::createPipelineFromDefinition(
+            filePathStream.str(), application->getRenderPass(), application->getSwapChainExtent());
+
+    // The vertex set follows the two sets of the definition, the layout of the draw is pushed to the vertex stage.
+    EXPECT_TRUE(pipeline->isVertexPulling());
+    EXPECT_EQ(pipeline->getVertexSetIndex(), 2);
+    ASSERT_EQ(pipeline->getPushConstantRanges().size(), 1);
+    EXPECT_EQ(pipeline->getPushConstantRanges()[0],
+              vk::PushConstantRange(vk::ShaderStageFlagBits::eVertex, 0, sizeof(pvk::VertexLayout)));
+
+    std::ostringstream objectPathStream;
+    objectPathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), objectPathStream.str());
+
+    // A set lives as long as any registration of its buffer.
+    auto registration = pipeline->registerVertexBuffer(object->getVertexBuffer());
+    {
+        auto secondRegistration = pipeline->registerVertexBuffer(object->getVertexBuffer());
+        EXPECT_EQ(pipeline->getNumberOfVertexBuffers(), 1);
+    }
+    EXPECT_EQ(pipeline->getNumberOfVertexBuffers(), 1);
+
+    registration = pvk::Pipeline::VertexBufferRegistration();
+    EXPECT_EQ(pipeline->getNumberOfVertexBuffers(), 0);
+}
+
+TEST(ThreadPoolTest, parallelForRethrowsOnCallingThread) {
+    pvk::util::ThreadPool threadPool(3);
+    std::atomic<size_t> numberOfElements{0};
+
+    const auto task = [&numberOfElements](size_t begin, size_t end, uint32_t) {
+        for (auto i = begin; i < end; i++) {
+            if (i == 500) {
+                throw std::runtime_error("Failed job.");
+            }
+
+            numberOfElements++;
+        }
+    };
+
+    EXPECT_THROW(threadPool.parallelFor(1000, 8, task), std::runtime_error);
+    EXPECT_LT(numberOfElements, 1000);
+
+    // The pool is usable again once the exception has been rethrown.
+    numberOfElements = 0;
+    threadPool.parallelFor(1000, 8, [&numberOfElements](size_t begin, size_t end, uint32_t) {
+        numberOfElements += end - begin;
+    });
+    EXPECT_EQ(numberOfElements, 1000);
+}
+
+TEST(DepthPyramidTest, levelsHalveDownToOneTexel) {
+    const auto extents = pvk::culling::DepthPyramid::getLevelExtents({1920, 1080});
+
+    ASSERT_EQ(extents.size(), 10);
+    EXPECT_EQ(extents.front(), vk::Extent2D(960, 540));
+    EXPECT_EQ(extents.back(), vk::Extent2D(1, 1));
+
+    for (size_t i = 1; i < extents.size(); i++) {
+        EXPECT_EQ(extents[i].width, std::max(extents[i - 1].width / 2, 1U));
+        EXPECT_EQ(extents[i].height, std::max(extents[i - 1].height / 2, 1U));
+    }
+
+    EXPECT_EQ(pvk::culling::DepthPyramid::getLevelExtents({1, 1}), std::vector<vk::Extent2D>{vk::Extent2D(1, 1)});
+}
+
+TEST(SceneBvhTest, queriesMatchLinearCullingAndFollowRefit) {
+    std::ostringstream filePathStream;
+    filePathStream << std::filesystem::current_path().c_str() << "/../test/data/cube.glb";
+
+    // A row of cubes along the x axis, 10 units apart.
+    std::vector<std::unique_ptr<pvk::gltf::Object>> objects;
+    pvk::culling::SceneBvh bvh;
+    pvk::culling::PrimitiveCuller culler;
+
+    for (uint32_t i = 0; i < 8; i++) {
+        auto &object = objects.emplace_back(
+                pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePathStream.str())
+        );
+        object->getNodes().at(0)->setTranslation(glm::vec3(10.0F * static_cast<float>(i), 0.0F, 0.0F));
+        object->updateTransforms();
+
+        bvh.addObject(*object);
+        culler.addObject(*object);
+    }
+
+    bvh.build();
+    EXPECT_EQ(bvh.getNumberOfPrimitives(), 8);
+    EXPECT_GT(bvh.getNumberOfNodes(), 1);
+
+    const auto getObjectIndex = [&](pvk::culling::SceneBvh::PrimitiveHandle handle) {
+        const auto *object = bvh.getPrimitive(handle).object;
+
+        return static_cast<size_t>(std::find_if(objects.begin(), objects.end(), [&](const auto &candidate) {
+            return candidate.get() == object;
+        }) - objects.begin());
+    };
+
+    const auto projection = glm::perspective(glm::radians(30.0F), 1.0F, 0.1F, 100.0F);
+    const auto frustum = pvk::culling::Frustum::fromMatrix(
+            projection * glm::lookAt(glm::vec3(35.0F, 0.0F, 20.0F), glm::vec3(35.0F, 0.0F, 0.0F),
+                                     glm::vec3(0.0F, 1.0F, 0.0F))
+    );
+    std::vector<pvk::culling::SceneBvh::PrimitiveHandle> handles;
+    bvh.queryFrustum(frustum, handles);
+    culler.cull(frustum);
+
+    std::vector<const pvk::gltf::Primitive *> bvhPrimitives;
+    std::vector<const pvk::gltf::Primitive *> cullerPrimitives;
+
+    for (const auto handle : handles) {
+        bvhPrimitives.push_back(bvh.getPrimitive(handle).primitive);
+    }
+
+    for (const auto &draw : culler.getVisibleDraws()) {
+        cullerPrimitives.push_back(draw.primitive);
+    }
+
+    std::sort(bvhPrimitives.begin(), bvhPrimitives.end());
+    std::sort(cullerPrimitives.begin(), cullerPrimitives.end());
+    EXPECT_FALSE(bvhPrimitives.empty());
+    EXPECT_LT(bvhPrimitives.size(), 8);
+    EXPECT_EQ(bvhPrimitives, cullerPrimitives);
+
+    bvh.querySphere(glm::vec3(30.0F, 0.0F, 0.0F), 0.5F, handles);
+    ASSERT_EQ(handles.size(), 1);
+    EXPECT_EQ(getObjectIndex(handles[0]), 3);
+
+    std::vector<pvk::culling::SceneBvh::RayHit> hits;
+    bvh.queryRay({glm::vec3(-10.0F, 0.0F, 0.0F), glm::vec3(1.0F, 0.0F, 0.0F)}, hits);
+    ASSERT_EQ(hits.size(), 8);
+
+    for (size_t i = 0; i < hits.size(); i++) {
+        EXPECT_EQ(getObjectIndex(hits[i].handle), i);
+    }
+
+    bvh.queryRay({glm::vec3(50.0F, -10.0F, 0.0F), glm::vec3(0.0F, 1.0F, 0.0F)}, hits);
+    ASSERT_EQ(hits.size(), 1);
+    EXPECT_EQ(getObjectIndex(hits[0].handle), 5);
+
+    // Only the moved cube is refit, the topology stays the same.
+    const auto numberOfNodes = bvh.getNumberOfNodes();
+    objects[0]->getNodes().at(0)->setTranslation(glm::vec3(30.0F, 0.0F, 30.0F));
+    objects[0]->updateTransforms();
+    bvh.refit();
+
+    EXPECT_EQ(bvh.getNumberOfNodes(), numberOfNodes);
+    bvh.querySphere(glm::vec3(30.0F, 0.0F, 30.0F), 0.5F, handles);
+    ASSERT_EQ(handles.size(), 1);
+    EXPECT_EQ(getObjectIndex(handles[0]), 0);
+
+    bvh.querySphere(glm::vec3(0.0F), 0.5F, handles);
+    EXPECT_TRUE(handles.empty());
+}
+
+TEST(SceneBvhTest, parallelBuildMatchesBruteForce) {
+    // A grid of 16 x 16 x 8 nodes sharing a single triangle, every second node is rotated around the y axis. The
+    // triangle lies in the xy plane, so the bounds of the other nodes have no depth.
+    constexpr uint32_t SIZE_X = 16;
+    constexpr uint32_t SIZE_Y = 16;
+    constexpr uint32_t SIZE_Z = 8;
+    constexpr float SPACING = 3.0F;
+    constexpr uint32_t NUMBER_OF_NODES = SIZE_X * SIZE_Y * SIZE_Z;
+
+    std::ostringstream gltfStream;
+    gltfStream << R"({"asset": {"version": "2.0"}, "scene": 0, "scenes": [{"nodes": [)";
+
+    for (uint32_t i = 0; i < NUMBER_OF_NODES; i++) {
+        gltfStream << (i > 0 ? ", " : "") << i;
+    }
+
+    gltfStream << R"(]}], "nodes": [)";
+
+    for (uint32_t i = 0; i < NUMBER_OF_NODES; i++) {
+        const auto x = static_cast<float>(i % SIZE_X) * SPACING;
+        const auto y = static_cast<float>(i / SIZE_X % SIZE_Y) * SPACING;
+        const auto z = static_cast<float>(i / (SIZE_X * SIZE_Y)) * SPACING;
+        const auto halfAngle = 0.5F * 0.37F * static_cast<float>(i);
+
+        gltfStream << (i > 0 ? ", " : "") << R"({"mesh": 0, "translation": [)" << x << ", " << y << ", " << z << "]";
+
+        if (i % 2 == 1) {
+            gltfStream << R"(, "rotation": [0, )" << std::sin(halfAngle) << ", 0, " << std::cos(halfAngle) << "]";
+        }
+
+        gltfStream << "}";
+    }
+
+    gltfStream << R"(], "materials": [{"pbrMetallicRoughness": {}}],
+        "meshes": [{"primitives": [{"attributes": {"POSITION": 0}, "indices": 1, "material": 0}]}],
+        "buffers": [{"byteLength": 44, "uri": "data:application/octet-stream;base64,)"
+               << R"(AAAAAAAAAAAAAAAAAACAPwAAAAAAAAAAAAAAAAAAgD8AAAAAAAABAAIAAAA="}],
+        "bufferViews": [{"buffer": 0, "byteOffset": 0, "byteLength": 36},
+                        {"buffer": 0, "byteOffset": 36, "byteLength": 6}],
+        "accessors": [{"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+                       "min": [0, 0, 0], "max": [1, 1, 0]},
+                      {"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}]})";
+
+    const auto filePath = (std::filesystem::temp_directory_path() / "pvk_scene_bvh.gltf").string();
+    std::ofstream(filePath) << gltfStream.str();
+    auto object = pvk::GLTFLoader::loadObject(application->getGraphicsQueue(), filePath);
+    std::filesystem::remove(filePath);
+    object->updateTransforms();
+
+    // Well above the size of a subtree, so the upper levels are split here and the subtrees on the pool.
+    pvk::util::ThreadPool threadPool(3);
+    pvk::culling::SceneBvh bvh(threadPool);
+    pvk::culling::PrimitiveCuller culler;
+    bvh.addObject(*object);
+    culler.addObject(*object);
+    bvh.build();
+
+    ASSERT_EQ(bvh.getNumberOfPrimitives(), NUMBER_OF_NODES);
+    EXPECT_GT(threadPool.getNumberOfThreads(), 1);
+
+    std::vector<pvk::gltf::BoundingBox> worldBounds;
+
+    for (pvk::culling::SceneBvh::PrimitiveHandle handle = 0; handle < NUMBER_OF_NODES; handle++) {
+        const auto &primitive = bvh.getPrimitive(handle);
+        worldBounds.push_back(primitive.primitive->getBounds().transform(primitive.node->getGlobalMatrix()));
+    }
+
+    std::vector<pvk::culling::SceneBvh::PrimitiveHandle> handles;
+    std::vector<const pvk::gltf::Node *> bvhNodes;
+    std::vector<const pvk::gltf::Node *> cullerNodes;
+    const auto projection = glm::perspective(glm::radians(45.0F), 1.0F, 0.1F, 40.0F);
+    const auto up = glm::vec3(0.0F, 1.0F, 0.0F);
+
+    for (const auto &view : {glm::lookAt(glm::vec3(22.0F, 22.0F, 50.0F), glm::vec3(22.0F, 22.0F, 10.0F), up),
+                             glm::lookAt(glm::vec3(-10.0F, -10.0F, -10.0F), glm::vec3(20.0F, 20.0F, 10.0F), up),
+                             glm::lookAt(glm::vec3(50.0F, 5.0F, 10.0F), glm::vec3(0.0F, 40.0F, 10.0F), up)}) {
+        const auto frustum = pvk::culling::Frustum::fromMatrix(projection * view);
+        bvh.queryFrustum(frustum, handles);
+        culler.cull(frustum);
+        bvhNodes.clear();
+        cullerNodes.clear();
+
+        for (const auto handle : handles) {
+            bvhNodes.push_back(bvh.getPrimitive(handle).node);
+        }
+
+        for (const auto &draw : culler.getVisibleDraws()) {
+            cullerNodes.push_back(draw.node);
+        }
+
+        std::sort(bvhNodes.begin(), bvhNodes.end());
+        std::sort(cullerNodes.begin(), cullerNodes.end());
+        EXPECT_FALSE(bvhNodes.empty());
+        EXPECT_LT(bvhNodes.size(), NUMBER_OF_NODES);
+        EXPECT_EQ(bvhNodes, cullerNodes);
+    }
+
+    for (const auto &[center, radius] : {std::pair{glm::vec3(20.0F, 20.0F, 10.0F), 6.0F},
+                                         std::pair{glm::vec3(0.5F, 0.5F, 0.0F), 0.1F},
+                                         std::pair{glm::vec3(-5.0F, 30.0F, 12.0F), 8.0F}}) {
+        std::vector<pvk::culling::SceneBvh::PrimitiveHandle> expectedHandles;
+
+        for (pvk::culling::SceneBvh::PrimitiveHandle handle = 0; handle < NUMBER_OF_NODES; handle++) {
+            const auto offset = glm::clamp(center, worldBounds[handle].minimum, worldBounds[handle].maximum) - center;
+
+            if (glm::dot(offset, offset) <= radius * radius) {
+                expectedHandles.push_back(handle);
+            }
+        }
+
+        bvh.querySphere(center, radius, handles);
+        std::sort(handles.begin(), handles.end());
+        EXPECT_FALSE(handles.empty());
+        EXPECT_EQ(handles, expectedHandles);
+    }
+
+    // Rays parallel to an axis are only limited by the slabs of the other axes, even when they start on a plane.
+    const auto getRayDistance = [](const pvk::gltf::BoundingBox &bounds,
+                                   const pvk::culling::SceneBvh::Ray &ray) -> std::optional<float> {
+        auto entry = 0.0F;
+        auto exit = ray.maximumDistance;
+
+        for (glm::length_t axis = 0; axis < 3; axis++) {
+            if (ray.direction[axis] == 0.0F) {
+                if (ray.origin[axis] < bounds.minimum[axis] || ray.origin[axis] > bounds.maximum[axis]) {
+                    return std::nullopt;
+                }
+
+                continue;
+            }
+
+            const auto inverseDirection = 1.0F / ray.direction[axis];
+            const auto nearPlane = (bounds.minimum[axis] - ray.origin[axis]) * inverseDirection;
+            const auto farPlane = (bounds.maximum[axis] - ray.origin[axis]) * inverseDirection;
+            entry = std::max(entry, std::min(nearPlane, farPlane));
+            exit = std::min(exit, std::max(nearPlane, farPlane));
+        }
+
+        return entry <= exit ? std::optional(entry) : std::nullopt;
+    };
+
+    const std::vector<pvk::culling::SceneBvh::Ray> rays{
+            // Starts on the plane of the triangles of the nodes without rotation, along the row of those nodes.
+            {glm::vec3(-5.0F, 2.0F * SPACING + 0.5F, 3.0F * SPACING), glm::vec3(1.0F, 0.0F, 0.0F)},
+            {glm::vec3(4.0F * SPACING + 0.25F, 5.0F * SPACING + 0.25F, 40.0F), glm::vec3(0.0F, 0.0F, -1.0F)},
+            {glm::vec3(-3.0F, -2.0F, -1.0F), glm::normalize(glm::vec3(1.0F, 0.9F, 0.4F))},
+            {glm::vec3(50.0F, 0.5F, 25.0F), glm::normalize(glm::vec3(-1.0F, 0.1F, -0.5F)), 30.0F},
+    };
+    std::vector<pvk::culling::SceneBvh::RayHit> hits;
+
+    for (const auto &ray : rays) {
+        std::vector<pvk::culling::SceneBvh::RayHit> expectedHits;
+
+        for (pvk::culling::SceneBvh::PrimitiveHandle handle = 0; handle < NUMBER_OF_NODES; handle++) {
+            if (const auto distance = getRayDistance(worldBounds[handle], ray)) {
+                expectedHits.push_back({handle, *distance});
+            }
+        }
+
+        bvh.queryRay(ray, hits);
+        EXPECT_FALSE(hits.empty());
+        ASSERT_EQ(hits.size(), expectedHits.size());
+
+        for (size_t i = 1; i < hits.size(); i++) {
+            EXPECT_LE(hits[i - 1].distance, hits[i].distance);
+        }
+
+        const auto byHandle = [](const auto &a, const auto &b) {
+            return a.handle < b.handle;
+        };
+        std::sort(hits.begin(), hits.end(), byHandle);
+
+        for (size_t i = 0; i < hits.size(); i++) {
+            EXPECT_EQ(hits[i].handle, expectedHits[i].handle);
+            EXPECT_NEAR(hits[i].distance, expectedHits[i].distance, 1e-4F);
+        }
+    }
+
+    // Every node of the row without rotation is hit, although its bounds have no depth.
+    bvh.queryRay(rays[0], hits);
+    const auto numberOfFlatHits = std::count_if(hits.begin(), hits.end(), [&](const auto &hit) {
+        return worldBounds[hit.handle].minimum.z == worldBounds[hit.handle].maximum.z;
+    });
+    EXPECT_EQ(static_cast<uint32_t>(numberOfFlatHits), SIZE_X / 2);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     ::testing::AddGlobalTestEnvironment(new VulkanEnvironment);
@@ -130,4 +1450,4 @@ int main(int argc, char **argv) {
 
     return ret;
 }
-#pragma clang diagnostic pop
\ No newline at end of file
+#pragma clang diagnostic pop